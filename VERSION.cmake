@@ -59,8 +59,8 @@
 #   See './mkChangelog -h' for help.
 #
 SET(LIBZYPP_MAJOR "16")
-SET(LIBZYPP_COMPATMINOR "0")
-SET(LIBZYPP_MINOR "11")
+SET(LIBZYPP_COMPATMINOR "12")
+SET(LIBZYPP_MINOR "12")
 SET(LIBZYPP_PATCH "0")
 #
 # LAST RELEASED: 16.11.0 (0)
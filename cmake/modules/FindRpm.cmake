@@ -5,6 +5,7 @@ if(RPM_INCLUDE_DIR AND RPM_LIBRARY)
 endif(RPM_INCLUDE_DIR AND RPM_LIBRARY)
 
 set(RPM_LIBRARY)
+set(RPMIO_LIBRARY)
 set(RPM_INCLUDE_DIR)
 
 FIND_PATH(RPM_INCLUDE_DIR rpm/rpmdb.h
@@ -40,6 +41,12 @@ FIND_LIBRARY(RPM_LIBRARY NAMES rpm
 	/usr/local/lib
 )
 
+FIND_LIBRARY(RPMIO_LIBRARY NAMES rpmio
+	PATHS
+	/usr/lib
+	/usr/local/lib
+)
+
 if(RPM_INCLUDE_DIR AND RPM_LIBRARY)
    MESSAGE( STATUS "rpm found: includes in ${RPM_INCLUDE_DIR}, library in ${RPM_LIBRARY} (suspect ${RPM_SUSPECT_VERSION})")
    set(RPM_FOUND TRUE)
@@ -47,4 +54,4 @@ else(RPM_INCLUDE_DIR AND RPM_LIBRARY)
    MESSAGE( STATUS "rpm not found")
 endif(RPM_INCLUDE_DIR AND RPM_LIBRARY)
 
-MARK_AS_ADVANCED(RPM_INCLUDE_DIR RPM_LIBRARY)
\ No newline at end of file
+MARK_AS_ADVANCED(RPM_INCLUDE_DIR RPM_LIBRARY RPMIO_LIBRARY)
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/Digest.h"
+#include "zypp/TmpPath.h"
+#include "zypp/media/MediaBlockList.h"
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::media;
+
+namespace
+{
+  // zsync like block list for data_r
+  MediaBlockList blockList( const vector<unsigned char> & data_r, size_t blksize_r, int csl_r )
+  {
+    MediaBlockList bl( data_r.size() );
+    for ( size_t off = 0, blkno = 0; off < data_r.size(); off += blksize_r, ++blkno )
+    {
+      size_t size = min( blksize_r, data_r.size() - off );
+      bl.addBlock( off, size );
+      vector<unsigned char> block( blksize_r, 0 );
+      copy( data_r.begin() + off, data_r.begin() + off + size, block.begin() );
+      bl.setRsum( blkno, 4, bl.updateRsum( 0, (const char *)&block[0], blksize_r ), blksize_r );
+      Digest dig;
+      dig.create( Digest::sha1() );
+      dig.update( (const char *)&block[0], blksize_r );
+      vector<unsigned char> sum( dig.digestVector() );
+      bl.setChecksum( blkno, "SHA1", csl_r, &sum[0], blksize_r );
+    }
+    return bl;
+  }
+
+  void checkReuse( int csl_r, unsigned threads_r )
+  {
+    const size_t blksize = 1024;
+    vector<unsigned char> data( 200 * blksize + 123 );	// last block is short
+    srand( 42 );
+    for ( unsigned char & c : data )
+      c = rand();
+
+    // old version: 10 bytes inserted at the start, block 50 changed
+    vector<unsigned char> old( 10, 'x' );
+    old.insert( old.end(), data.begin(), data.end() );
+    old[10 + 50 * blksize + 7] ^= 0xff;
+    filesystem::TmpFile oldfile;
+    ofstream( oldfile.path().c_str(), ios::binary ).write( (const char *)&old[0], old.size() );
+
+    MediaBlockList bl( blockList( data, blksize, csl_r ) );
+    BOOST_REQUIRE_EQUAL( bl.numBlocks(), 201U );
+    filesystem::TmpFile target;
+    FILE * fp = fopen( target.path().c_str(), "w+" );
+    BOOST_REQUIRE( fp );
+    off_t reused = bl.reuseBlocks( fp, oldfile.path().asString(), threads_r );
+
+    // paired checksums (csl < 16) also lose the block in front of the changed one
+    BOOST_CHECK( bl.numBlocks() >= 1 && bl.numBlocks() <= 2 );
+    BOOST_CHECK_EQUAL( reused, off_t(data.size() - bl.numBlocks() * blksize) );
+    BOOST_CHECK_EQUAL( bl.getBlock( bl.numBlocks() - 1 ).off, off_t(50 * blksize) );
+
+    vector<unsigned char> result( data.size() );
+    rewind( fp );
+    BOOST_CHECK_EQUAL( fread( &result[0], 1, result.size(), fp ), result.size() );
+    fclose( fp );
+    for ( size_t blkno = 0; blkno <= 200; ++blkno )
+    {
+      if ( blkno == 50 || ( blkno == 49 && bl.numBlocks() == 2 ) )
+        continue;
+      size_t off = blkno * blksize;
+      size_t size = min( blksize, data.size() - off );
+      BOOST_CHECK_MESSAGE( memcmp( &result[off], &data[off], size ) == 0, "block " << blkno );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(reuse_blocks)
+{
+  checkReuse( 16, 1 );
+  checkReuse( 8, 1 );
+}
+
+BOOST_AUTO_TEST_CASE(reuse_blocks_threaded)
+{
+  checkReuse( 16, 3 );
+  checkReuse( 8, 3 );
+}
@@ -0,0 +1,62 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/media/MediaCurl.h"
+
+#include "WebServer.h"
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::media;
+
+#define DATADIR (Pathname(TESTS_SRC_DIR) + "/media/data")
+
+namespace
+{
+  size_t discardData( char *, size_t size, size_t nmemb, void * )
+  { return size * nmemb; }
+
+  /** Download \a url_r \a count_r times; return the number of failed transfers. */
+  unsigned download( const std::string & url_r, unsigned count_r )
+  {
+    unsigned failed = 0;
+    for ( unsigned i = 0; i < count_r; ++i )
+    {
+      CURL * curl = curl_easy_init();
+      curl_easy_setopt( curl, CURLOPT_SHARE, MediaCurl::sharedCurlHandle() );
+      curl_easy_setopt( curl, CURLOPT_URL, url_r.c_str() );
+      curl_easy_setopt( curl, CURLOPT_NOSIGNAL, 1L );
+      curl_easy_setopt( curl, CURLOPT_FAILONERROR, 1L );
+      curl_easy_setopt( curl, CURLOPT_WRITEFUNCTION, discardData );
+      if ( curl_easy_perform( curl ) != CURLE_OK )
+	++failed;
+      curl_easy_cleanup( curl );
+    }
+    return failed;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(shared_handle_threads)
+{
+  CURLSH * share = MediaCurl::sharedCurlHandle();
+  BOOST_REQUIRE( share );
+  BOOST_CHECK_EQUAL( share, MediaCurl::sharedCurlHandle() );
+
+  WebServer web( DATADIR, 10003 );
+  web.start();
+  std::string url( web.url().asString() + "/credentials.cat" );
+
+  // DNS, TLS session and connection caches are used from several threads at once
+  unsigned failed[4] = { 0, 0, 0, 0 };
+  std::thread workers[4];
+  for ( unsigned i = 0; i < 4; ++i )
+    workers[i] = std::thread( [&failed,&url,i]() { failed[i] = download( url, 25 ); } );
+  for ( std::thread & worker : workers )
+    worker.join();
+
+  for ( unsigned i = 0; i < 4; ++i )
+    BOOST_CHECK_EQUAL( failed[i], 0U );
+  web.stop();
+}
@@ -0,0 +1,91 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/Digest.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/base/String.h"
+#include "zypp/media/MediaManager.h"
+
+#include "WebServer.h"
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::media;
+
+namespace
+{
+  const size_t piecesize = 262144;
+
+  /** A metalink for \a data_r served as \a name_r from each of \a mirrors_r. */
+  std::string metalink( const std::string & name_r, const std::string & data_r, const std::vector<std::string> & mirrors_r )
+  {
+    std::ostringstream str;
+    str << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << endl;
+    str << "<metalink xmlns=\"urn:ietf:params:xml:ns:metalink\">" << endl;
+    str << "  <file name=\"" << name_r << "\">" << endl;
+    str << "    <size>" << data_r.size() << "</size>" << endl;
+    str << "    <hash type=\"sha-256\">" << Digest::digest( "sha256", data_r ) << "</hash>" << endl;
+    str << "    <pieces length=\"" << piecesize << "\" type=\"sha-1\">" << endl;
+    for ( size_t off = 0; off < data_r.size(); off += piecesize )
+      str << "      <hash>" << Digest::digest( "sha1", data_r.substr( off, piecesize ) ) << "</hash>" << endl;
+    str << "    </pieces>" << endl;
+    unsigned prio = 1;
+    for ( const std::string & mirror : mirrors_r )
+      str << "    <url priority=\"" << prio++ << "\">" << mirror << "/" << name_r << "</url>" << endl;
+    str << "  </file>" << endl;
+    str << "</metalink>" << endl;
+    return str.str();
+  }
+}
+
+/** Download a file through a metalink served by the local web server.
+ *
+ * The blocks are fetched in parallel from several mirror urls, which drives
+ * the curl_multi_socket_action loop and with it the socket and timer callbacks.
+ * Would multifetch fail, MediaMultiCurl falls back to a plain download of the
+ * requested file, i.e. we'd get the metalink instead of the data.
+ */
+BOOST_AUTO_TEST_CASE(metalink_multifetch)
+{
+  filesystem::TmpDir docroot;
+  std::string data;
+  for ( unsigned i = 0; data.size() < 3 * piecesize + 4711; ++i )
+    data += str::form( "line %u of the metalink test data\n", i );
+  {
+    std::ofstream out( ( docroot.path() / "data.bin" ).c_str() );
+    out << data;
+  }
+
+  WebServer web( docroot.path(), 10004 );
+  web.start();
+  std::vector<std::string> mirrors;
+  mirrors.push_back( web.url().asString() );
+  Url other( web.url() );
+  other.setHost( "127.0.0.1" );
+  mirrors.push_back( other.asString() );
+  {
+    std::ofstream out( ( docroot.path() / "data.bin.meta4" ).c_str() );
+    out << metalink( "data.bin", data, mirrors );
+  }
+
+  Url url( web.url() );
+  url.setQueryParam( "mediahandler", "multicurl" );
+
+  MediaManager mm;
+  MediaId id = mm.open( url );
+  mm.attach( id );
+  mm.provideFile( id, "/data.bin.meta4" );
+  Pathname dest( mm.localPath( id, "/data.bin.meta4" ) );
+
+  BOOST_REQUIRE_EQUAL( PathInfo( dest ).size(), off_t(data.size()) );
+  std::ifstream in( dest.c_str() );
+  BOOST_CHECK_EQUAL( Digest::digest( "sha256", in ), Digest::digest( "sha256", data ) );
+
+  mm.release( id );
+  mm.close( id );
+  web.stop();
+}
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <vector>
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/media/MirrorStats.h"
+
+using namespace std;
+using namespace zypp;
+using namespace zypp::media;
+
+BOOST_AUTO_TEST_CASE(rank_mirrors)
+{
+  MirrorStats stats;
+  vector<Url> urls;
+  urls.push_back( Url("http://slow.example.org/file") );
+  urls.push_back( Url("http://new.example.org/file") );
+  urls.push_back( Url("http://fast.example.org/file") );
+  urls.push_back( Url("http://broken.example.org/file") );
+
+  // nothing known: keep metalink order
+  vector<Url> ranked( urls );
+  stats.rank( ranked, 10000000 );
+  BOOST_CHECK( ranked == urls );
+  BOOST_CHECK_EQUAL( stats.expectedTime( "fast.example.org", 10000000 ), 0.0 );
+
+  stats.addSample( "slow.example.org", 100000, 1.0, 0.0 );	// 100k/s
+  stats.addSample( "fast.example.org", 1000000, 1.0, 0.0 );	// 1M/s
+  stats.addSample( "broken.example.org", 1000000, 1.0, 0.0 );
+  stats.addFailure( "broken.example.org" );
+  stats.addFailure( "broken.example.org" );
+
+  BOOST_CHECK( stats.known( "slow.example.org" ) );
+  BOOST_CHECK( ! stats.known( "new.example.org" ) );
+  BOOST_CHECK_EQUAL( stats.stats( "broken.example.org" ).failures, 2U );
+  BOOST_CHECK( stats.expectedTime( "fast.example.org", 10000000 ) < stats.expectedTime( "slow.example.org", 10000000 ) );
+
+  // unknown hosts are ranked like an average one
+  ranked = urls;
+  stats.rank( ranked, 10000000 );
+  BOOST_CHECK_EQUAL( ranked[0].getHost(), "fast.example.org" );
+  BOOST_CHECK_EQUAL( ranked[1].getHost(), "new.example.org" );
+  BOOST_CHECK_EQUAL( ranked[2].getHost(), "broken.example.org" );	// fast but failing
+  BOOST_CHECK_EQUAL( ranked[3].getHost(), "slow.example.org" );
+
+  // latency is what matters for small files
+  stats.addSample( "slow.example.org", 1000, 0.01, 0.005 );
+  stats.addSample( "fast.example.org", 1000000, 1.5, 0.5 );
+  BOOST_CHECK( stats.expectedTime( "slow.example.org", 1000 ) < stats.expectedTime( "fast.example.org", 1000 ) );
+}
+
+BOOST_AUTO_TEST_CASE(persistent)
+{
+  filesystem::TmpDir tmp;
+  Pathname file( tmp.path() / "mirrorstats" );
+  {
+    MirrorStats stats( file );
+    stats.addSample( "fast.example.org", 1000000, 1.0, 0.1 );
+    stats.addFailure( "broken.example.org" );
+    BOOST_CHECK( stats.save( true ) );
+  }
+  BOOST_CHECK( PathInfo( file ).isFile() );
+
+  MirrorStats stats( file );
+  BOOST_CHECK( stats.known( "fast.example.org" ) );
+  BOOST_CHECK_EQUAL( stats.stats( "fast.example.org" ).samples, 1U );
+  BOOST_CHECK_EQUAL( stats.stats( "broken.example.org" ).failures, 1U );
+  BOOST_CHECK_CLOSE( stats.stats( "fast.example.org" ).latency, 0.1, 0.01 );
+
+  MirrorStats::FetchPlan plan;
+  plan.filesize = 42;
+  stats.setLastPlan( plan );
+  BOOST_CHECK_EQUAL( stats.lastPlan().filesize, 42 );
+}
+
+BOOST_AUTO_TEST_CASE(switch_file)
+{
+  filesystem::TmpDir tmp;
+  Pathname file1( tmp.path() / "one" / "mirrorstats" );
+  Pathname file2( tmp.path() / "two" / "mirrorstats" );
+
+  MirrorStats stats( file1 );
+  stats.addSample( "one.example.org", 1000000, 1.0, 0.1 );
+  stats.setFile( file2 );
+  BOOST_CHECK_EQUAL( stats.file(), file2 );
+  BOOST_CHECK( PathInfo( file1 ).isFile() );	// pending changes were saved
+  BOOST_CHECK( ! stats.known( "one.example.org" ) );
+
+  stats.addSample( "two.example.org", 1000000, 1.0, 0.1 );
+  stats.setFile( file1 );
+  BOOST_CHECK( stats.known( "one.example.org" ) );
+  BOOST_CHECK( ! stats.known( "two.example.org" ) );
+  BOOST_CHECK( PathInfo( file2 ).isFile() );
+}
@@ -0,0 +1,131 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Logger.h"
+#include "zypp/TmpPath.h"
+#include "zypp/PathInfo.h"
+#include "zypp/Digest.h"
+#include "zypp/CheckSum.h"
+#include "zypp/ManagedFile.h"
+#include "zypp/repo/Applydeltarpm.h"
+
+using std::endl;
+using namespace zypp;
+using namespace boost::unit_test;
+
+// A fake applydeltarpm: the 'delta' is a copy of the new rpm;
+// the check fails for sequenceinfo "FAIL". A single worker builds
+// the jobs one after the other, in the order they were queued.
+const filesystem::TmpDir & fakeApplydeltarpm()
+{
+  static filesystem::TmpDir tmp;
+  static bool init = false;
+  if ( ! init )
+  {
+    Pathname prog( tmp.path() / "applydeltarpm" );
+    std::ofstream( prog.c_str() )
+      << "#!/bin/sh" << endl
+      << "if [ \"$1\" = \"-c\" ]; then" << endl
+      << "  [ \"$3\" = \"FAIL\" ] && { echo 'bad on-disk data'; exit 1; }" << endl
+      << "  exit 0" << endl
+      << "fi" << endl
+      << "cp \"$3\" \"$4\" || exit 1" << endl
+      << "echo '100 percent finished.'" << endl;
+    filesystem::chmod( prog, 0755 );
+    ::setenv( "ZYPP_TESTSUITE_APPLYDELTARPM", prog.c_str(), 1 );
+    Pathname conf( tmp.path() / "zypp.conf" );
+    std::ofstream( conf.c_str() )
+      << "[main]" << endl
+      << "download.max_parallel_deltas = 1" << endl;
+    ::setenv( "ZYPP_CONF", conf.c_str(), 1 );
+    init = true;
+  }
+  return tmp;
+}
+
+// write a 'delta' and return the checksum of the rpm built from it
+CheckSum makeDelta( const Pathname & delta_r, const std::string & content_r )
+{
+  std::ofstream( delta_r.c_str() ) << content_r;
+  std::ifstream in( delta_r.c_str() );
+  return CheckSum( "sha256", Digest::digest( Digest::sha256(), in ) );
+}
+
+BOOST_AUTO_TEST_CASE(applydeltarpm_build)
+{
+  const Pathname & dir( fakeApplydeltarpm().path() );
+  Pathname delta( dir / "a.delta.rpm" );
+  Pathname target( dir / "a.rpm" );
+  CheckSum sum( makeDelta( delta, "package a\n" ) );
+
+  applydeltarpm::provideAsync( ManagedFile( delta ), target, sum, "seq" );
+  BOOST_CHECK_EQUAL( applydeltarpm::pendingDelta( target ), delta );
+
+  applydeltarpm::JobInfo info;
+  unsigned last = 0;
+  BOOST_CHECK( applydeltarpm::waitFor( target, [&last]( unsigned p ){ last = p; }, &info ) );
+  BOOST_CHECK( ! info.checkFailed );
+  BOOST_CHECK( PathInfo( target ).isFile() );
+  // collected: no longer pending
+  BOOST_CHECK( applydeltarpm::pendingDelta( target ).empty() );
+  BOOST_CHECK( ! applydeltarpm::waitFor( target ) );
+}
+
+BOOST_AUTO_TEST_CASE(applydeltarpm_checksum_mismatch)
+{
+  const Pathname & dir( fakeApplydeltarpm().path() );
+  Pathname delta( dir / "b.delta.rpm" );
+  Pathname target( dir / "b.rpm" );
+  makeDelta( delta, "package b\n" );
+  CheckSum wrong( makeDelta( dir / "other", "something else\n" ) );
+
+  applydeltarpm::provideAsync( ManagedFile( delta ), target, wrong );
+  applydeltarpm::JobInfo info;
+  BOOST_CHECK( ! applydeltarpm::waitFor( target, applydeltarpm::Progress(), &info ) );
+  BOOST_CHECK( ! info.checkFailed );
+  BOOST_CHECK( ! PathInfo( target ).isExist() );
+}
+
+BOOST_AUTO_TEST_CASE(applydeltarpm_check_failed)
+{
+  const Pathname & dir( fakeApplydeltarpm().path() );
+  Pathname delta( dir / "c.delta.rpm" );
+  Pathname target( dir / "c.rpm" );
+  CheckSum sum( makeDelta( delta, "package c\n" ) );
+
+  applydeltarpm::provideAsync( ManagedFile( delta ), target, sum, "FAIL" );
+  applydeltarpm::JobInfo info;
+  BOOST_CHECK( ! applydeltarpm::waitFor( target, applydeltarpm::Progress(), &info ) );
+  BOOST_CHECK( info.checkFailed );
+  BOOST_CHECK( ! PathInfo( target ).isExist() );
+}
+
+BOOST_AUTO_TEST_CASE(applydeltarpm_uncollected)
+{
+  const Pathname & dir( fakeApplydeltarpm().path() );
+  Pathname delta( dir / "d.delta.rpm" );
+  Pathname target( dir / "d.rpm" );
+  CheckSum sum( makeDelta( delta, "package d\n" ) );
+
+  BOOST_CHECK( ! applydeltarpm::waitFor( dir / "unknown.rpm" ) );
+
+  // a finished but uncollected job stays pending until it is replaced or collected
+  applydeltarpm::provideAsync( ManagedFile( delta ), target, sum );
+  // the single worker is done with target when it has built the job queued after it
+  Pathname barrier( dir / "e.delta.rpm" );
+  CheckSum barriersum( makeDelta( barrier, "package e\n" ) );
+  applydeltarpm::provideAsync( ManagedFile( barrier ), dir / "e.rpm", barriersum );
+  BOOST_CHECK( applydeltarpm::waitFor( dir / "e.rpm" ) );
+  BOOST_CHECK( PathInfo( target ).isFile() );
+  BOOST_CHECK_EQUAL( applydeltarpm::pendingDelta( target ), delta );
+
+  Pathname delta2( dir / "d2.delta.rpm" );
+  makeDelta( delta2, "package d\n" );
+  applydeltarpm::provideAsync( ManagedFile( delta2 ), target, sum );
+  BOOST_CHECK_EQUAL( applydeltarpm::pendingDelta( target ), delta2 );
+  BOOST_CHECK( applydeltarpm::waitFor( target ) );
+  BOOST_CHECK( PathInfo( target ).isFile() );
+}
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <fstream>
+#include <list>
+#include <string>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Logger.h"
+#include "zypp/TmpPath.h"
+#include "zypp/PathInfo.h"
+#include "zypp/ResPool.h"
+#include "zypp/Package.h"
+#include "zypp/repo/BlockReuseCandidates.h"
+
+#include "TestSetup.h"
+
+using std::endl;
+using namespace zypp;
+using namespace zypp::filesystem;
+
+#define TEST_DIR TESTS_SRC_DIR "/repo/susetags/data/blockreuse"
+
+Package::constPtr findPackage( const std::string & repo_r, const std::string & edition_r, const Arch & arch_r = Arch_x86_64 )
+{
+  for ( const PoolItem & pi : ResPool::instance().byIdent( ResKind::package, "foo" ) )
+  {
+    if ( pi.repoInfo().alias() == repo_r && pi.edition() == Edition( edition_r ) && pi.arch() == arch_r )
+      return make<Package>( pi.satSolvable() );
+  }
+  return Package::constPtr();
+}
+
+// create a (non-empty unless size_r is 0) file at path_r
+Pathname mkfile( const Pathname & path_r, unsigned size_r = 1 )
+{
+  assert_dir( path_r.dirname() );
+  std::ofstream( path_r.c_str() ) << std::string( size_r, 'x' );
+  return path_r;
+}
+
+BOOST_AUTO_TEST_CASE(block_reuse_candidates)
+{
+  TmpDir cache;
+  TmpDir othercache;
+
+  TestSetup test( Arch_x86_64 );
+  {
+    RepoInfo repo;
+    repo.setAlias( "repo" );
+    repo.addBaseUrl( Pathname( TEST_DIR ).asDirUrl() );
+    repo.setGpgCheck( false );
+    repo.setPackagesPath( cache.path() );
+    test.loadRepo( repo );
+  }
+  {
+    // same packages, different package cache
+    RepoInfo repo;
+    repo.setAlias( "other" );
+    repo.addBaseUrl( Pathname( TEST_DIR ).asDirUrl() );
+    repo.setGpgCheck( false );
+    repo.setPackagesPath( othercache.path() );
+    test.loadRepo( repo );
+  }
+
+  Package::constPtr pkg( findPackage( "repo", "2.0-1" ) );
+  BOOST_REQUIRE( pkg );
+  Pathname self( cache.path() / pkg->location().filename() );
+  Pathname dir( self.dirname() );
+
+  mkfile( self );
+  // same build in the other repos cache
+  Pathname same( mkfile( othercache.path() / pkg->location().filename() ) );
+  // older and newer builds known to the pool
+  Pathname older( mkfile( cache.path() / findPackage( "repo", "1.0-1" )->location().filename() ) );
+  Pathname newer( mkfile( cache.path() / findPackage( "repo", "3.0-1" )->location().filename() ) );
+  // builds the repo no longer offers
+  Pathname oldest( mkfile( dir / "foo-0.9-1.x86_64.rpm" ) );
+  Pathname old( mkfile( dir / "foo-1.5-1.x86_64.rpm" ) );
+  Pathname newest( mkfile( dir / "foo-4.0-1.x86_64.rpm" ) );
+  // no candidates: different arch, different package, empty file
+  mkfile( cache.path() / findPackage( "repo", "1.0-1", Arch_i586 )->location().filename() );
+  mkfile( dir / "foo-1.8-1.i586.rpm" );
+  mkfile( dir / "foo-devel-2.0-1.x86_64.rpm" );
+  mkfile( dir / "foo-devel-1.0-1.x86_64.rpm" );
+  mkfile( dir / "foo-1.9-1.x86_64.rpm", 0 );
+
+  std::list<Pathname> expected = { same, old, older, oldest, newer, newest };
+  std::list<Pathname> got( repo::blockReuseCandidates( pkg, 10 ) );
+  BOOST_CHECK_EQUAL_COLLECTIONS( got.begin(), got.end(), expected.begin(), expected.end() );
+
+  got = repo::blockReuseCandidates( pkg, 1 );
+  BOOST_REQUIRE_EQUAL( got.size(), 1U );
+  BOOST_CHECK_EQUAL( got.front(), same );
+
+  BOOST_CHECK( repo::blockReuseCandidates( pkg, 0 ).empty() );
+}
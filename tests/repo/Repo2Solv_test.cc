@@ -0,0 +1,82 @@
+#include <iostream>
+#include <string>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Logger.h"
+#include "zypp/base/Easy.h"
+#include "zypp/TmpPath.h"
+#include "zypp/PathInfo.h"
+#include "zypp/Package.h"
+#include "zypp/SrcPackage.h"
+#include "zypp/Repository.h"
+#include "zypp/sat/Pool.h"
+#include "zypp/repo/Repo2Solv.h"
+
+using std::endl;
+using namespace zypp;
+using namespace boost::unit_test;
+
+#define DATADIR (Pathname(TESTS_SRC_DIR))
+
+// number of packages and source packages (src/nosrc) in the solv file
+std::pair<unsigned,unsigned> countPackages( const Pathname & solvfile_r )
+{
+  sat::Pool satpool( sat::Pool::instance() );
+  Repository repo( satpool.addRepoSolv( solvfile_r, solvfile_r.dirname().basename() ) );
+  std::pair<unsigned,unsigned> ret( 0, 0 );
+  for_( it, repo.solvablesBegin(), repo.solvablesEnd() )
+  {
+    if ( it->isKind<Package>() )
+      ++ret.first;
+    else if ( it->isKind<SrcPackage>() )
+      ++ret.second;
+  }
+  repo.eraseFromPool();
+  return ret;
+}
+
+BOOST_AUTO_TEST_CASE(repo2solv_rpmmd)
+{
+  if ( ! repo::repo2solvSupports( repo::RepoType::RPMMD ) )
+    return;	// libsolv lacks the required features
+
+  filesystem::TmpDir tmp;
+  Pathname solvfile( tmp.path() / "rpmmd" / "solv" );
+  filesystem::assert_dir( solvfile.dirname() );
+
+  std::string errdetail;
+  BOOST_CHECK( repo::repo2solv( repo::RepoType::RPMMD, DATADIR / "data/obs_virtualbox_11_1", solvfile, errdetail ) );
+  BOOST_CHECK_EQUAL( errdetail, "" );
+  std::pair<unsigned,unsigned> count( countPackages( solvfile ) );
+  BOOST_CHECK_EQUAL( count.first, 68U );	// 78 entries in primary.xml...
+  BOOST_CHECK_EQUAL( count.second, 10U );	// ...10 of them <arch>src</arch>
+}
+
+BOOST_AUTO_TEST_CASE(repo2solv_susetags)
+{
+  if ( ! repo::repo2solvSupports( repo::RepoType::YAST2 ) )
+    return;	// libsolv lacks the required features
+
+  filesystem::TmpDir tmp;
+  Pathname solvfile( tmp.path() / "susetags" / "solv" );
+  filesystem::assert_dir( solvfile.dirname() );
+
+  std::string errdetail;
+  BOOST_CHECK( repo::repo2solv( repo::RepoType::YAST2, DATADIR / "repo/susetags/data/dudata/repo", solvfile, errdetail ) );
+  BOOST_CHECK_EQUAL( errdetail, "" );
+  std::pair<unsigned,unsigned> count( countPackages( solvfile ) );
+  BOOST_CHECK_EQUAL( count.first, 3U );
+  BOOST_CHECK_EQUAL( count.second, 0U );
+}
+
+BOOST_AUTO_TEST_CASE(repo2solv_error)
+{
+  filesystem::TmpDir tmp;
+  Pathname solvfile( tmp.path() / "solv" );
+
+  std::string errdetail;
+  BOOST_CHECK( ! repo::repo2solv( repo::RepoType::RPMMD, tmp.path() / "nonexistent", solvfile, errdetail ) );
+  BOOST_CHECK( ! errdetail.empty() );
+  BOOST_CHECK( ! PathInfo( solvfile ).isExist() );
+}
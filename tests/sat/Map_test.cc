@@ -5,6 +5,7 @@
 #include "zypp/base/LogTools.h"
 #include "zypp/base/Easy.h"
 #include "zypp/sat/Map.h"
+#include "zypp/sat/SolvableMap.h"
 
 
 #define BOOST_TEST_MODULE Map
@@ -66,3 +67,72 @@ BOOST_AUTO_TEST_CASE(basic)
 
   BOOST_CHECK_THROW( m.set( 99 ), std::out_of_range );
 }
+
+BOOST_AUTO_TEST_CASE(setops)
+{
+  sat::Map a( 200 );
+  sat::Map b( 100 );
+  a.set( 3 ); a.set( 64 ); a.set( 150 ); a.set( 199 );
+  b.set( 3 ); b.set( 70 );
+  BOOST_CHECK_EQUAL( a.count(), 4 );
+  BOOST_CHECK_EQUAL( a.findNext( 0 ), 3 );
+  BOOST_CHECK_EQUAL( a.findNext( 4 ), 64 );
+  BOOST_CHECK_EQUAL( a.findNext( 65 ), 150 );
+  BOOST_CHECK_EQUAL( a.findNext( 200 ), a.size() );
+
+  sat::Map u( b );
+  u |= a;	// grows
+  BOOST_CHECK_EQUAL( u.size(), 200 );
+  BOOST_CHECK_EQUAL( u.count(), 5 );
+  BOOST_CHECK_EQUAL( b.count(), 2 );	// COW
+
+  sat::Map i( a );
+  i &= b;
+  BOOST_CHECK_EQUAL( i.count(), 1 );
+  BOOST_CHECK( i.test( 3 ) );
+
+  sat::Map d( a );
+  d -= b;
+  BOOST_CHECK_EQUAL( d.count(), 3 );
+  BOOST_CHECK( ! d.test( 3 ) );
+}
+
+BOOST_AUTO_TEST_CASE(solvablemap)
+{
+  sat::SolvableMap m;
+  BOOST_CHECK( m.empty() );
+  BOOST_CHECK( m.begin() == m.end() );
+
+  BOOST_CHECK( m.insert( sat::Solvable( 90 ) ) );
+  BOOST_CHECK( m.insert( sat::Solvable( 7 ) ) );
+  BOOST_CHECK( ! m.insert( sat::Solvable( 7 ) ) );
+  BOOST_CHECK( ! m.insert( sat::Solvable::noSolvable ) );
+  BOOST_CHECK_EQUAL( m.size(), 2 );
+  BOOST_CHECK( m.contains( sat::Solvable( 90 ) ) );
+  BOOST_CHECK( ! m.contains( sat::Solvable( 8 ) ) );
+  BOOST_CHECK( ! m.contains( sat::Solvable( 9999 ) ) );
+
+  // id order
+  std::vector<sat::Solvable> v( m.begin(), m.end() );
+  BOOST_REQUIRE_EQUAL( v.size(), 2 );
+  BOOST_CHECK_EQUAL( v[0].id(), 7 );
+  BOOST_CHECK_EQUAL( v[1].id(), 90 );
+
+  sat::SolvableMap n;
+  n.insert( sat::Solvable( 90 ) );
+  n.insert( sat::Solvable( 300 ) );
+  sat::SolvableMap u( m );
+  u |= n;
+  BOOST_CHECK_EQUAL( u.size(), 3 );
+  sat::SolvableMap i( m );
+  i &= n;
+  BOOST_CHECK_EQUAL( i.size(), 1 );
+  BOOST_CHECK( i.contains( sat::Solvable( 90 ) ) );
+  sat::SolvableMap d( u );
+  d -= n;
+  BOOST_CHECK( d == m );
+
+  BOOST_CHECK( m.erase( sat::Solvable( 7 ) ) );
+  BOOST_CHECK( ! m.erase( sat::Solvable( 7 ) ) );
+  BOOST_CHECK_EQUAL( m.size(), 1 );
+}
@@ -184,3 +184,31 @@ BOOST_AUTO_TEST_CASE(guessPackageSpec)
 }
 
 
+
+BOOST_AUTO_TEST_CASE(cache)
+{
+  Capability::clearCache();
+  Capability::CacheStats stats( Capability::cacheStats() );
+  BOOST_CHECK_EQUAL( stats.parseHits + stats.parseMisses + stats.matchHits + stats.matchMisses, 0U );
+
+  Capability a( "foo >= 1.2" );
+  Capability b( "foo >= 1.2" );
+  BOOST_CHECK_EQUAL( a, b );
+  BOOST_CHECK_EQUAL( a, Capability( "", "foo", ">=", "1.2" ) );
+  // different flags or arch are different keys
+  BOOST_CHECK( Capability( "foo >= 1.2", Capability::PARSED ) != a );
+  BOOST_CHECK( Capability( Arch_i386, "foo >= 1.2" ) != a );
+  stats = Capability::cacheStats();
+  BOOST_CHECK_EQUAL( stats.parseHits, 1U );
+  BOOST_CHECK_EQUAL( stats.parseMisses, 3U );
+
+  Capability c( "foo < 1.0" );
+  for ( unsigned i = 0; i < 3; ++i )
+  {
+    BOOST_CHECK_EQUAL( a.matches( c ), CapMatch::no );
+    BOOST_CHECK_EQUAL( a.matches( Capability( "foo = 2.0" ) ), CapMatch::yes );
+  }
+  stats = Capability::cacheStats();
+  BOOST_CHECK_EQUAL( stats.matchMisses, 2U );
+  BOOST_CHECK_EQUAL( stats.matchHits, 4U );
+}
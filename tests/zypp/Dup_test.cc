@@ -61,3 +61,20 @@ BOOST_AUTO_TEST_CASE(orphaned)
   BOOST_CHECK_EQUAL( proxy.lookup( ResKind::package, "dropped_required" )->status(),	ui::S_KeepInstalled );
   BOOST_CHECK_EQUAL( proxy.lookup( ResKind::package, "dropped" )->status(),		ui::S_AutoDel );
 }
+
+BOOST_AUTO_TEST_CASE(statistics)
+{
+  const solver::detail::SolverStatistics & stats( getZYpp()->resolver()->statistics() );
+  USR << stats << endl;
+
+  unsigned updated = 0;
+  for ( const PoolItem & pi : test.pool() )
+  {
+    if ( pi.status().isToBeUninstalledDueToUpgrade() )
+      ++updated;
+  }
+  BOOST_CHECK_EQUAL( stats.updated, updated );
+  BOOST_CHECK( stats.toInstall > 0 );
+  BOOST_CHECK( stats.toRemove >= stats.updated + stats.obsoleted );
+  BOOST_CHECK_EQUAL( stats.problems, 0U );
+}
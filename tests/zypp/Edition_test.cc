@@ -5,6 +5,7 @@
 
 #include "zypp/base/Logger.h"
 #include "zypp/Edition.h"
+#include "TestSetup.h"
 
 #include <boost/test/auto_unit_test.hpp>
 
@@ -37,3 +38,25 @@ BOOST_AUTO_TEST_CASE(edition)
   BOOST_CHECK_EQUAL( Edition::compare("2:1-1","2:1-1"), 0 );
   BOOST_CHECK_EQUAL( Edition::compare("3:1-1","2:1-1"), 1 );
 }
+
+BOOST_AUTO_TEST_CASE(pool_edition_rank)
+{
+  TestSetup test( Arch_x86_64 );
+  test.loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1" );
+
+  std::vector<Edition> editions;
+  for ( const sat::Solvable & solv : test.satpool().solvables() )
+    editions.push_back( solv.edition() );
+  BOOST_REQUIRE( editions.size() > 1 );
+  editions.push_back( Edition( "1.1" ) );	// ad-hoc editions are compared as strings
+  editions.push_back( Edition( "1_1" ) );
+
+  // ranked ids must compare as their strings do
+  for ( unsigned i = 1; i < editions.size(); ++i )
+  {
+    const Edition & lhs( editions[i-1] );
+    const Edition & rhs( editions[(i*7919) % editions.size()] );
+    BOOST_CHECK_EQUAL( Edition::compare( lhs, rhs ), Edition::compare( lhs.c_str(), rhs.c_str() ) );
+    BOOST_CHECK_EQUAL( Edition::compare( lhs, editions[i] ), Edition::compare( lhs.c_str(), editions[i].c_str() ) );
+  }
+}
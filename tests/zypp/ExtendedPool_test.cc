@@ -56,6 +56,14 @@ void repocheck()
 //     cout << "??? " << pi << endl;
     checkpi( pi );
   }
+  for ( const Repository & repo : sat::Pool::instance().repos() )
+  {
+    for ( const sat::Solvable & slv : repo.solvables() )
+    {
+      BOOST_CHECK( repo.satInternalSolvableIdBegin() <= slv.id() );
+      BOOST_CHECK( slv.id() < repo.satInternalSolvableIdEnd() );
+    }
+  }
 //   cout << "---[repocheck]======================" << endl;
 }
 
@@ -79,7 +87,53 @@ void repocheck()
 // Resolvable is still the original one created for a package...
 ///////////////////////////////////////////////////////////////////
 
+///////////////////////////////////////////////////////////////////
+// PoolItem status is kept in the pools id indexed tables. An empty
+// PoolItem, or one kept after its solvable was removed from the pool,
+// must not read or write the status of an item in the pool (e.g. the
+// one reusing the id).
+///////////////////////////////////////////////////////////////////
+
+static PoolItem staleItem;
+
+void statuscheck_init()
+{
+  staleItem = *ResPool::instance().begin();
+  BOOST_REQUIRE( staleItem );
+  staleItem.status().setTransact( true, ResStatus::USER );
+  BOOST_CHECK( staleItem.status().transacts() );
+  BOOST_CHECK( PoolItem( staleItem.satSolvable() ).status().transacts() );
+
+  // empty items share a detached status
+  PoolItem empty;
+  empty.status().setLock( true, ResStatus::USER );
+  BOOST_CHECK( ! empty.status().isLocked() );
+  BOOST_CHECK( ! PoolItem().status().isLocked() );
+  BOOST_CHECK( staleItem.status().transacts() );
+}
+
+void statuscheck_stale()
+{
+  PoolItem reused( staleItem.satSolvable() );	// the item reusing the id
+  BOOST_REQUIRE( reused );
+  BOOST_CHECK( reused.resolvable() != staleItem.resolvable() );
+  BOOST_CHECK( ! reused.status().transacts() );
+  BOOST_CHECK( ! staleItem.status().transacts() );
+
+  staleItem.status().setLock( true, ResStatus::USER );
+  BOOST_CHECK( ! reused.status().isLocked() );
+  reused.status().setLock( true, ResStatus::USER );
+  BOOST_CHECK( ! staleItem.status().isLocked() );
+  reused.status().setLock( false, ResStatus::USER );
+
+  for ( auto && pi : ResPool::instance() )
+    BOOST_CHECK( ! pi.status().transacts() );
+  staleItem = PoolItem();
+}
+
 BOOST_AUTO_TEST_CASE(t_1)	{ testcase_init(); }
 BOOST_AUTO_TEST_CASE(t_2)	{ repocheck(); }
+BOOST_AUTO_TEST_CASE(t_3)	{ statuscheck_init(); }
 BOOST_AUTO_TEST_CASE(t_4)	{ testcase_init2(); }
 BOOST_AUTO_TEST_CASE(t_5)	{ repocheck(); }
+BOOST_AUTO_TEST_CASE(t_6)	{ statuscheck_stale(); }
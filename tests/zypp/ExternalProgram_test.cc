@@ -0,0 +1,33 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <iostream>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/String.h"
+#include "zypp/ExternalProgram.h"
+
+using namespace zypp;
+
+BOOST_AUTO_TEST_CASE(execute_and_read)
+{
+  ExternalProgram prog( "echo hello; exit 3", ExternalProgram::Stderr_To_Stdout );
+  BOOST_CHECK_EQUAL( prog.receiveLine(), "hello\n" );
+  BOOST_CHECK_EQUAL( prog.close(), 3 );
+}
+
+BOOST_AUTO_TEST_CASE(no_fd_leaks_into_child)
+{
+  // an fd opened without O_CLOEXEC must not be visible to the child
+  int fd = ::open( "/dev/null", O_RDONLY );
+  BOOST_REQUIRE( fd > 2 );
+  std::string cmd( str::form( "test -e /proc/self/fd/%d && echo leaked || echo closed", fd ) );
+  if ( ::access( "/proc/self/fd", F_OK ) == 0 )
+  {
+    ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
+    BOOST_CHECK_EQUAL( prog.receiveLine(), "closed\n" );
+    BOOST_CHECK_EQUAL( prog.close(), 0 );
+  }
+  ::close( fd );
+}
@@ -1,4 +1,5 @@
 
+#include <utime.h>
 #include <iostream>
 #include <fstream>
 #include <list>
@@ -11,6 +12,7 @@
 #include "zypp/TmpPath.h"
 
 #include "zypp/FileChecker.h"
+#include "zypp/media/StreamedChecksums.h"
 
 #include <boost/test/auto_unit_test.hpp>
 
@@ -88,3 +90,56 @@ BOOST_AUTO_TEST_CASE(checksum_test)
   }
 }
 
+
+BOOST_AUTO_TEST_CASE(streamed_checksum_test)
+{
+  TmpDir tmpdir;
+  Pathname file( tmpdir.path() / "file" );
+  Pathname link( tmpdir.path() / "link" );
+  {
+    ofstream str( file.c_str() );
+    str << "streamed" << endl;
+  }
+  CheckSum chk( "sha1", filesystem::checksum( file, "sha1" ) );
+
+  BOOST_CHECK( media::StreamedChecksums::lookup( file, "sha1" ).empty() );
+  media::StreamedChecksums::remember( file, chk );
+  BOOST_CHECK_EQUAL( media::StreamedChecksums::lookup( file, "sha1" ), chk );
+  BOOST_CHECK_EQUAL( media::StreamedChecksums::lookup( file, "SHA1" ), chk );
+  BOOST_CHECK( media::StreamedChecksums::lookup( file, "sha256" ).empty() );
+
+  // found via a hardlink too
+  BOOST_CHECK_EQUAL( hardlink( file, link ), 0 );
+  BOOST_CHECK_EQUAL( media::StreamedChecksums::lookup( link, "sha1" ), chk );
+  ChecksumFileChecker checker( chk );
+  checker( link );
+
+  // forgotten as soon as the file is modified
+  {
+    ofstream str( file.c_str(), ios_base::app );
+    str << "modified" << endl;
+  }
+  BOOST_CHECK( media::StreamedChecksums::lookup( file, "sha1" ).empty() );
+  BOOST_CHECK_THROW( checker( link ), zypp::FileCheckException );
+
+  // the checker trusts the streamed value rather than reading the file
+  CheckSum real( "sha1", filesystem::checksum( file, "sha1" ) );
+  CheckSum fake( "sha1", "0123456789abcdef0123456789abcdef01234567" );
+  media::StreamedChecksums::remember( file, fake );
+  ChecksumFileChecker fakeChecker( fake );
+  ChecksumFileChecker realChecker( real );
+  fakeChecker( file );
+  BOOST_CHECK_THROW( realChecker( file ), zypp::FileCheckException );
+
+  // same size, but a different mtime: forgotten too
+  {
+    ofstream str( file.c_str(), ios_base::in|ios_base::out );
+    str << "S";
+  }
+  struct utimbuf times = { 1000000000, 1000000000 };
+  BOOST_REQUIRE_EQUAL( ::utime( file.c_str(), &times ), 0 );
+  BOOST_CHECK( media::StreamedChecksums::lookup( file, "sha1" ).empty() );
+  ChecksumFileChecker modifiedChecker( CheckSum( "sha1", filesystem::checksum( file, "sha1" ) ) );
+  modifiedChecker( file );
+  BOOST_CHECK_THROW( fakeChecker( file ), zypp::FileCheckException );
+}
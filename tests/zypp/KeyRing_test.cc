@@ -197,14 +197,25 @@ BOOST_AUTO_TEST_CASE(signature_test)
     KeyRing keyring( tmp_dir.path() );
     
     BOOST_CHECK_EQUAL( keyring.readSignatureKeyId( DATADIR + "repomd.xml.asc" ), "BD61D89BD98821BE" );
+    // binary v4 signature (issuer subpacket)
+    BOOST_CHECK_EQUAL( keyring.readSignatureKeyId( DATADIR + "hello.txt.sig" ), "A716342356BAD136" );
     BOOST_CHECK_THROW( keyring.readSignatureKeyId(Pathname()), Exception );
     TmpFile tmp;
     BOOST_CHECK_EQUAL( keyring.readSignatureKeyId(tmp.path()), "" );
 
     keyring.importKey(key);
+    // exported keys are reused until the keyring changes
+    BOOST_REQUIRE_EQUAL( keyring.publicKeys().size(), 1U );
+    BOOST_CHECK_EQUAL( keyring.publicKeys().front().path(), keyring.publicKeys().front().path() );
 
     BOOST_CHECK(keyring.verifyFileSignature( DATADIR + "repomd.xml", DATADIR + "repomd.xml.asc"));
     BOOST_CHECK( ! keyring.verifyFileSignature( DATADIR + "repomd.xml.corrupted", DATADIR + "repomd.xml.asc"));
+    // SHA1 may be rejected by rpm's crypto policy: gpg must decide then
+    BOOST_CHECK(keyring.verifyFileSignature( DATADIR + "repomd.xml", DATADIR + "repomd.xml.sha1.asc"));
+    BOOST_CHECK( ! keyring.verifyFileSignature( DATADIR + "repomd.xml.corrupted", DATADIR + "repomd.xml.sha1.asc"));
+    // the parsed keyring follows key removal
+    keyring.deleteKey( key.id() );
+    BOOST_CHECK( ! keyring.verifyFileSignature( DATADIR + "repomd.xml", DATADIR + "repomd.xml.asc"));
   }
 }
 
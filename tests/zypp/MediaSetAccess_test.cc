@@ -264,4 +264,31 @@ BOOST_AUTO_TEST_CASE(msa_remote_tests)
 }
 
 
+/*
+ * prefetched files remote
+ */
+BOOST_AUTO_TEST_CASE(msa_remote_prefetch)
+{
+  WebServer web( DATADIR / "/src1/cd1", 10002 );
+  web.start();
+  MediaSetAccess setaccess( web.url(), "/" );
+
+  std::list<OnMediaLocation> resources;
+  resources.push_back( OnMediaLocation( "/dir/file1" ) );
+  resources.push_back( OnMediaLocation( "/dir/file2" ) );
+  resources.push_back( OnMediaLocation( "/test.txt" ) );
+  resources.push_back( OnMediaLocation( "/testBADNAME.txt" ) );
+  setaccess.prefetchFiles( resources );
+
+  // files are provided while the others are still in transfer
+  Pathname local = setaccess.provideFile("/test.txt");
+  BOOST_CHECK(CheckSum::sha1(sha1sum(local)) == CheckSum::sha1("2616e23301d7fcf7ac3324142f8c748cd0b6692b"));
+  BOOST_CHECK(PathInfo(setaccess.provideFile("/dir/file2")).isFile());
+  BOOST_CHECK(PathInfo(setaccess.provideFile("/dir/file1")).isFile());
+
+  // a failed prefetch is retried as usual
+  BOOST_CHECK_THROW(setaccess.provideFile("/testBADNAME.txt"), media::MediaFileNotFoundException);
+  web.stop();
+}
+
 // vim: set ts=2 sts=2 sw=2 ai et:
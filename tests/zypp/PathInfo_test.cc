@@ -210,3 +210,60 @@ BOOST_AUTO_TEST_CASE(test_exchange)
   BOOST_CHECK( PathInfo(a).isFile() );
   BOOST_CHECK( PathInfo(b).isDir() );
 }
+
+BOOST_AUTO_TEST_CASE(test_copy)
+{
+  TmpDir tmp;
+  Pathname src( tmp.path() / "src" );
+  Pathname dst( tmp.path() / "dst" );
+  BOOST_REQUIRE_EQUAL( assert_dir( src / "sub" ), 0 );
+  BOOST_REQUIRE_EQUAL( assert_dir( dst ), 0 );
+  {
+    ofstream str( (src / "file").c_str() );
+    str << "some data" << endl;
+  }
+  BOOST_REQUIRE_EQUAL( hardlink( src / "file", src / "sub" / "link" ), 0 );
+  BOOST_REQUIRE_EQUAL( symlink( "../file", src / "sub" / "symlink" ), 0 );
+
+  // copy
+  BOOST_CHECK_EQUAL( copy( src / "file", dst / "file" ), 0 );
+  BOOST_CHECK_EQUAL( checksum( dst / "file", "md5" ), checksum( src / "file", "md5" ) );
+  BOOST_CHECK( PathInfo( dst / "file" ).ino() != PathInfo( src / "file" ).ino() );
+  BOOST_CHECK_EQUAL( copy( src / "file", src / "file" ), EINVAL );
+  BOOST_CHECK_EQUAL( copy( src / "file", dst ), EISDIR );
+  BOOST_CHECK( PathInfo( src / "file" ).isFile() );
+
+  // copy_file2dir
+  BOOST_CHECK_EQUAL( copy_file2dir( src / "file", src / "sub" ), 0 );
+  BOOST_CHECK_EQUAL( checksum( src / "sub" / "file", "md5" ), checksum( src / "file", "md5" ) );
+  filesystem::unlink( src / "sub" / "file" );
+
+  // copy_dir: symlinks and hardlinks are preserved
+  BOOST_CHECK_EQUAL( copy_dir( src, dst ), 0 );
+  BOOST_CHECK_EQUAL( copy_dir( src, dst ), EEXIST );
+  BOOST_CHECK( PathInfo( dst / "src" / "sub" / "symlink", PathInfo::LSTAT ).isLink() );
+  BOOST_CHECK_EQUAL( readlink( dst / "src" / "sub" / "symlink" ), Pathname( "../file" ) );
+  BOOST_CHECK_EQUAL( PathInfo( dst / "src" / "file" ).ino(), PathInfo( dst / "src" / "sub" / "link" ).ino() );
+  BOOST_CHECK( PathInfo( dst / "src" / "file" ).ino() != PathInfo( src / "file" ).ino() );
+
+  // copy_dir_content: also into itself
+  BOOST_CHECK_EQUAL( copy_dir_content( src, dst / "src" / "sub" ), 0 );
+  BOOST_CHECK( PathInfo( dst / "src" / "sub" / "sub" / "symlink", PathInfo::LSTAT ).isLink() );
+  BOOST_CHECK_EQUAL( copy_dir_content( src, src / "sub" ), 0 );
+  BOOST_CHECK( PathInfo( src / "sub" / "file" ).isFile() );
+  BOOST_CHECK( ! PathInfo( src / "sub" / "sub" ).isExist() );
+
+  // copy_dir: a read-only directory is filled before it gets its mode
+  Pathname ro( tmp.path() / "ro" );
+  BOOST_REQUIRE_EQUAL( assert_dir( ro / "sub" ), 0 );
+  {
+    ofstream str( (ro / "sub" / "file").c_str() );
+    str << "some data" << endl;
+  }
+  BOOST_REQUIRE_EQUAL( chmod( ro / "sub", 0555 ), 0 );
+  BOOST_CHECK_EQUAL( copy_dir( ro, dst ), 0 );
+  BOOST_CHECK( PathInfo( dst / "ro" / "sub" / "file" ).isFile() );
+  BOOST_CHECK_EQUAL( PathInfo( dst / "ro" / "sub" ).uperm(), mode_t(0500) );
+  chmod( ro / "sub", 0755 );
+  chmod( dst / "ro" / "sub", 0755 );
+}
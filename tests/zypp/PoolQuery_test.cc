@@ -1,6 +1,8 @@
 #include "TestSetup.h"
 #include "zypp/PoolQuery.h"
+#include "zypp/PoolQueryResult.h"
 #include "zypp/PoolQueryUtil.tcc"
+#include "zypp/sat/SearchIndex.h"
 
 #define BOOST_TEST_MODULE PoolQuery
 
@@ -840,3 +842,174 @@ BOOST_AUTO_TEST_CASE(addDependency)
 }
 
 
+
+BOOST_AUTO_TEST_CASE(collect_parallel)
+{
+  cout << "****collect_parallel****"  << endl;
+  std::list<PoolQuery> queries;
+  {
+    PoolQuery q;
+    q.addAttribute( sat::SolvAttr::name, "zypp" );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;	// more than 1 attribute
+    q.addString( "kernel" );
+    q.addAttribute( sat::SolvAttr::name );
+    q.addAttribute( sat::SolvAttr::summary );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;	// predicate
+    q.addDependency( sat::SolvAttr::provides, "kernel", Rel::GT, Edition("0") );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;	// data loaded on demand
+    q.addAttribute( sat::SolvAttr::description, "kernel" );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;	// filelist, full path
+    q.addAttribute( sat::SolvAttr::filelist, "/usr/bin/zypper" );
+    q.setMatchExact();
+    q.setFilesMatchFullPath();
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;	// filelist, glob on the full path
+    q.addAttribute( sat::SolvAttr::filelist, "/usr/bin/*2solv" );
+    q.setMatchGlob();
+    q.setFilesMatchFullPath();
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;	// filelist, basename only
+    q.addAttribute( sat::SolvAttr::filelist, "zypp.conf" );
+    q.setMatchExact();
+    queries.push_back( q );
+  }
+
+  for ( const PoolQuery & q : queries )
+  {
+    std::vector<sat::Solvable> serial( q.begin(), q.end() );
+    BOOST_CHECK( ! serial.empty() );
+    BOOST_CHECK( q.collectThreads( 4 ) > 1 );
+    BOOST_CHECK( q.collect( 1 ) == serial );
+    BOOST_CHECK( q.collect( 4 ) == serial );
+    BOOST_CHECK_EQUAL( PoolQueryResult( q, 4 ).size(), serial.size() );
+  }
+
+  {
+    PoolQuery q;	// all attributes: evaluated serially
+    q.addString( "kernel" );
+    BOOST_CHECK_EQUAL( q.collectThreads( 4 ), 1U );
+    BOOST_CHECK( q.collect( 4 ) == std::vector<sat::Solvable>( q.begin(), q.end() ) );
+  }
+  {
+    PoolQuery q;	// an invalid query adds nothing, like PoolQueryResult::operator+=
+    q.addAttribute( sat::SolvAttr::name, "[" );
+    q.setMatchRegex();
+    BOOST_CHECK_THROW( q.collect( 4 ), MatchException );
+    BOOST_CHECK( PoolQueryResult( q, 4 ).empty() );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(compiled_query_reuse)
+{
+  cout << "****compiled_query_reuse****"  << endl;
+  PoolQuery q;
+  q.addAttribute( sat::SolvAttr::name, "zypper" );
+  q.setMatchExact();
+  unsigned zypper = q.size();
+  BOOST_CHECK( zypper > 0 );
+  BOOST_CHECK_EQUAL( q.size(), zypper );	// compiled query reused
+
+  // changing a copy must not affect the original
+  PoolQuery p( q );
+  p.addAttribute( sat::SolvAttr::name, "kernel-default" );
+  BOOST_CHECK( p.size() > zypper );
+  BOOST_CHECK_EQUAL( q.size(), zypper );
+
+  // changes after the query was evaluated recompile it
+  q.setMatchSubstring();
+  BOOST_CHECK( q.size() >= zypper );
+  q.setCaseSensitive( false );
+  q.addKind( ResKind::patch );
+  for_( it, q.begin(), q.end() )
+    BOOST_CHECK( it->isKind( ResKind::patch ) );
+}
+
+BOOST_AUTO_TEST_CASE(search_index)
+{
+  cout << "****search_index****"  << endl;
+  std::list<PoolQuery> queries;
+  {
+    PoolQuery q;
+    q.addAttribute( sat::SolvAttr::name, "zypp" );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addAttribute( sat::SolvAttr::summary, "Kernel" );
+    q.setCaseSensitive( false );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;
+    q.addAttribute( sat::SolvAttr::description, "*lib*zypp*" );
+    q.setMatchGlob();
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;	// too short for the index
+    q.addAttribute( sat::SolvAttr::name, "ke" );
+    queries.push_back( q );
+  }
+  {
+    PoolQuery q;	// no match at all
+    q.addAttribute( sat::SolvAttr::name, "qqqqxxxx" );
+    queries.push_back( q );
+  }
+
+  std::list<std::vector<sat::Solvable>> expected;
+  for ( const PoolQuery & q : queries )
+    expected.push_back( std::vector<sat::Solvable>( q.begin(), q.end() ) );
+
+  RepoManager repoManager( test.repomanager() );
+  Pathname solvCachePath( RepoManagerOptions::makeTestSetup( test.root() ).repoSolvCachePath );
+  for ( const std::string & alias : { "opensuse", "zyppsvn" } )
+  {
+    Repository repo( test.satpool().reposFind( alias ) );
+    RepoStatus status( repoManager.cacheStatus( repo.info() ) );
+    Pathname solvfile( solvCachePath / alias / "solv" );
+    BOOST_REQUIRE( sat::SearchIndex::build( solvfile, status ) );
+    BOOST_CHECK( ! sat::SearchIndex::attach( repo, solvfile, RepoStatus() ) );	// outdated
+    BOOST_CHECK( sat::SearchIndex::attach( repo, solvfile, status ) );
+  }
+  BOOST_CHECK( sat::SearchIndex::available() );
+
+  std::list<std::vector<sat::Solvable>>::const_iterator eit( expected.begin() );
+  for ( const PoolQuery & q : queries )
+  {
+    std::vector<sat::Solvable> result( q.begin(), q.end() );
+    BOOST_CHECK( result == *eit );
+    ++eit;
+  }
+
+  for ( const std::string & alias : { "opensuse", "zyppsvn" } )
+    sat::SearchIndex::detach( test.satpool().reposFind( alias ) );
+  BOOST_CHECK( ! sat::SearchIndex::available() );
+
+  // erasing a repo from the pool detaches its index (libsolv reuses the repo)
+  {
+    Repository repo( test.satpool().reposFind( "zyppsvn" ) );
+    RepoStatus status( repoManager.cacheStatus( repo.info() ) );
+    Pathname solvfile( solvCachePath / "zyppsvn" / "solv" );
+    Repository copy( test.satpool().addRepoSolv( solvfile, "zyppsvn-copy" ) );
+    BOOST_CHECK( sat::SearchIndex::attach( copy, solvfile, status ) );
+    BOOST_CHECK( sat::SearchIndex::available() );
+    copy.eraseFromPool();
+    BOOST_CHECK( ! sat::SearchIndex::available() );
+  }
+}
@@ -271,6 +271,80 @@ BOOST_AUTO_TEST_CASE(repomanager_test)
 
 }
 
+BOOST_AUTO_TEST_CASE(refresh_metadata_batch)
+{
+  KeyRingTestReceiver keyring_callbacks;
+  KeyRingTestSignalReceiver receiver;
+
+  // disable sgnature checking
+  keyring_callbacks.answerAcceptKey(KeyRingReport::KEY_TRUST_TEMPORARILY);
+  keyring_callbacks.answerAcceptVerFailed(true);
+  keyring_callbacks.answerAcceptUnknownKey(true);
+
+  TmpDir tmpCachePath;
+  RepoManager manager( RepoManagerOptions::makeTestSetup( tmpCachePath ) );
+
+  list<RepoInfo> repos;
+  {
+    RepoInfo repo;
+    repo.setAlias("yum");
+    repo.setType(RepoType::RPMMD);
+    repo.setBaseUrl( (Pathname(TESTS_SRC_DIR) / "/repo/yum/data/10.2-updates-subset").asDirUrl() );
+    repos.push_back( repo );
+  }
+  {
+    RepoInfo repo;
+    repo.setAlias("missing");
+    repo.setType(RepoType::RPMMD);
+    repo.setBaseUrl( (Pathname(TESTS_SRC_DIR) / "/repo/yum/data/does-not-exist").asDirUrl() );
+    repos.push_back( repo );
+  }
+  {
+    RepoInfo repo;
+    repo.setAlias("susetags");
+    repo.setType(RepoType::YAST2);
+    repo.setBaseUrl( REPODATADIR.asDirUrl() );
+    repo.setPath("/updates");
+    repos.push_back( repo );
+  }
+  {
+    RepoInfo repo;
+    repo.setAlias("nourl");
+    repos.push_back( repo );
+  }
+
+  // all repos are processed, each error is reported
+  RepoManager::RefreshErrors errors( manager.refreshMetadata( repos ) );
+  BOOST_CHECK_EQUAL( errors.size(), 2 );
+  BOOST_REQUIRE( errors.count( "missing" ) );
+  BOOST_CHECK_THROW( std::rethrow_exception( errors["missing"] ), RepoException );
+  BOOST_REQUIRE( errors.count( "nourl" ) );
+  BOOST_CHECK_THROW( std::rethrow_exception( errors["nourl"] ), RepoNoUrlException );
+
+  for ( const RepoInfo & repo : repos )
+  {
+    if ( ! errors.count( repo.alias() ) )
+      BOOST_CHECK_MESSAGE( ! manager.metadataStatus( repo ).empty(), "Metadata of " + repo.alias() );
+  }
+
+  // nothing changed
+  errors = manager.refreshMetadata( repos, RepoManager::RefreshIfNeededIgnoreDelay );
+  BOOST_CHECK_EQUAL( errors.size(), 2 );
+
+  // buildCache reports the errors the same way
+  RepoManager::RepoErrors cacheErrors( manager.buildCache( repos, RepoManager::BuildIfNeeded, 2 ) );
+  BOOST_CHECK_EQUAL( cacheErrors.size(), 2 );
+  BOOST_REQUIRE( cacheErrors.count( "missing" ) );
+  BOOST_CHECK_THROW( std::rethrow_exception( cacheErrors["missing"] ), RepoException );
+  BOOST_REQUIRE( cacheErrors.count( "nourl" ) );
+  BOOST_CHECK_THROW( std::rethrow_exception( cacheErrors["nourl"] ), RepoNoUrlException );
+  for ( const RepoInfo & repo : repos )
+  {
+    if ( ! cacheErrors.count( repo.alias() ) )
+      BOOST_CHECK_MESSAGE( manager.isCached( repo ), "Cache of " + repo.alias() );
+  }
+}
+
 BOOST_AUTO_TEST_CASE(repo_seting_test)
 {
   RepoInfo repo;
@@ -0,0 +1,57 @@
+#include <cstdlib>
+#include <iostream>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "zypp/base/Logger.h"
+#include "zypp/PathInfo.h"
+#include "zypp/TmpPath.h"
+#include "zypp/target/rpm/RpmDb.h"
+#include "zypp/target/rpm/RpmHeader.h"
+
+using std::cout;
+using std::endl;
+using namespace zypp;
+using namespace zypp::target::rpm;
+
+/** Install and remove a package in a scratch root using the in-process
+ * librpm backend (\c ZYPP_RPM_INPROCESS).
+ *
+ * Disabled by default, as the testsuite does not ship an rpm. Point
+ * \c ZYPP_TESTSUITE_RPMDB_PACKAGE to a package without dependencies
+ * and scripts to enable it.
+ */
+BOOST_AUTO_TEST_CASE(rpmdb_inprocess_install_remove)
+{
+  const char * pkg = ::getenv( "ZYPP_TESTSUITE_RPMDB_PACKAGE" );
+  if ( ! pkg || ! *pkg )
+  {
+    cout << "ZYPP_TESTSUITE_RPMDB_PACKAGE not set: skipping" << endl;
+    return;
+  }
+  BOOST_REQUIRE( PathInfo( pkg ).isFile() );
+  // must be set before the first package is processed
+  ::setenv( "ZYPP_RPM_INPROCESS", "1", 1 );
+
+  RpmHeader::constPtr hdr( RpmHeader::readPackage( pkg, RpmHeader::NOVERIFY ) );
+  BOOST_REQUIRE( hdr );
+  const std::string name( hdr->tag_name() );
+
+  filesystem::TmpDir root;
+  RpmDb db;
+  db.initDatabase( root.path(), "/var/lib/rpm" );
+  BOOST_CHECK( PathInfo( root.path() / "/var/lib/rpm" ).isDir() );
+  BOOST_CHECK( ! db.hasPackage( name ) );
+
+  RpmInstFlags flags( RPMINST_NODEPS | RPMINST_NOSIGNATURE | RPMINST_IGNORESIZE );
+  db.installPackage( pkg, flags );
+  BOOST_CHECK( db.hasPackage( name ) );
+  BOOST_CHECK( db.hasPackage( name, hdr->tag_edition() ) );
+
+  // A second package op reuses the open transaction set.
+  db.removePackage( name, flags );
+  BOOST_CHECK( ! db.hasPackage( name ) );
+
+  db.releaseLibrpmTransaction();
+  db.closeDatabase();
+}
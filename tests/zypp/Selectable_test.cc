@@ -346,3 +346,60 @@ BOOST_AUTO_TEST_CASE(pickstatus_cycle)
 }
 
 /////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE(incremental_proxy)
+{
+  ResPoolProxy poolProxy( test.poolProxy() );
+  ui::Selectable::Ptr untouched( poolProxy.lookup( ResKind::package, "installed_only" ) );
+  ui::Selectable::Ptr touched( poolProxy.lookup( ResKind::package, "candidate" ) );
+  BOOST_REQUIRE( untouched && touched );
+  unsigned available = touched->availableSize();
+
+  // adding a repo rebuilds just the Selectables it contributes to
+  test.loadHelix( TESTS_SRC_DIR"/data/TCSelectable/RepoHIGH.xml", "incremental" );
+  {
+    ResPoolProxy newProxy( test.poolProxy() );
+    BOOST_CHECK_EQUAL( newProxy.lookup( ResKind::package, "installed_only" ), untouched );
+    ui::Selectable::Ptr sel( newProxy.lookup( ResKind::package, "candidate" ) );
+    BOOST_CHECK( sel != touched );
+    BOOST_CHECK_EQUAL( sel->availableSize(), available + 2 );
+    BOOST_CHECK_EQUAL( newProxy.size(), poolProxy.size() );
+  }
+
+  sat::Pool::instance().reposErase( "incremental" );
+  {
+    ResPoolProxy newProxy( test.poolProxy() );
+    BOOST_CHECK_EQUAL( newProxy.lookup( ResKind::package, "installed_only" ), untouched );
+    BOOST_CHECK_EQUAL( newProxy.lookup( ResKind::package, "candidate" )->availableSize(), available );
+  }
+  // the old proxy is a snapshot and still valid
+  BOOST_CHECK_EQUAL( poolProxy.lookup( ResKind::package, "candidate" ), touched );
+}
+
+BOOST_AUTO_TEST_CASE(lazy_proxy)
+{
+  ResPoolProxy poolProxy( test.poolProxy() );
+  // Selectables are created on demand, but lookup and iteration agree
+  ui::Selectable::Ptr s( poolProxy.lookup( ResKind::package, "available_only" ) );
+  BOOST_REQUIRE( s );
+  BOOST_CHECK_EQUAL( unsigned(std::distance( poolProxy.byKindBegin( ResKind::package ), poolProxy.byKindEnd( ResKind::package ) )),
+                     unsigned(poolProxy.size( ResKind::package )) );
+  BOOST_CHECK( std::find( poolProxy.byKindBegin( ResKind::package ), poolProxy.byKindEnd( ResKind::package ), s ) != poolProxy.byKindEnd( ResKind::package ) );
+  BOOST_CHECK_EQUAL( unsigned(std::distance( poolProxy.begin(), poolProxy.end() )), unsigned(poolProxy.size()) );
+  BOOST_CHECK( ! poolProxy.lookup( ResKind::package, "no_such_package" ) );
+}
+
+BOOST_AUTO_TEST_CASE(lazy_proxy_kind_iterators)
+{
+  ResPoolProxy poolProxy( test.poolProxy() );
+  // creating further kinds must not extend a range handed out before
+  ResPoolProxy::const_iterator b( poolProxy.byKindBegin( ResKind::package ) );
+  ResPoolProxy::const_iterator e( poolProxy.byKindEnd( ResKind::package ) );
+  for ( const ResKind & kind : { ResKind::patch, ResKind::pattern, ResKind::product, ResKind::srcpackage } )
+    BOOST_CHECK_EQUAL( unsigned(std::distance( poolProxy.byKindBegin( kind ), poolProxy.byKindEnd( kind ) )),
+                       unsigned(poolProxy.size( kind )) );
+  poolProxy.begin();
+  BOOST_CHECK_EQUAL( unsigned(std::distance( b, e )), unsigned(poolProxy.size( ResKind::package )) );
+  for ( ; b != e; ++b )
+    BOOST_CHECK_EQUAL( (*b)->kind(), ResKind::package );
+}
@@ -12,6 +12,8 @@
 #include "zypp/ZYpp.h"
 #include "zypp/ZYppFactory.h"
 #include "zypp/TmpPath.h"
+#include "zypp/Repository.h"
+#include "zypp/sat/Pool.h"
 
 using boost::unit_test::test_case;
 using namespace std;
@@ -55,3 +57,28 @@ BOOST_AUTO_TEST_CASE(target_test)
     BOOST_CHECK_EQUAL( dlabel.summary, "A cool distribution" );
     BOOST_CHECK_EQUAL( dlabel.shortName, "" );
 }
+
+BOOST_AUTO_TEST_CASE(target_system_solv)
+{
+    filesystem::TmpDir tmp;
+
+    ZYpp::Ptr z = getZYpp();
+
+    assert_dir(tmp.path() / "/etc/products.d" );
+    BOOST_CHECK( copy( Pathname(TESTS_SRC_DIR) / "/zypp/data/Target/product.prod",  tmp.path() / "/etc/products.d/product.prod") == 0 );
+
+    z->initializeTarget( tmp.path() );
+
+    // @System is built from the (empty) rpmdb and products.d below the root
+    z->target()->load();
+    Repository system( sat::Pool::instance().findSystemRepo() );
+    BOOST_REQUIRE( system );
+    unsigned products = 0;
+    for ( const sat::Solvable & solv : system.solvables() )
+    {
+      if ( solv.isKind( ResKind::product ) && solv.name() == "SUSE_SLES" )
+        ++products;
+    }
+    BOOST_CHECK_EQUAL( products, 1U );
+    z->target()->unload();
+}
@@ -0,0 +1,179 @@
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <zypp/Digest.h>
+#include <zypp/PathInfo.h>
+#include <zypp/Pathname.h>
+#include <zypp/TmpPath.h>
+#include <zypp/media/MediaBlockList.h>
+#include <zypp/media/MetaLinkParser.h>
+#include <zypp/media/ZsyncParser.h>
+
+using std::cout;
+using std::endl;
+using zypp::Pathname;
+using zypp::media::MediaBlockList;
+
+static int usage( const char * prog_r )
+{
+  cout <<
+  "Usage: " << Pathname::basename( prog_r ) << " [OPTION]... [OLDFILE]\n"
+  "Time MediaBlockList::reuseBlocks, scanning OLDFILE for the blocks of a block list.\n"
+  "\n"
+  "  --zsync FILE     Take the block list from a .zsync file.\n"
+  "  --metalink FILE  Take the block list from a .metalink/.meta4 file.\n"
+  "  --threads N      Scan using N threads (default: 0, automatic).\n"
+  "  --runs N         Best of N runs (default: 3).\n"
+  "\n"
+  "Without a block list file a zsync like list for a random file is created, and\n"
+  "OLDFILE is a copy of it with some bytes inserted, removed and changed:\n"
+  "  --size MB        Size of the random file (default: 256).\n"
+  "  --blksize N      Block size (default: 4096).\n"
+  "  --csl N          Strong checksum length, < 16 checks pairs of blocks (default: 8).\n"
+  "  --edits N        Number of edits in OLDFILE (default: 64).\n"
+  "\n";
+  return 0;
+}
+
+// a zsync like block list for data_r (rsum length 4, SHA1 instead of MD4)
+static MediaBlockList syntheticBlockList( const std::vector<unsigned char> & data_r, size_t blksize_r, int csl_r )
+{
+  MediaBlockList bl( data_r.size() );
+  for ( size_t off = 0, blkno = 0; off < data_r.size(); off += blksize_r, ++blkno )
+  {
+    size_t size = std::min( blksize_r, data_r.size() - off );
+    bl.addBlock( off, size );
+    std::vector<unsigned char> block( blksize_r, 0 );
+    std::copy( data_r.begin() + off, data_r.begin() + off + size, block.begin() );
+    bl.setRsum( blkno, 4, bl.updateRsum( 0, (const char *)&block[0], blksize_r ), blksize_r );
+    zypp::Digest dig;
+    dig.create( zypp::Digest::sha1() );
+    dig.update( (const char *)&block[0], blksize_r );
+    std::vector<unsigned char> sum( dig.digestVector() );
+    bl.setChecksum( blkno, "SHA1", csl_r, &sum[0], blksize_r );
+  }
+  return bl;
+}
+
+int main( int argc, const char * argv[] )
+{
+  const char * prog = argv[0];
+  Pathname zsync;
+  Pathname metalink;
+  Pathname oldfile;
+  unsigned threads = 0;
+  unsigned runs = 3;
+  size_t size = 256;
+  size_t blksize = 4096;
+  int csl = 8;
+  unsigned edits = 64;
+
+  for ( --argc, ++argv; argc; --argc, ++argv )
+  {
+    std::string arg( *argv );
+    if ( arg == "-h" || arg == "--help" )
+      return usage( prog );
+    if ( arg[0] != '-' )
+    {
+      oldfile = arg;
+      continue;
+    }
+    if ( argc < 2 )
+    {
+      std::cerr << "Missing argument to " << arg << endl;
+      return 1;
+    }
+    --argc, ++argv;
+    if ( arg == "--zsync" )		zsync = *argv;
+    else if ( arg == "--metalink" )	metalink = *argv;
+    else if ( arg == "--threads" )	threads = atoi( *argv );
+    else if ( arg == "--runs" )		runs = std::max( 1, atoi( *argv ) );
+    else if ( arg == "--size" )		size = atol( *argv );
+    else if ( arg == "--blksize" )	blksize = atol( *argv );
+    else if ( arg == "--csl" )		csl = atoi( *argv );
+    else if ( arg == "--edits" )	edits = atoi( *argv );
+    else
+    {
+      std::cerr << "Unknown option " << arg << endl;
+      return 1;
+    }
+  }
+
+  MediaBlockList blocklist;
+  zypp::filesystem::TmpFile tmpold;
+  if ( ! zsync.empty() || ! metalink.empty() )
+  {
+    if ( oldfile.empty() )
+    {
+      std::cerr << "OLDFILE is needed with a block list file" << endl;
+      return 1;
+    }
+    if ( ! zsync.empty() )
+    {
+      zypp::media::ZsyncParser parser;
+      parser.parse( zsync.asString() );
+      blocklist = parser.getBlockList();
+    }
+    else
+    {
+      zypp::media::MetaLinkParser parser;
+      parser.parse( metalink );
+      blocklist = parser.getBlockList();
+    }
+  }
+  else
+  {
+    srand( 42 );
+    std::vector<unsigned char> data( size * 1024 * 1024 );
+    for ( unsigned char & c : data )
+      c = rand();
+    blocklist = syntheticBlockList( data, blksize, csl );
+
+    for ( unsigned i = 0; i < edits; ++i )
+    {
+      size_t pos = (size_t)rand() % data.size();
+      size_t len = 1 + rand() % 1000;
+      switch ( i % 3 )
+      {
+        case 0:
+          data.insert( data.begin() + pos, len, (unsigned char)rand() );
+          break;
+        case 1:
+          data.erase( data.begin() + pos, data.begin() + std::min( pos + len, data.size() ) );
+          break;
+        default:
+          for ( ; len && pos < data.size(); --len, ++pos )
+            data[pos] ^= 0x55;
+          break;
+      }
+    }
+    oldfile = tmpold.path();
+    std::ofstream( oldfile.c_str(), std::ios::binary ).write( (const char *)&data[0], data.size() );
+  }
+
+  cout << "blocks: " << blocklist.numBlocks() << " file: " << oldfile << " threads: " << threads << endl;
+  double best = 0;
+  size_t left = 0;
+  off_t reused = 0;
+  for ( unsigned run = 0; run < runs; ++run )
+  {
+    MediaBlockList bl( blocklist );
+    zypp::filesystem::TmpFile target;
+    FILE * fp = fopen( target.path().c_str(), "w" );
+    auto start = std::chrono::steady_clock::now();
+    reused = bl.reuseBlocks( fp, oldfile.asString(), threads );
+    double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    fclose( fp );
+    cout << "run " << run << ": " << elapsed << "s" << endl;
+    if ( ! run || elapsed < best )
+      best = elapsed;
+    left = bl.numBlocks();
+  }
+  off_t oldsize = zypp::PathInfo( oldfile ).size();
+  cout << "reused " << ( blocklist.numBlocks() - left ) << " of " << blocklist.numBlocks() << " blocks, " << reused << " bytes" << endl;
+  cout << "best: " << best << "s, " << ( best ? oldsize / best / 1024 / 1024 : 0 ) << " MB/s" << endl;
+  return 0;
+}
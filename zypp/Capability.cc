@@ -10,6 +10,9 @@
  *
 */
 #include <iostream>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
 #include "zypp/base/Logger.h"
 
 #include "zypp/base/String.h"
@@ -202,10 +205,10 @@ namespace zypp
 
     /** Full parse from string, unless Capability::PARSED.
     */
-    sat::detail::IdType relFromStr( sat::detail::CPool * pool_r,
-                                    const Arch & arch_r, // parse from name if empty
-                                    const std::string & str_r, const ResKind & kind_r,
-                                    Capability::CtorFlag flag_r )
+    sat::detail::IdType relFromStrParsed( sat::detail::CPool * pool_r,
+                                          const Arch & arch_r, // parse from name if empty
+                                          const std::string & str_r, const ResKind & kind_r,
+                                          Capability::CtorFlag flag_r )
     {
       std::string name( str_r );
       Rel         op;
@@ -221,6 +224,101 @@ namespace zypp
       return relFromStr( pool_r, arch_r, name, op, ed, kind_r );
     }
 
+    ///////////////////////////////////////////////////////////////////
+    /// \class BoundedCache
+    /// \brief Thread safe map holding at most \c max_r entries.
+    /// Cleared when full, which is cheap and good enough for the
+    /// typical working sets (a lockfile, a solver run).
+    ///////////////////////////////////////////////////////////////////
+    template <class TKey, class TValue>
+    class BoundedCache
+    {
+    public:
+      BoundedCache( size_t max_r )
+      : _max( max_r ), _hits( 0 ), _misses( 0 )
+      {}
+
+      bool get( const TKey & key_r, TValue & value_r )
+      {
+        std::lock_guard<std::mutex> lock( _mutex );
+        auto it( _map.find( key_r ) );
+        if ( it == _map.end() )
+        {
+          ++_misses;
+          return false;
+        }
+        ++_hits;
+        value_r = it->second;
+        return true;
+      }
+
+      void put( const TKey & key_r, const TValue & value_r )
+      {
+        std::lock_guard<std::mutex> lock( _mutex );
+        if ( _map.size() >= _max )
+          _map.clear();
+        _map[key_r] = value_r;
+      }
+
+      void counters( unsigned long & hits_r, unsigned long & misses_r ) const
+      {
+        std::lock_guard<std::mutex> lock( _mutex );
+        hits_r = _hits;
+        misses_r = _misses;
+      }
+
+      void clear()
+      {
+        std::lock_guard<std::mutex> lock( _mutex );
+        _map.clear();
+        _hits = _misses = 0;
+      }
+
+    private:
+      mutable std::mutex _mutex;
+      std::unordered_map<TKey,TValue> _map;
+      size_t _max;
+      unsigned long _hits;
+      unsigned long _misses;
+    };
+
+    /** Parsed Capability ids by ctor arguments. */
+    BoundedCache<std::string,sat::detail::IdType> & parseCache()
+    {
+      static BoundedCache<std::string,sat::detail::IdType> _cache( 4096 );
+      return _cache;
+    }
+
+    /** \ref Capability::_doMatch results by <tt>(lhs,rhs)</tt>. */
+    BoundedCache<uint64_t,CapMatch> & matchCache()
+    {
+      static BoundedCache<uint64_t,CapMatch> _cache( 32768 );
+      return _cache;
+    }
+
+    /** Full parse from string, unless Capability::PARSED (cached).
+    */
+    sat::detail::IdType relFromStr( sat::detail::CPool * pool_r,
+                                    const Arch & arch_r, // parse from name if empty
+                                    const std::string & str_r, const ResKind & kind_r,
+                                    Capability::CtorFlag flag_r )
+    {
+      // The result depends on the arguments only, so the same string
+      // needs not to be parsed again.
+      std::string key( str::numstring( arch_r.id() ) );
+      key += ':';
+      key += str::numstring( kind_r.id() );
+      key += ( flag_r == Capability::UNPARSED ? ":U:" : ":P:" );
+      key += str_r;
+
+      sat::detail::IdType ret = sat::detail::noId;
+      if ( parseCache().get( key, ret ) )
+        return ret;
+      ret = relFromStrParsed( pool_r, arch_r, str_r, kind_r, flag_r );
+      parseCache().put( key, ret );
+      return ret;
+    }
+
     /////////////////////////////////////////////////////////////////
   } // namespace
   ///////////////////////////////////////////////////////////////////
@@ -316,6 +414,17 @@ namespace zypp
     if ( lhs == rhs )
       return CapMatch::yes;
 
+    uint64_t key = ( uint64_t(lhs) << 32 ) | uint32_t(rhs);
+    CapMatch ret;
+    if ( matchCache().get( key, ret ) )
+      return ret;
+    ret = _doMatchUncached( lhs, rhs );
+    matchCache().put( key, ret );
+    return ret;
+  }
+
+  CapMatch Capability::_doMatchUncached( sat::detail::IdType lhs,  sat::detail::IdType rhs )
+  {
     CapDetail l( lhs );
     CapDetail r( rhs );
 
@@ -362,6 +471,20 @@ namespace zypp
                      Edition::MatchRange( r.op(), r.ed() ) );
   }
 
+  Capability::CacheStats Capability::cacheStats()
+  {
+    CacheStats ret;
+    parseCache().counters( ret.parseHits, ret.parseMisses );
+    matchCache().counters( ret.matchHits, ret.matchMisses );
+    return ret;
+  }
+
+  void Capability::clearCache()
+  {
+    parseCache().clear();
+    matchCache().clear();
+  }
+
   bool Capability::isInterestingFileSpec( const char * name_r )
   {
     static       str::smatch what;
@@ -436,6 +559,12 @@ namespace zypp
   **	FUNCTION NAME : operator<<
   **	FUNCTION TYPE : std::ostream &
   */
+  std::ostream & operator<<( std::ostream & str, const Capability::CacheStats & obj )
+  {
+    return str << "CapCache(parse " << obj.parseHits << "/" << obj.parseMisses
+               << ", match " << obj.matchHits << "/" << obj.matchMisses << " hits/misses)";
+  }
+
   std::ostream & operator<<( std::ostream & str, const Capability & obj )
   {
     return str << obj.detail();
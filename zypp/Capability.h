@@ -207,6 +207,34 @@ namespace zypp
         { return Capability::matches( lhs, rhs ); }
       };
 
+    public:
+      /** \name Parse and match caches.
+       *
+       * Capabilities parsed from a string and the results of \ref matches
+       * are remembered in bounded process wide caches (cleared when full).
+       * Ids are never released by the pool, so a cached id or result is valid
+       * as long as the process lives. Access is thread safe.
+       */
+      //@{
+      /** Hit/miss counters of the caches. */
+      struct CacheStats
+      {
+        CacheStats()
+        : parseHits( 0 ), parseMisses( 0 ), matchHits( 0 ), matchMisses( 0 )
+        {}
+        unsigned long parseHits;
+        unsigned long parseMisses;
+        unsigned long matchHits;
+        unsigned long matchMisses;
+      };
+
+      /** The current hit/miss counters. */
+      static CacheStats cacheStats();
+
+      /** Clear the caches and reset the counters. */
+      static void clearCache();
+      //@}
+
     public:
       /** Test for a filename that is likely being REQUIRED.
        * Files below \c /bin , \c /sbin ,  \c /lib etc. Scanning a
@@ -255,11 +283,16 @@ namespace zypp
     private:
       /** Match two Capabilities */
       static CapMatch _doMatch( sat::detail::IdType lhs,  sat::detail::IdType rhs );
+      /** \ref _doMatch bypassing the match cache */
+      static CapMatch _doMatchUncached( sat::detail::IdType lhs,  sat::detail::IdType rhs );
     private:
       sat::detail::IdType _id;
   };
   ///////////////////////////////////////////////////////////////////
 
+  /** \relates Capability::CacheStats Stream output */
+  std::ostream & operator<<( std::ostream & str, const Capability::CacheStats & obj );
+
   /** \relates Capability Stream output */
   std::ostream & operator<<( std::ostream & str, const Capability & obj );
 
@@ -13,6 +13,12 @@ extern "C"
 {
 #include <solv/evr.h>
 }
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "zypp/base/LogTools.h"
 #include "zypp/base/String.h"
 
 #include "zypp/Edition.h"
@@ -47,6 +53,103 @@ namespace zypp
                          std::string(release_r?release_r:""),
                          epoch_r );
     }
+    ///////////////////////////////////////////////////////////////////
+    /// \class EvrRankIndex
+    /// \brief Sortable key for the EVRs used by the pools solvables.
+    ///
+    /// All distinct EVR ids of the pools solvables are sorted once and
+    /// get a rank (equal EVRs share the rank). Comparing two ranked ids
+    /// is an integer compare. The ranks are an immutable snapshot, rebuilt
+    /// on demand if the pools content has changed. Each thread keeps the
+    /// snapshot it used last, so concurrent compares (e.g. in parallel
+    /// \ref PoolQuery workers) don't serialize on a lock.
+    ///////////////////////////////////////////////////////////////////
+    class EvrRankIndex : private sat::detail::PoolMember
+    {
+      struct Snapshot
+      {
+        unsigned              serial;	// the pools serial it was built for
+        std::vector<unsigned> rank;	// rank by EVR id
+      };
+
+    public:
+      /** Compare \a lhs and \a rhs by rank.
+       * \return \c false if either id is not ranked (ad-hoc edition).
+       */
+      bool compare( sat::detail::IdType lhs, sat::detail::IdType rhs, int & result_r )
+      {
+        const std::vector<unsigned> & rank( current().rank );
+        if ( unsigned(lhs) >= rank.size() || unsigned(rhs) >= rank.size() )
+          return false;
+        unsigned l = rank[lhs];
+        unsigned r = rank[rhs];
+        if ( ! ( l && r ) )
+          return false;
+        result_r = ( l == r ? 0 : ( l < r ? -1 : 1 ) );
+        return true;
+      }
+
+    private:
+      /** The snapshot for the pools current content.
+       * The mutex is taken only if the pool changed since this thread's last compare.
+       */
+      const Snapshot & current()
+      {
+        static thread_local std::shared_ptr<const Snapshot> _cache;
+        unsigned serial = myPool().serial().serial();
+        if ( ! ( _cache && _cache->serial == serial ) )
+        {
+          std::lock_guard<std::mutex> lock( _mutex );
+          if ( ! ( _latest && _latest->serial == serial ) )
+            _latest = build( serial );
+          _cache = _latest;
+        }
+        return *_cache;
+      }
+
+      /** Must not log: may run in a \ref PoolQuery worker thread. */
+      std::shared_ptr<const Snapshot> build( unsigned serial_r ) const
+      {
+        sat::detail::CPool * pool( myPool().getPool() );
+
+        std::vector<sat::detail::IdType> evrs;
+        for ( int i = 2; i < pool->nsolvables; ++i )	// skip noSolvable and systemSolvable
+        {
+          const sat::detail::CSolvable & solv( pool->solvables[i] );
+          if ( solv.repo && solv.evr )
+            evrs.push_back( solv.evr );
+        }
+        std::sort( evrs.begin(), evrs.end() );
+        evrs.erase( std::unique( evrs.begin(), evrs.end() ), evrs.end() );
+
+        std::shared_ptr<Snapshot> ret( new Snapshot );
+        ret->serial = serial_r;
+        ret->rank.assign( evrs.empty() ? 0 : evrs.back()+1, 0 );
+        std::sort( evrs.begin(), evrs.end(), [pool]( sat::detail::IdType lhs, sat::detail::IdType rhs ) {
+          return ::pool_evrcmp( pool, lhs, rhs, EVRCMP_COMPARE ) < 0;
+        } );
+
+        unsigned rank = 0;	// 0 is 'not ranked'
+        for ( unsigned i = 0; i < evrs.size(); ++i )
+        {
+          if ( i == 0 || ::pool_evrcmp( pool, evrs[i-1], evrs[i], EVRCMP_COMPARE ) != 0 )
+            ++rank;
+          ret->rank[evrs[i]] = rank;
+        }
+        return ret;
+      }
+
+    private:
+      std::mutex _mutex;
+      std::shared_ptr<const Snapshot> _latest;	// guarded by _mutex
+    };
+
+    EvrRankIndex & evrRankIndex()
+    {
+      static EvrRankIndex _index;
+      return _index;
+    }
+
     /////////////////////////////////////////////////////////////////
   } // namespace
   ///////////////////////////////////////////////////////////////////
@@ -124,6 +227,14 @@ namespace zypp
     return( lhs ? 1 : -1 );
   }
 
+  int Edition::_doCompareIds( const IdString & lhs, const IdString & rhs )
+  {
+    int ret = 0;
+    if ( lhs && rhs && evrRankIndex().compare( lhs.id(), rhs.id(), ret ) )
+      return ret;
+    return _doCompare( ( lhs ? lhs.c_str() : (const char *)0 ), ( rhs ? rhs.c_str() : (const char *)0 ) );
+  }
+
   int Edition::_doMatch( const char * lhs,  const char * rhs )
   {
     if ( lhs == rhs ) return 0;
@@ -171,6 +171,8 @@ namespace zypp
     private:
       static int _doCompare( const char * lhs,  const char * rhs );
       static int _doMatch( const char * lhs,  const char * rhs );
+      /** Editions used by the pools solvables are compared by their precomputed rank. */
+      static int _doCompareIds( const IdString & lhs, const IdString & rhs );
 
     private:
       friend class IdStringType<Edition>;
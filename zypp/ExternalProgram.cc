@@ -18,7 +18,9 @@
 #include <fcntl.h>
 #include <pty.h> // openpty
 #include <stdlib.h> // setenv
+#include <sys/syscall.h> // close_range, getdents64
 
+#include <cstdint>
 #include <cstring> // strsignal
 #include <iostream>
 #include <sstream>
@@ -32,6 +34,65 @@ using namespace std;
 
 namespace zypp {
 
+    namespace externalprogram
+    {
+      /** Close all filedescriptors above stderr in a just forked child.
+       * Looping up to \c getdtablesize is expensive if the limit is high
+       * (containers tend to set it to 1M), so use \c close_range if the
+       * kernel supports it, otherwise just close the descriptors listed in
+       * \c /proc/self/fd. Only async-signal-safe calls are used, so no
+       * \c opendir; the directory is read via the raw \c getdents64 syscall.
+       */
+      void closeFdsAboveStderr()
+      {
+#ifdef SYS_close_range
+        if ( ::syscall( SYS_close_range, 3U, ~0U, 0U ) == 0 )
+          return;
+#endif
+#ifdef SYS_getdents64
+        int dirfd = ::open( "/proc/self/fd", O_RDONLY|O_DIRECTORY|O_CLOEXEC );
+        if ( dirfd >= 0 )
+        {
+          struct Dirent64 {
+            uint64_t       d_ino;
+            int64_t        d_off;
+            unsigned short d_reclen;
+            unsigned char  d_type;
+            char           d_name[];
+          };
+          // Closing a descriptor does not disturb the directory offset, as
+          // /proc/self/fd is traversed in descriptor order.
+          char buf[4096] __attribute__ ((aligned (8)));
+          long nread = 0;
+          while ( ( nread = ::syscall( SYS_getdents64, dirfd, buf, sizeof(buf) ) ) > 0 )
+          {
+            for ( long pos = 0; pos < nread; )
+            {
+              const Dirent64 * ent = reinterpret_cast<const Dirent64 *>( buf + pos );
+              pos += ent->d_reclen;
+
+              int fd = 0;
+              const char * p = ent->d_name;
+              for ( ; *p >= '0' && *p <= '9'; ++p )
+                fd = fd * 10 + ( *p - '0' );
+              if ( *p || p == ent->d_name )
+                continue; // '.' and '..'
+              if ( fd > 2 && fd != dirfd )
+                ::close( fd );
+            }
+          }
+          ::close( dirfd );
+          if ( nread == 0 )
+            return;
+        }
+#endif
+        // fallback: no /proc (e.g. a minimal chroot)
+        for ( int i = ::getdtablesize() - 1; i > 2; --i ) {
+          ::close( i );
+        }
+      }
+    } // namespace externalprogram
+
     ExternalProgram::ExternalProgram()
       : use_pty (false)
       , pid( -1 )
@@ -260,11 +321,20 @@ namespace zypp {
           ERR << _execError << endl;
           return;
     	}
+    	// the child closes the master itself; just keep it from leaking
+    	// into other programs
+    	::fcntl( master_tty, F_SETFD, FD_CLOEXEC );
       }
       else
       {
-    	// Create pair of pipes
+    	// Create pair of pipes; close-on-exec, so they do not leak into
+    	// programs started concurrently by other threads. The child's
+    	// ends get renumbered to stdin/stdout which clears the flag.
+#ifdef HAVE_PIPE2
+    	if (pipe2 (to_external, O_CLOEXEC) != 0 || pipe2 (from_external, O_CLOEXEC) != 0)
+#else
     	if (pipe (to_external) != 0 || pipe (from_external) != 0)
+#endif
     	{
           _execError = str::form( _("Can't open pipe (%s)."), strerror(errno) );
           _exitStatus = 126;
@@ -343,6 +413,10 @@ namespace zypp {
     	if(default_locale)
     		setenv("LC_ALL","C",1);
 
+    	// close all filedesctiptors above stderr (before chroot, as
+    	// /proc is usually not available inside)
+    	externalprogram::closeFdsAboveStderr();
+
     	if(root)
     	{
     	    if(chroot(root) == -1)
@@ -363,11 +437,6 @@ namespace zypp {
 	  _exit (128);			// No sense in returning! I am forked away!!
 	}
 
-    	// close all filedesctiptors above stderr
-    	for ( int i = ::getdtablesize() - 1; i > 2; --i ) {
-    	  ::close( i );
-    	}
-
     	execvp(argv[0], const_cast<char *const *>(argv));
         // don't want to get here
         _execError = str::form( _("Can't exec '%s' (%s)."), argv[0], strerror(errno) );
@@ -582,6 +651,13 @@ namespace zypp {
     	dup2 (origfd, newfd);
     	::close (origfd);
       }
+      else
+      {
+    	// dup2 would have cleared it; keep the fd open across exec
+    	int flags = ::fcntl( newfd, F_GETFD );
+    	if ( flags != -1 && ( flags & FD_CLOEXEC ) )
+    	  ::fcntl( newfd, F_SETFD, flags & ~FD_CLOEXEC );
+      }
     }
 
     std::ostream & ExternalProgram::operator>>( std::ostream & out_r )
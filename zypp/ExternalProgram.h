@@ -235,6 +235,12 @@ namespace zypp {
 
   namespace externalprogram
   {
+    /** Close all filedescriptors above stderr.
+     * To be called in a just forked child; uses async-signal-safe
+     * calls only.
+     */
+    void closeFdsAboveStderr();
+
     /** Helper providing pipe FDs for \ref ExternalProgramWithStderr.
      * Moved to a basse class because the pipe needs to be initialized
      * before the \ref ExternalProgram base class is initialized.
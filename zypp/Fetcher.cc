@@ -191,6 +191,12 @@ namespace zypp
        * file should be available on dest_dir
        */
       bool provideFromCache( const OnMediaLocation &resource, const Pathname &dest_dir );
+      /**
+       * Hand all enqueued files which will likely be downloaded to
+       * \ref MediaSetAccess::prefetchFiles, so downloading media may
+       * retrieve them at once (multiplexed) rather than one by one.
+       */
+      void prefetch( MediaSetAccess &media, const Pathname &dest_dir );
       /**
        * Validates the job against is checkers, by using the file instance
        * on dest_dir
@@ -382,6 +388,35 @@ namespace zypp
     return false;
   }
 
+  void Fetcher::Impl::prefetch( MediaSetAccess &media, const Pathname &dest_dir )
+  {
+    std::list<OnMediaLocation> files;
+    for_( it_res, _resources.begin(), _resources.end() )
+    {
+      const FetcherJob & job( **it_res );
+      // Directories are expanded later; deltas are built by the media itself.
+      if ( ( job.flags & FetcherJob::Directory ) || ! job.deltafile.empty() )
+        continue;
+
+      // Candidates for provideFromCache are left alone (checksum tested later).
+      if ( ! job.location.checksum().empty() )
+      {
+        bool maybeCached = PathInfo( dest_dir + job.location.filename() ).isExist();
+        for ( auto it_cache = _caches.begin(); ! maybeCached && it_cache != _caches.end(); ++it_cache )
+          maybeCached = PathInfo( *it_cache + job.location.filename() ).isExist();
+        if ( maybeCached )
+          continue;
+      }
+      files.push_back( job.location );
+    }
+
+    if ( files.size() > 1 )
+    {
+      DBG << "prefetch " << files.size() << " of " << _resources.size() << " files" << endl;
+      media.prefetchFiles( files );
+    }
+  }
+
     void Fetcher::Impl::validate( const OnMediaLocation &resource, const Pathname &dest_dir, const list<FileChecker> &checkers )
   {
     // no matter where did we got the file, try to validate it:
@@ -549,7 +584,16 @@ namespace zypp
       // try to get the file from the net
       try
       {
-        Pathname tmp_file = media.provideFile(resource, resource.optional() ? MediaSetAccess::PROVIDE_NON_INTERACTIVE : MediaSetAccess::PROVIDE_DEFAULT, deltafile );
+        // Let the media know the checksum type to compute while downloading,
+        // even if the checksum is taken from an index.
+        OnMediaLocation fetchres( resource );
+        if ( fetchres.checksum().empty() )
+        {
+          map<string, CheckSum>::const_iterator it_chk( _checksums.find( resource.filename().asString() ) );
+          if ( it_chk != _checksums.end() )
+            fetchres.setChecksum( it_chk->second );
+        }
+        Pathname tmp_file = media.provideFile(fetchres, resource.optional() ? MediaSetAccess::PROVIDE_NON_INTERACTIVE : MediaSetAccess::PROVIDE_DEFAULT, deltafile );
 
         Pathname dest_full_path = dest_dir + resource.filename();
 
@@ -754,6 +798,7 @@ namespace zypp
     progress.sendTo(progress_receiver);
 
     downloadAndReadIndexList(media, dest_dir);
+    prefetch(media, dest_dir);
 
     for ( list<FetcherJob_Ptr>::const_iterator it_res = _resources.begin(); it_res != _resources.end(); ++it_res )
     {
@@ -15,6 +15,7 @@
 #include "zypp/ZYppFactory.h"
 #include "zypp/Digest.h"
 #include "zypp/KeyRing.h"
+#include "zypp/media/StreamedChecksums.h"
 
 using namespace std;
 
@@ -49,7 +50,11 @@ namespace zypp
     }
     else
     {
-      CheckSum real_checksum( _checksum.type(), filesystem::checksum( file, _checksum.type() ));
+      CheckSum real_checksum( media::StreamedChecksums::lookup( file, _checksum.type() ) );
+      if ( real_checksum.empty() )
+        real_checksum = CheckSum( _checksum.type(), filesystem::checksum( file, _checksum.type() ) );
+      else
+        DBG << "Using checksum computed on download for " << file << endl;
       if ( (real_checksum != _checksum) )
       {
 	// Remember askUserToAcceptWrongDigest decision for at most 12hrs in memory;
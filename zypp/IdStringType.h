@@ -79,6 +79,9 @@ namespace zypp
    *    DBG << "na == a ? " << (na == "a") << endl;   // na == a ? 1
    *    DBG << "na == A ? " << (na == "A") << endl;   // na == A ? 1
    * \endcode
+   * Comparing two \ref IdString based values (e.g. two \c Derived) calls
+   * \c _doCompareIds, which by default forwards to \ref _doCompare. Redefine
+   * it if the ids allow a faster comparison (\see \ref Edition).
    * \todo allow redefinition of order vis _doCompare not only for char* but on any level
    * \ingroup g_CRTP
    */
@@ -130,8 +133,7 @@ namespace zypp
       static int compare( const Derived & lhs,     const char * rhs )        { return compare( lhs.idStr(), rhs );}
 
       static int compare( const IdString & lhs,    const Derived & rhs )     { return compare( lhs, rhs.idStr() ); }
-      static int compare( const IdString & lhs,    const IdString & rhs )    { return lhs == rhs ? 0 : Derived::_doCompare( (lhs ? lhs.c_str() : (const char *)0 ),
-															    (rhs ? rhs.c_str() : (const char *)0 ) ); }
+      static int compare( const IdString & lhs,    const IdString & rhs )    { return lhs == rhs ? 0 : Derived::_doCompareIds( lhs, rhs ); }
       static int compare( const IdString & lhs,    const std::string & rhs ) { return compare( lhs, rhs.c_str() ); }
       static int compare( const IdString & lhs,    const char * rhs )        { return Derived::_doCompare( (lhs ? lhs.c_str() : (const char *)0 ), rhs ); }
 
@@ -158,6 +160,10 @@ namespace zypp
 	if ( ! lhs ) return rhs ? -1 : 0;
 	return rhs ? ::strcmp( lhs, rhs ) : 1;
       }
+
+      /** Compare two distinct IdStrings; Derived may redefine it to take advantage of the ids. */
+      static int _doCompareIds( const IdString & lhs, const IdString & rhs )
+      { return Derived::_doCompare( (lhs ? lhs.c_str() : (const char *)0 ), (rhs ? rhs.c_str() : (const char *)0 ) ); }
   };
   ///////////////////////////////////////////////////////////////////
 
@@ -13,8 +13,17 @@
 #include <fstream>
 #include <sys/file.h>
 #include <cstdio>
+#include <iterator>
 #include <unistd.h>
 
+#ifdef HAVE_RPMPGP
+extern "C"
+{
+#include <rpm/rpmpgp.h>
+#include <rpm/rpmcrypto.h>
+}
+#endif // HAVE_RPMPGP
+
 #include "zypp/TmpPath.h"
 #include "zypp/ZYppFactory.h"
 #include "zypp/ZYpp.h"
@@ -25,6 +34,7 @@
 #include "zypp/base/Regex.h"
 #include "zypp/base/Gettext.h"
 #include "zypp/base/WatchFile.h"
+#include "zypp/TriBool.h"
 #include "zypp/PathInfo.h"
 #include "zypp/KeyRing.h"
 #include "zypp/ExternalProgram.h"
@@ -80,6 +90,73 @@ namespace zypp
   bool KeyRingReport::askUserToAcceptVerificationFailed( const std::string & file, const PublicKey & key, const KeyContext & keycontext )
   { return _keyRingDefaultAccept.testFlag( KeyRing::ACCEPT_VERIFICATION_FAILED ); }
 
+#ifdef HAVE_RPMPGP
+  namespace
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \brief rpm's parsed OpenPGP key or signature parameters.
+    ///////////////////////////////////////////////////////////////////
+    typedef shared_ptr<pgpDigParams_s> PgpParams;
+
+    inline PgpParams makePgpParams( pgpDigParams params_r )
+    { return PgpParams( params_r, ::pgpDigParamsFree ); }
+
+    /** Key id of a key or the issuer of a signature (16 hex digits, upper case). */
+    std::string pgpKeyId( const PgpParams & params_r )
+    {
+      std::string ret;
+      const uint8_t * id = ::pgpDigParamsSignID( params_r.get() );
+      for ( unsigned i = 0; i < 8; ++i )
+	ret += str::form( "%02X", id[i] );
+      return ret;
+    }
+
+    /** Parse the ASCII armored or binary OpenPGP \a tag_r packets in \a file_r.
+     * For a public key, the parsed subkeys are appended to \a subkeys_r.
+     * Returns an empty \ref PgpParams if rpm can not parse the file.
+     */
+    PgpParams parsePgpFile( const Pathname & file_r, unsigned tag_r, std::list<PgpParams> * subkeys_r = nullptr )
+    {
+      std::string data;
+      {
+	std::ifstream in( file_r.c_str(), std::ios::binary );
+	data.assign( std::istreambuf_iterator<char>( in ), std::istreambuf_iterator<char>() );
+      }
+      if ( data.empty() )
+	return PgpParams();
+
+      uint8_t * armored = nullptr;	// decoded armor, to be freed
+      const uint8_t * pkts = reinterpret_cast<const uint8_t *>( data.data() );
+      size_t pktlen = data.size();
+      if ( data.find( "-----BEGIN PGP " ) != std::string::npos )
+      {
+	if ( ::pgpParsePkts( data.c_str(), &armored, &pktlen ) <= 0 )
+	  return PgpParams();
+	pkts = armored;
+      }
+
+      PgpParams ret;
+      pgpDigParams params = nullptr;
+      if ( ::pgpPrtParams( pkts, pktlen, tag_r, &params ) == 0 )
+      {
+	ret = makePgpParams( params );
+	pgpDigParams * subkeys = nullptr;
+	int count = 0;
+	if ( subkeys_r && ::pgpPrtParamsSubkeys( pkts, pktlen, params, &subkeys, &count ) == 0 )
+	{
+	  for ( int i = 0; i < count; ++i )
+	    subkeys_r->push_back( makePgpParams( subkeys[i] ) );
+	  ::free( subkeys );
+	}
+      }
+      else if ( params )
+	::pgpDigParamsFree( params );
+      ::free( armored );
+      return ret;
+    }
+  } // namespace
+#endif // HAVE_RPMPGP
+
   namespace
   {
     ///////////////////////////////////////////////////////////////////
@@ -94,6 +171,44 @@ namespace zypp
       const std::list<PublicKeyData> & operator()( const Pathname & keyring_r ) const
       { return getData( keyring_r ); }
 
+      /** The \ref PublicKey exported for \a keyData_r (empty if not yet remembered).
+       * Exported keys are dropped together with the data as soon as the keyring changes.
+       */
+      PublicKey exportedKey( const Pathname & keyring_r, const PublicKeyData & keyData_r ) const
+      {
+	Cache & cache( assertData( keyring_r ) );
+	auto it( cache._exported.find( keyData_r.fingerprint() ) );
+	if ( it != cache._exported.end() && it->second.keyData() == keyData_r )
+	  return it->second;
+	return PublicKey();
+      }
+
+      /** Remember a \ref PublicKey exported from \a keyring_r. */
+      void rememberExportedKey( const Pathname & keyring_r, const PublicKey & key_r ) const
+      {
+	Cache & cache( assertData( keyring_r ) );
+	cache._exported[key_r.fingerprint()] = key_r;
+      }
+
+#ifdef HAVE_RPMPGP
+      /** rpm's parsed key (or subkey) \a id_r (empty if not yet remembered).
+       * Parsed keys are dropped together with the data as soon as the keyring changes.
+       */
+      PgpParams pgpKey( const Pathname & keyring_r, const std::string & id_r ) const
+      {
+	Cache & cache( assertData( keyring_r ) );
+	auto it( cache._pgpKeys.find( id_r ) );
+	return it != cache._pgpKeys.end() ? it->second : PgpParams();
+      }
+
+      /** Remember a key (or subkey) parsed from \a keyring_r. */
+      void rememberPgpKey( const Pathname & keyring_r, const PgpParams & key_r ) const
+      {
+	Cache & cache( assertData( keyring_r ) );
+	cache._pgpKeys[pgpKeyId( key_r )] = key_r;
+      }
+#endif // HAVE_RPMPGP
+
     private:
       struct Cache
       {
@@ -119,6 +234,10 @@ namespace zypp
 	}
 
 	std::list<PublicKeyData> _data;
+	std::map<std::string,PublicKey> _exported;	// by fingerprint
+#ifdef HAVE_RPMPGP
+	std::map<std::string,PgpParams> _pgpKeys;	// by key id, subkeys included
+#endif // HAVE_RPMPGP
 
       private:
 	scoped_ptr<WatchFile> _keyringK;
@@ -128,11 +247,15 @@ namespace zypp
       typedef std::map<Pathname,Cache> CacheMap;
 
       const std::list<PublicKeyData> & getData( const Pathname & keyring_r ) const
+      { return assertData( keyring_r )._data; }
+
+      Cache & assertData( const Pathname & keyring_r ) const
       {
 	Cache & cache( _cacheMap[keyring_r] );
 	// init new cache entry
 	cache.assertCache( keyring_r );
-	return getData( keyring_r, cache );
+	getData( keyring_r, cache );
+	return cache;
       }
 
       const std::list<PublicKeyData> & getData( const Pathname & keyring_r, Cache & cache_r ) const
@@ -166,6 +289,10 @@ namespace zypp
 	  prog.close();
 
 	  cache_r._data.swap( scanner._keys );
+	  cache_r._exported.clear();
+#ifdef HAVE_RPMPGP
+	  cache_r._pgpKeys.clear();
+#endif // HAVE_RPMPGP
 	  MIL << "Found keys: " << cache_r._data  << endl;
 	}
 	return cache_r._data;
@@ -229,6 +356,12 @@ namespace zypp
 
   private:
     bool verifyFile( const Pathname & file, const Pathname & signature, const Pathname & keyring );
+#ifdef HAVE_RPMPGP
+    /** Verify in process; \c indeterminate if rpm can not tell. */
+    TriBool pgpVerifyFile( const Pathname & file, const Pathname & signature, const Pathname & keyring );
+    /** rpm's parsed primary key \a id or one of its subkeys (cached). */
+    PgpParams pgpKey( const std::string & id, const Pathname & keyring );
+#endif // HAVE_RPMPGP
     void importKey( const Pathname & keyfile, const Pathname & keyring );
 
     PublicKey exportKey( const std::string & id, const Pathname & keyring );
@@ -323,14 +456,21 @@ namespace zypp
 
   PublicKey KeyRing::Impl::exportKey( const PublicKeyData & keyData, const Pathname & keyring )
   {
-    return PublicKey( dumpPublicKeyToTmp( keyData.id(), keyring ), keyData );
+    // Exporting a key costs a gpg run; reuse the previous export until the keyring changes.
+    PublicKey ret( cachedPublicKeyData.exportedKey( keyring, keyData ) );
+    if ( ret.isValid() )
+      return ret;
+
+    ret = PublicKey( dumpPublicKeyToTmp( keyData.id(), keyring ), keyData );
+    cachedPublicKeyData.rememberExportedKey( keyring, ret );
+    return ret;
   }
 
   PublicKey KeyRing::Impl::exportKey( const std::string & id, const Pathname & keyring )
   {
     PublicKeyData keyData( publicKeyExists( id, keyring ) );
     if ( keyData )
-      return PublicKey( dumpPublicKeyToTmp( keyData.id(), keyring ), keyData );
+      return exportKey( keyData, keyring );
 
     // Here: key not found
     WAR << "No key " << id << " to export from " << keyring << endl;
@@ -575,6 +715,18 @@ namespace zypp
       ZYPP_THROW(Exception( str::Format(_("Signature file %s not found")) % signature.asString() ));
 
     MIL << "Determining key id if signature " << signature << endl;
+#ifdef HAVE_RPMPGP
+    {
+      PgpParams sig( parsePgpFile( signature, PGPTAG_SIGNATURE ) );
+      if ( sig )
+      {
+	std::string id( pgpKeyId( sig ) );
+	MIL << "Determined key id [" << id << "] for signature " << signature << endl;
+	return id;
+      }
+    }
+    // rpm can't parse it: let gpg tell.
+#endif // HAVE_RPMPGP
     // HACK create a tmp keyring with no keys
     filesystem::TmpDir dir( _base_dir, "fake-keyring" );
     std::string tmppath( dir.path().asString() );
@@ -625,8 +777,75 @@ namespace zypp
     return id;
   }
 
+#ifdef HAVE_RPMPGP
+  PgpParams KeyRing::Impl::pgpKey( const std::string & id, const Pathname & keyring )
+  {
+    PgpParams ret( cachedPublicKeyData.pgpKey( keyring, id ) );
+    if ( ret )
+      return ret;
+
+    PublicKeyData keyData( publicKeyExists( id, keyring ) );
+    if ( ! keyData )
+      return ret;	// unknown or a subkey of a key not yet parsed
+
+    std::list<PgpParams> subkeys;
+    ret = parsePgpFile( exportKey( keyData, keyring ).path(), PGPTAG_PUBLIC_KEY, &subkeys );
+    if ( ! ret )
+    {
+      WAR << "rpm can not parse key " << keyData << endl;
+      return ret;
+    }
+    cachedPublicKeyData.rememberPgpKey( keyring, ret );
+    for ( const PgpParams & subkey : subkeys )
+      cachedPublicKeyData.rememberPgpKey( keyring, subkey );
+    return ret;
+  }
+
+  TriBool KeyRing::Impl::pgpVerifyFile( const Pathname & file, const Pathname & signature, const Pathname & keyring )
+  {
+    PgpParams sig( parsePgpFile( signature, PGPTAG_SIGNATURE ) );
+    if ( ! sig )
+      return indeterminate;
+    PgpParams key( pgpKey( pgpKeyId( sig ), keyring ) );
+    if ( ! key )
+      return indeterminate;
+
+    std::ifstream in( file.c_str(), std::ios::binary );
+    if ( ! in )
+      return false;
+    ::rpmInitCrypto();
+    DIGEST_CTX ctx = ::rpmDigestInit( ::pgpDigParamsAlgo( sig.get(), PGPVAL_HASHALGO ), RPMDIGEST_NONE );
+    if ( ! ctx )
+      return indeterminate;
+    char buf[16384];
+    while ( in.read( buf, sizeof(buf) ) || in.gcount() )
+      ::rpmDigestUpdate( ctx, buf, in.gcount() );
+    rpmRC res = ::pgpVerifySignature( key.get(), sig.get(), ctx );
+    // RPMRC_FAIL is also returned if rpm's crypto backend or policy rejects the
+    // hash or key algorithm (e.g. SHA1 with rpm-sequoia). Without a key just the
+    // digest is checked: only a mismatch there proves the signature bad.
+    rpmRC digest = ( res == RPMRC_FAIL ? ::pgpVerifySignature( nullptr, sig.get(), ctx ) : res );
+    ::rpmDigestFinal( ctx, nullptr, nullptr, 0 );
+
+    DBG << "rpm verifies " << signature << " with key " << pgpKeyId( sig ) << ": " << res << "/" << digest << endl;
+    if ( res == RPMRC_OK )
+      return true;
+    if ( digest == RPMRC_FAIL )
+      return false;
+    return indeterminate;	// let gpg decide
+  }
+#endif // HAVE_RPMPGP
+
   bool KeyRing::Impl::verifyFile( const Pathname & file, const Pathname & signature, const Pathname & keyring )
   {
+#ifdef HAVE_RPMPGP
+    {
+      // Done in process unless rpm can't tell (e.g. a signature made by a subkey not yet parsed).
+      TriBool res( pgpVerifyFile( file, signature, keyring ) );
+      if ( ! indeterminate( res ) )
+	return bool(res);
+    }
+#endif // HAVE_RPMPGP
     const char* argv[] =
     {
       GPG_BINARY,
@@ -170,6 +170,33 @@ IMPL_PTR_TYPE(MediaSetAccess);
     return op.result;
   }
 
+  void MediaSetAccess::prefetchFiles( const std::list<OnMediaLocation> & resources )
+  {
+    std::map<unsigned, std::list<Pathname> > files;	// by media nr
+    for ( const OnMediaLocation & resource : resources )
+      files[resource.medianr()].push_back( resource.filename() );
+
+    media::MediaManager media_mgr;
+    for ( const auto & el : files )
+    {
+      try
+      {
+	media::MediaAccessId media = getMediaAccessId( el.first );
+	if ( ! media_mgr.downloads( media ) )
+	  continue;	// nothing to gain
+	if ( ! media_mgr.isAttached( media ) )
+	  media_mgr.attach( media );
+	media_mgr.prefetchFiles( media, el.second );
+      }
+      catch ( const Exception & excpt_r )
+      {
+	// Prefetch errors are never propagated.
+	ZYPP_CAUGHT( excpt_r );
+	WAR << "Failed to prefetch " << el.second.size() << " files from media number " << el.first << endl;
+      }
+    }
+  }
+
   Pathname MediaSetAccess::provideOptionalFile( const Pathname & file, unsigned media_nr )
   {
     try
@@ -220,16 +247,21 @@ IMPL_PTR_TYPE(MediaSetAccess);
         if ( ! media_mgr.isAttached(media) )
           media_mgr.attach(media);
 	media_mgr.setDeltafile(media, deltafile);
+	media_mgr.setDownloadDigest(media, resource.checksum().type());
 	deltafileset = true;
         op(media, file);
 	media_mgr.setDeltafile(media, Pathname());
+	media_mgr.setDownloadDigest(media, std::string());
         break;
       }
       catch ( media::MediaException & excp )
       {
         ZYPP_CAUGHT(excp);
 	if (deltafileset)
+	{
 	  media_mgr.setDeltafile(media, Pathname());
+	  media_mgr.setDownloadDigest(media, std::string());
+	}
         media::MediaChangeReport::Action user = media::MediaChangeReport::ABORT;
         unsigned int devindex = 0;
         vector<string> devices;
@@ -171,6 +171,16 @@ namespace zypp
        */
       Pathname provideFile(const Pathname & file, unsigned media_nr = 1, ProvideFileOptions options = PROVIDE_DEFAULT );
 
+      /**
+       * Hint that the \a resources will be requested via \ref provideFile soon.
+       *
+       * Downloading media may retrieve them in advance (concurrently),
+       * so the following \ref provideFile calls are served locally.
+       * This never attaches or changes media interactively and never throws.
+       * Files which could not be prefetched are provided as usual.
+       */
+      void prefetchFiles( const std::list<OnMediaLocation> & resources );
+
       /**
        * Provides an optional \a file from media \a media_nr.
        *
@@ -13,6 +13,9 @@
 #include <sys/types.h> // for ::minor, ::major macros
 #include <utime.h>     // for ::utime
 #include <sys/statvfs.h>
+#include <sys/sendfile.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>  // for FICLONE
 
 #include <iostream>
 #include <fstream>
@@ -25,7 +28,6 @@
 #include "zypp/base/Errno.h"
 
 #include "zypp/AutoDispose.h"
-#include "zypp/ExternalProgram.h"
 #include "zypp/PathInfo.h"
 #include "zypp/Digest.h"
 #include "zypp/TmpPath.h"
@@ -447,6 +449,208 @@ namespace zypp
       return logResult( recursive_rmdir_1( path, false/* don't remove path itself */ ) );
     }
 
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      typedef AutoDispose<int> AutoFd;
+      inline AutoFd autoFd( int fd_r )
+      { return AutoFd( fd_r, []( int fd ) { if ( fd != -1 ) ::close( fd ); } ); }
+
+      /** Copy the data of regular file \a from_r to the empty file \a to_r.
+       * Try a reflink first, then let the kernel copy (copy_file_range, sendfile)
+       * and finally read/write whatever is left (e.g. files in /proc report size 0).
+       * \return 0 on success, errno on failure.
+       */
+      int copyFileData( int from_r, int to_r, off_t size_r )
+      {
+        if ( size_r > 0 )
+        {
+#ifdef FICLONE
+          // btrfs, xfs,...: share the extents
+          if ( ::ioctl( to_r, FICLONE, from_r ) == 0 )
+            return 0;
+#endif
+#ifdef __GLIBC_PREREQ
+#if __GLIBC_PREREQ(2,27)
+          // in-kernel copy, may be offloaded to the filesystem (nfs, cifs)
+          for ( ssize_t res = 1; res > 0; )
+          {
+            res = ::copy_file_range( from_r, nullptr, to_r, nullptr, 1024*1024*1024, 0 );
+            if ( res == -1 && errno != EINTR )
+              break;	// EXDEV, ENOSYS, EINVAL,...: go on with sendfile
+          }
+#endif
+#endif
+          // in-kernel copy, no double buffering in userspace
+          for ( ssize_t res = 1; res > 0; )
+          {
+            res = ::sendfile( to_r, from_r, nullptr, 1024*1024*1024 );
+            if ( res == -1 && errno != EINTR )
+              break;	// EINVAL, ENOSYS: go on with read/write
+          }
+        }
+
+        char buf[64*1024];
+        while ( true )
+        {
+          ssize_t got = ::read( from_r, buf, sizeof(buf) );
+          if ( got == 0 )
+            return 0;
+          if ( got == -1 )
+          {
+            if ( errno == EINTR )
+              continue;
+            return errno;
+          }
+          for ( char * p = buf; got > 0; )
+          {
+            ssize_t put = ::write( to_r, p, got );
+            if ( put == -1 )
+            {
+              if ( errno == EINTR )
+                continue;
+              return errno;
+            }
+            p += put;
+            got -= put;
+          }
+        }
+      }
+
+      /** Copy regular file \a file_r to \a dest_r like 'cp [--remove-destination]'.
+       * A new file gets the source files permissions (less umask), an existing one
+       * is overwritten unless \a removeDestination_r.
+       * \return 0 on success, errno on failure.
+       */
+      int copyRegularFile( const Pathname & file_r, const Pathname & dest_r, bool removeDestination_r )
+      {
+        AutoFd from( autoFd( ::open( file_r.c_str(), O_RDONLY|O_CLOEXEC ) ) );
+        if ( from == -1 )
+          return errno;
+        struct stat st;
+        if ( ::fstat( from, &st ) == -1 )
+          return errno;
+
+        struct stat dst;
+        if ( ::stat( dest_r.c_str(), &dst ) == 0 && dst.st_dev == st.st_dev && dst.st_ino == st.st_ino )
+          return EINVAL;	// same file
+
+        if ( removeDestination_r && ::unlink( dest_r.c_str() ) == -1 && errno != ENOENT )
+          return errno;
+
+        AutoFd to( autoFd( ::open( dest_r.c_str(), O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, st.st_mode & 0777 ) ) );
+        if ( to == -1 )
+          return errno;
+
+        int ret = copyFileData( from, to, st.st_size );
+        to.resetDispose();
+        if ( ::close( to ) == -1 && ! ret )
+          ret = errno;
+        return ret;
+      }
+
+      /** Recursively copy like 'cp -dR': symlinks are copied as symlinks,
+       * hardlinks within the copied tree are preserved.
+       */
+      struct TreeCopy
+      {
+        /** Copy \a from_r to (a not yet existing or directory) \a to_r.
+         * \return 0 on success, else the first errno encountered
+         * (like cp we go on with the remaining entries).
+         */
+        int operator()( const Pathname & from_r, const Pathname & to_r )
+        {
+          struct stat st;
+          if ( ::lstat( from_r.c_str(), &st ) == -1 )
+            return errno;
+
+          if ( S_ISDIR( st.st_mode ) )
+          {
+            if ( _createdDirs.count( std::make_pair( st.st_dev, st.st_ino ) ) )
+              return 0;	// don't copy a directory into itself
+            // We need to write into a new directory even if the source is
+            // read-only; its owner permissions are applied once it's filled.
+            bool created = true;
+            if ( ::mkdir( to_r.c_str(), ( st.st_mode | S_IRWXU ) & 01777 ) == -1 )
+            {
+              if ( errno != EEXIST || ! PathInfo( to_r ).isDir() )
+                return errno;
+              created = false;
+            }
+            struct stat dst;
+            if ( ::stat( to_r.c_str(), &dst ) == 0 )
+              _createdDirs.insert( std::make_pair( dst.st_dev, dst.st_ino ) );
+            else
+              created = false;
+
+            AutoDispose<DIR *> dir( ::opendir( from_r.c_str() ),
+                                    []( DIR * dir_r ) { if ( dir_r ) ::closedir( dir_r ); } );
+            if ( ! dir )
+              return errno;
+
+            int ret = 0;
+            for ( struct dirent * entry = ::readdir( dir ); entry; entry = ::readdir( dir ) )
+            {
+              if ( entry->d_name[0] == '.' && ( entry->d_name[1] == '\0' || ( entry->d_name[1] == '.' && entry->d_name[2] == '\0' ) ) )
+                continue; // omitt . and ..
+              int res = (*this)( from_r / entry->d_name, to_r / entry->d_name );
+              if ( res && ! ret )
+                ret = res;
+            }
+            if ( created && ( st.st_mode & S_IRWXU ) != S_IRWXU
+                 && ::chmod( to_r.c_str(), ( dst.st_mode & 01777 & ~S_IRWXU ) | ( st.st_mode & S_IRWXU ) ) == -1 && ! ret )
+              ret = errno;
+            return ret;
+          }
+
+          // an existing non-directory target is replaced
+          if ( ::unlink( to_r.c_str() ) == -1 && errno != ENOENT )
+            return errno;
+
+          std::pair<dev_t,ino_t> key( st.st_dev, st.st_ino );
+          if ( st.st_nlink > 1 )
+          {
+            std::map<std::pair<dev_t,ino_t>,Pathname>::const_iterator it( _copied.find( key ) );
+            if ( it != _copied.end() )
+              return ::link( it->second.c_str(), to_r.c_str() ) == -1 ? errno : 0;
+          }
+
+          int ret = copyNonDirectory( from_r, to_r, st );
+          // Only a successful copy may serve as link target for further links.
+          if ( ! ret && st.st_nlink > 1 )
+            _copied[key] = to_r;
+          return ret;
+        }
+
+      private:
+        /** Copy the symlink, file, fifo, device,...  from_r to  to_r. */
+        int copyNonDirectory( const Pathname & from_r, const Pathname & to_r, const struct stat & st )
+        {
+          if ( S_ISLNK( st.st_mode ) )
+          {
+            Pathname target;
+            int res = readlink( from_r, target );
+            if ( res )
+              return res;
+            return ::symlink( target.c_str(), to_r.c_str() ) == -1 ? errno : 0;
+          }
+
+          if ( S_ISREG( st.st_mode ) )
+            return copyRegularFile( from_r, to_r, false );
+
+          // fifo, devices,...
+          return ::mknod( to_r.c_str(), st.st_mode & ( S_IFMT|0777 ), st.st_rdev ) == -1 ? errno : 0;
+        }
+
+      private:
+        /** Multiply linked source inodes and their first copy */
+        std::map<std::pair<dev_t,ino_t>,Pathname> _copied;
+        /** Target directories (to be skipped if they are below the source) */
+        std::set<std::pair<dev_t,ino_t> > _createdDirs;
+      };
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
     ///////////////////////////////////////////////////////////////////
     //
     //	METHOD NAME : copy_dir
@@ -471,21 +675,7 @@ namespace zypp
         return logResult( EEXIST );
       }
 
-
-      const char *const argv[] = {
-        "/bin/cp",
-        "-dR",
-        "--",
-        srcpath.asString().c_str(),
-        destpath.asString().c_str(),
-        NULL
-      };
-      ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
-      }
-      int ret = prog.close();
-      return logResult( ret, "returned" );
+      return logResult( TreeCopy()( srcpath, destpath + srcpath.basename() ) );
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -511,22 +701,7 @@ namespace zypp
         return logResult( EEXIST );
       }
 
-      std::string src( srcpath.asString());
-      src += "/.";
-      const char *const argv[] = {
-        "/bin/cp",
-        "-dR",
-        "--",
-        src.c_str(),
-        destpath.asString().c_str(),
-        NULL
-      };
-      ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
-      }
-      int ret = prog.close();
-      return logResult( ret, "returned" );
+      return logResult( TreeCopy()( srcpath, destpath ) );
     }
 
     ///////////////////////////////////////////////////////////////////////
@@ -756,20 +931,7 @@ namespace zypp
         return logResult( EISDIR );
       }
 
-      const char *const argv[] = {
-        "/bin/cp",
-        "--remove-destination",
-        "--",
-        file.asString().c_str(),
-        dest.asString().c_str(),
-        NULL
-      };
-      ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
-      }
-      int ret = prog.close();
-      return logResult( ret, "returned" );
+      return logResult( copyRegularFile( file, dest, /*removeDestination*/true ) );
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -924,19 +1086,7 @@ namespace zypp
         return logResult( ENOTDIR );
       }
 
-      const char *const argv[] = {
-        "/bin/cp",
-        "--",
-        file.asString().c_str(),
-        dest.asString().c_str(),
-        NULL
-      };
-      ExternalProgram prog( argv, ExternalProgram::Stderr_To_Stdout );
-      for ( string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-        MIL << "  " << output;
-      }
-      int ret = prog.close();
-      return logResult( ret, "returned" );
+      return logResult( copyRegularFile( file, dest + file.basename(), /*removeDestination*/false ) );
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -438,8 +438,11 @@ namespace zypp
      * Like 'cp -a srcpath destpath'. Copy directory tree. srcpath/destpath must be
      * directories. 'basename srcpath' must not exist in destpath.
      *
+     * Symlinks are copied as symlinks, hardlinks within the tree are preserved
+     * (like 'cp -dR'); file data are copied by the kernel (reflink if possible).
+     *
      * @return 0 on success, ENOTDIR if srcpath/destpath is not a directory, EEXIST if
-     * 'basename srcpath' exists in destpath, otherwise the commands return value.
+     * 'basename srcpath' exists in destpath, otherwise the first errno encountered.
      **/
     int copy_dir( const Pathname & srcpath, const Pathname & destpath );
 
@@ -448,8 +451,8 @@ namespace zypp
      * into destpath. Both \p srcpath and \p destpath has to exists.
      *
      * @return 0 on success, ENOTDIR if srcpath/destpath is not a directory,
-     * EEXIST if srcpath and destpath are equal, otherwise the commands
-     * return value.
+     * EEXIST if srcpath and destpath are equal, otherwise the first errno
+     * encountered.
      */
     int copy_dir_content( const Pathname & srcpath, const Pathname & destpath);
 
@@ -635,8 +638,11 @@ namespace zypp
     /**
      * Like 'cp file dest'. Copy file to destination file.
      *
-     * @return 0 on success, EINVAL if file is not a file, EISDIR if
-     * destiantion is a directory, otherwise the commands return value.
+     * An existing \a dest is removed first (like 'cp --remove-destination').
+     * The data are copied by the kernel (reflink if possible).
+     *
+     * @return 0 on success, EINVAL if file is not a file (or the same as
+     * dest), EISDIR if destiantion is a directory, otherwise errno.
      **/
     int copy( const Pathname & file, const Pathname & dest );
 
@@ -696,7 +702,7 @@ namespace zypp
      * Like 'cp file dest'. Copy file to dest dir.
      *
      * @return 0 on success, EINVAL if file is not a file, ENOTDIR if dest
-     * is no directory, otherwise the commands return value.
+     * is no directory, otherwise errno.
      **/
     int copy_file2dir( const Pathname & file, const Pathname & dest );
     //@}
@@ -72,7 +72,11 @@ namespace zypp
     public:
       /** \name Status related methods. */
       //@{
-      /** Returns the current status. */
+      /** Returns the current status.
+       * An empty \ref PoolItem, or one whose solvable was removed from the
+       * pool (its id may be reused), has a detached default status. Changes
+       * to it are discarded and never reach an item in the pool.
+       */
       ResStatus & status() const;
 
       /** Reset status. */
@@ -124,7 +128,8 @@ namespace zypp
       /** Returns the ResObject::constPtr.
        * \see \ref operator->
        */
-      ResObject::constPtr resolvable() const;
+      ResObject::constPtr resolvable() const
+      { return _resolvable; }
 
       /** Implicit conversion into ResObject::constPtr to
        *  support query filters operating on ResObject.
@@ -140,15 +145,11 @@ namespace zypp
       friend class pool::PoolImpl;
       /** \ref PoolItem generator for \ref pool::PoolImpl. */
       static PoolItem makePoolItem( const sat::Solvable & solvable_r );
-      /** Buddies are set by \ref pool::PoolImpl.*/
-      void setBuddy( const sat::Solvable & solv_r );
-      /** internal ctor */
-    public:
-      class Impl;	///< Expose type only
-    private:
-      explicit PoolItem( Impl * implptr_r );
-      /** Pointer to implementation */
-      RW_pointer<Impl> _pimpl;
+      /** The items \ref ResObject.
+       * A \ref PoolItem is just a handle; status and buddy are
+       * kept in solvable id indexed tables by \ref pool::PoolImpl.
+       */
+      ResObject::constPtr _resolvable;
 
     private:
       /** \name tmp hack for save/restore state. */
@@ -9,8 +9,20 @@
 /** \file	zypp/PoolQuery.cc
  *
 */
+extern "C"
+{
+#include <solv/pool.h>
+#include <solv/repo.h>
+#include <solv/repodata.h>
+#include <solv/dirpool.h>
+}
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <type_traits>
 
 #include "zypp/base/Gettext.h"
 #include "zypp/base/LogTools.h"
@@ -21,6 +33,7 @@
 
 #include "zypp/sat/Pool.h"
 #include "zypp/sat/Solvable.h"
+#include "zypp/sat/SearchIndex.h"
 #include "zypp/base/StrMatcher.h"
 
 #include "zypp/PoolQuery.h"
@@ -225,6 +238,7 @@ namespace zypp
       {
         predicate    = predicate_r;
         predicateStr = predicate_r.serialize();
+        solvablePredicate = std::is_same<TPredicate,SolvableRangePredicate>::value;
       }
 
       /** Dumb serialization.
@@ -298,6 +312,7 @@ namespace zypp
 		ZYPP_THROW( Exception( str::Str() << "Wrong number of words: " << str_r ) );
 		break;
 	    }
+	    ret.solvablePredicate = true;
           }
           else if ( words[0] == "CapabilityMatch" )
           {
@@ -315,6 +330,7 @@ namespace zypp
       StrMatcher       strMatcher;
       Predicate        predicate;
       std::string      predicateStr;
+      bool             solvablePredicate = false;	// predicate is a SolvableRangePredicate
       ResKind          kindPredicate = ResKind::nokind;	// holds the 'kind' part if SolvAttr:name looks for an explicit 'kind:name'
     };
 
@@ -453,8 +469,16 @@ namespace zypp
 
     /** StrMatcher per attribtue. */
     mutable AttrMatchList _attrMatchList;
+    /** The \ref compileKey \ref _attrMatchList was built for. */
+    mutable std::string _compiledKey;
 
   private:
+    /** Raw query options \ref compile depends on.
+     * As long as they do not change, the last \ref _attrMatchList is reused.
+     */
+    std::string compileKey() const;
+
+
     /** Pass flags from \ref compile, as they may have been changed. */
     string createRegex( const StrContainer & container, const Match & flags ) const;
 
@@ -489,9 +513,42 @@ namespace zypp
     }
   };
 
+  std::string PoolQuery::Impl::compileKey() const
+  {
+    std::string ret( str::numstring( _flags.get() ) );
+    str::appendEscaped( ret, _match_word ? "W" : "-" );
+    str::appendEscaped( ret, _require_all ? "A" : "-" );
+
+    str::appendEscaped( ret, str::numstring( _strings.size() ) );
+    for ( const std::string & val : _strings )
+      str::appendEscaped( ret, val );
+
+    str::appendEscaped( ret, str::numstring( _attrs.size() ) );
+    for ( const auto & attr : _attrs )
+    {
+      str::appendEscaped( ret, attr.first.asString() );
+      str::appendEscaped( ret, str::numstring( attr.second.size() ) );
+      for ( const std::string & val : attr.second )
+        str::appendEscaped( ret, val );
+    }
+
+    str::appendEscaped( ret, str::numstring( _uncompiledPredicated.size() ) );
+    for ( const AttrMatchData & data : _uncompiledPredicated )
+    {
+      str::appendEscaped( ret, data.serialize() );
+      str::appendEscaped( ret, data.kindPredicate.asString() );	// not part of the serialization
+    }
+    return ret;
+  }
+
   void PoolQuery::Impl::compile() const
   {
+    std::string key( compileKey() );
+    if ( ! _attrMatchList.empty() && key == _compiledKey )
+      return; // nothing changed since the last compile
+
     _attrMatchList.clear();
+    _compiledKey.clear();
 
     Match cflags( _flags );
     if ( cflags.mode() == Match::OTHER ) // this will never succeed...
@@ -663,6 +720,7 @@ attremptycheckend:
     {
       it->strMatcher.compile(); // throws on error
     }
+    _compiledKey.swap( key );
     //DBG << asString() << endl;
   }
 
@@ -1440,6 +1498,47 @@ attremptycheckend:
   namespace detail
   { /////////////////////////////////////////////////////////////////
 
+    namespace
+    {
+      /** Whether a file of \a solv_r matches \a matcher_r (a \c Match::FILES matcher).
+       *
+       * libsolv builds the full paths for \c Match::FILES in the pools tmpspace,
+       * which must not be used by concurrent threads. Here the filelist is iterated
+       * as stored (dir id and basename) and the path is built in \a buf_r.
+       */
+      bool filelistMatch( sat::Solvable solv_r, const StrMatcher & matcher_r, std::string & buf_r )
+      {
+        std::vector<const char *> comps;
+        sat::LookupAttr q( sat::SolvAttr::filelist, solv_r );
+        for_( it, q.begin(), q.end() )
+        {
+          if ( ! matcher_r )
+            return true;	// an empty searchstring matches always
+
+          ::Dataiterator * dip( it.get() );
+          ::Repodata * data( dip->data );
+          comps.clear();
+          for ( ::Id did = dip->kv.id; did; did = ::dirpool_parent( &data->dirpool, did ) )
+          {
+            ::Id comp = ::dirpool_compid( &data->dirpool, did );
+            comps.push_back( data->localpool ? ::stringpool_id2str( &data->spool, comp )
+                                             : ::pool_id2str( data->repo->pool, comp ) );
+          }
+          buf_r.clear();
+          for ( auto cit = comps.rbegin(); cit != comps.rend(); ++cit )
+          {
+            buf_r += *cit;	// the root dir component is empty
+            buf_r += '/';
+          }
+          buf_r += dip->kv.str;
+
+          if ( matcher_r.doMatch( buf_r.c_str() ) )
+            return true;
+        }
+        return false;
+      }
+    } // namespace
+
     ///////////////////////////////////////////////////////////////////
     //
     //  CLASS NAME : PoolQueryMatcher
@@ -1474,6 +1573,9 @@ attremptycheckend:
 
 	bool advance( base_iterator & base_r ) const
 	{
+	  if ( _useIndex )
+	    return advanceIndexed( base_r );
+
 	  if ( base_r == end() )
 	    base_r = startNewQyery(); // first candidate
 	  else
@@ -1542,6 +1644,108 @@ attremptycheckend:
           }
         }
 
+      public:
+        /** The repositories to search, in pool order.
+         * Repositories excluded by the repo, status or kind restriction are omitted.
+         */
+        std::vector<Repository> searchRepos() const
+        {
+          std::vector<Repository> ret;
+          if ( _neverMatchRepo )
+            return ret;
+
+          for ( const Repository & repo : sat::Pool::instance().repos() )
+          {
+            if ( _status_flags
+               && ( (_status_flags == PoolQuery::INSTALLED_ONLY) != repo.isSystemRepo() ) )
+              continue;
+            if ( ! _repos.empty() && _repos.find( repo ) == _repos.end() )
+              continue;
+            if ( ! repoKindsOk( repo ) )
+              continue;
+            ret.push_back( repo );
+          }
+          return ret;
+        }
+
+        /** Whether copies of this matcher may search distinct repositories in concurrent threads.
+         *
+         * The libsolv Dataiterator itself is per thread, but some attributes are loaded
+         * (vertical data pages) or stringified (pool tmpspace) on demand, modifying the
+         * shared pool. Accepted are attributes stored with the solvables or incore, and
+         * the \c description and \c filelist, whose vertical data are loaded by
+         * \ref prepareConcurrentSearch. Files are matched by the workers themselves
+         * (see \ref filelistMatch). If \c true, all \ref StrMatcher are compiled, so
+         * no lazy compilation happens in the workers.
+         */
+        bool concurrencySafe() const
+        {
+          if ( _attrMatchList.empty() )
+            return false;
+          for ( const AttrMatchData & matchData : _attrMatchList )
+          {
+            switch ( attrStore( matchData.attr ) )
+            {
+              case SOLVABLE_ATTR:
+              case INCORE_ATTR:
+                break;
+              case ONDEMAND_ATTR:
+                if ( matchData.attr == sat::SolvAttr::description || matchData.attr == sat::SolvAttr::filelist )
+                  break;	// loaded by prepareConcurrentSearch
+                return false;
+              case UNKNOWN_ATTR:
+                return false;
+            }
+            if ( matchData.strMatcher.flags().test( Match::FILES )
+                 && ( matchData.attr != sat::SolvAttr::filelist || matchData.predicate || _useIndex ) )
+              return false;	// no own filelistMatch for these; the index is fast enough
+          }
+          for ( const AttrMatchData & matchData : _attrMatchList )
+          {
+            if ( matchData.strMatcher )
+              matchData.strMatcher.compile();
+          }
+          return true;
+        }
+
+        /** Load the vertical data searched in \a repos_r, so concurrent threads don't page them in.
+         * Only needed for the long texts and filelists; they stay in memory then.
+         */
+        void prepareConcurrentSearch( const std::vector<Repository> & repos_r ) const
+        {
+          for ( const AttrMatchData & matchData : _attrMatchList )
+          {
+            if ( matchData.attr == sat::SolvAttr::description || matchData.attr == sat::SolvAttr::filelist )
+            {
+              for ( const Repository & repo : repos_r )
+                ::repo_disable_paging( repo.get() );
+              return;
+            }
+          }
+        }
+
+        /** Restrict the search to a single repository (per worker copy).
+         * Queries on more than one attribute are then based on \c SolvAttr::name
+         * rather than \c SolvAttr::allAttr, so the base iterator does not touch
+         * any attribute libsolv loads on demand. Each Solvable is still visited once.
+         * The same applies to \c Match::FILES queries, which are then evaluated
+         * by \ref filelistMatch in \ref isAMatch.
+         */
+        void restrictToRepo( Repository repo_r )
+        {
+          _repos.clear();
+          _repos.insert( repo_r );
+          _neverMatchRepo = false;
+          _restrictedToRepo = true;
+          if ( _useIndex )
+            _indexRepos.assign( 1, repo_r );
+          for ( const AttrMatchData & matchData : _attrMatchList )
+          {
+            if ( matchData.strMatcher.flags().test( Match::FILES ) )
+              _ownFileMatch = true;
+          }
+        }
+
       public:
 	/** Ctor stores the \ref PoolQuery settings.
          * \throw MatchException Any of the exceptions thrown by \ref PoolQuery::Impl::compile.
@@ -1575,12 +1779,207 @@ attremptycheckend:
 	  _status_flags = query_r->_status_flags;
           // StrMatcher
           _attrMatchList = query_r->_attrMatchList;
+
+          // Multiple attributes are checked cheapest first; isAMatch stops at the 1st hit.
+          _attrMatchByCost = _attrMatchList;
+          if ( _attrMatchByCost.size() > 1 )
+            _attrMatchByCost.sort( []( const AttrMatchData & lhs, const AttrMatchData & rhs ) {
+              return attrCost( lhs ) < attrCost( rhs );
+            } );
+
+          // A SolvableRangePredicate depends on the solvable only, not on the attribute value.
+          // If it fails once, there's no need to inspect further values of this solvable.
+          _solvablePredicate = ( _attrMatchList.size() == 1 && _attrMatchList.front().solvablePredicate );
+
+          // Whole repos without any solvable of an acceptable kind can be skipped.
+          // An explicit kind:name overrules the global kinds, so it must be accepted too.
+          _restrictKinds = true;
+          _repoKinds = _kinds;
+          for ( const AttrMatchData & matchData : _attrMatchList )
+          {
+            if ( matchData.kindPredicate )
+              _repoKinds.insert( matchData.kindPredicate );
+            else if ( _kinds.empty() )
+              _restrictKinds = false;
+          }
+
+          // A single indexed attribute is looked up in the candidates provided by the
+          // repos sat::SearchIndex (if any) rather than in all solvables.
+          if ( _attrMatchList.size() == 1
+               && sat::SearchIndex::indexed( _attrMatchList.front().attr )
+               && _attrMatchList.front().strMatcher
+               && sat::SearchIndex::available() )
+          {
+            _useIndex = true;
+            _indexRepos = searchRepos();
+          }
 	}
 
 	~PoolQueryMatcher()
 	{}
 
       private:
+        /** Where libsolv keeps an attribute (see \ref attrStore). */
+        enum AttrStore
+        {
+          SOLVABLE_ATTR,	//!< stored with the solvable
+          INCORE_ATTR,		//!< a plain incore string
+          UNKNOWN_ATTR,		//!< anything else; may be stringified on demand
+          ONDEMAND_ATTR		//!< vertical data loaded on demand
+        };
+
+        /** Where libsolv keeps \a attr_r.
+         * Names and dependencies are stored with the solvables, most other
+         * strings are incore. Long texts and filelists are loaded on demand.
+         * Used by \ref attrCost and \ref concurrencySafe.
+         */
+        static AttrStore attrStore( const sat::SolvAttr & attr_r )
+        {
+          static const std::map<sat::SolvAttr,AttrStore> _store = {
+            { sat::SolvAttr::name, SOLVABLE_ATTR }, { sat::SolvAttr::edition, SOLVABLE_ATTR },
+            { sat::SolvAttr::arch, SOLVABLE_ATTR }, { sat::SolvAttr::vendor, SOLVABLE_ATTR },
+            { sat::SolvAttr::provides, SOLVABLE_ATTR }, { sat::SolvAttr::obsoletes, SOLVABLE_ATTR },
+            { sat::SolvAttr::conflicts, SOLVABLE_ATTR }, { sat::SolvAttr::requires, SOLVABLE_ATTR },
+            { sat::SolvAttr::recommends, SOLVABLE_ATTR }, { sat::SolvAttr::suggests, SOLVABLE_ATTR },
+            { sat::SolvAttr::supplements, SOLVABLE_ATTR }, { sat::SolvAttr::enhances, SOLVABLE_ATTR },
+            { sat::SolvAttr::summary, INCORE_ATTR }, { sat::SolvAttr::group, INCORE_ATTR },
+            { sat::SolvAttr::license, INCORE_ATTR }, { sat::SolvAttr::keywords, INCORE_ATTR },
+            { sat::SolvAttr::allAttr, ONDEMAND_ATTR }, { sat::SolvAttr::filelist, ONDEMAND_ATTR },
+            { sat::SolvAttr::description, ONDEMAND_ATTR }, { sat::SolvAttr::changelog, ONDEMAND_ATTR },
+            { sat::SolvAttr::eula, ONDEMAND_ATTR }, { sat::SolvAttr::insnotify, ONDEMAND_ATTR },
+            { sat::SolvAttr::delnotify, ONDEMAND_ATTR }, { sat::SolvAttr::authors, ONDEMAND_ATTR },
+          };
+          auto it( _store.find( attr_r ) );
+          return( it == _store.end() ? UNKNOWN_ATTR : it->second );
+        }
+
+        /** Rough cost of looking up an attribute (see \ref attrStore).
+         * Long texts and filelists are checked last. Attributes with a
+         * predicate come after those without.
+         */
+        static unsigned attrCost( const AttrMatchData & matchData_r )
+        {
+          unsigned ret = 2;
+          if ( matchData_r.attr == sat::SolvAttr::name )
+            ret = 0;
+          else
+          {
+            switch ( attrStore( matchData_r.attr ) )
+            {
+              case SOLVABLE_ATTR:	ret = 1; break;
+              case INCORE_ATTR:
+              case UNKNOWN_ATTR:	ret = 2; break;
+              case ONDEMAND_ATTR:	ret = 3; break;
+            }
+          }
+          return 2 * ret + ( matchData_r.predicate ? 1 : 0 );
+        }
+
+        /** Whether \a repo_r contains any solvable of an acceptable kind (cached). */
+        bool repoKindsOk( Repository repo_r ) const
+        {
+          if ( ! _restrictKinds )
+            return true;
+
+          auto it( _repoKindsOk.find( repo_r ) );
+          if ( it != _repoKindsOk.end() )
+            return it->second;
+
+          bool ok = false;
+          for ( const sat::Solvable & solv : repo_r.solvables() )
+          {
+            if ( solv.isKind( _repoKinds.begin(), _repoKinds.end() ) )
+            {
+              ok = true;
+              break;
+            }
+          }
+          return( _repoKindsOk[repo_r] = ok );
+        }
+
+        /** \ref advance using the \ref sat::SearchIndex candidates.
+         * Repos without a usable index are scanned as usual.
+         */
+	bool advanceIndexed( base_iterator & base_r ) const
+	{
+	  if ( base_r == end() )
+	    base_r = nextIndexedBase( sat::Solvable::noSolvable ); // first candidate
+	  else
+	    nextIndexedCandidate( base_r, true );
+
+	  while ( base_r != end() )
+	  {
+	    if ( isAMatch( base_r ) )
+	      return true;
+	    // No match: try next
+	    nextIndexedCandidate( base_r, false );
+	  }
+	  return false;
+	}
+
+	/** Advance \a base_r, continuing with the next candidate solvable if the current one is done. */
+	void nextIndexedCandidate( base_iterator & base_r, bool skipSolvable_r ) const
+	{
+	  sat::Solvable inSolvable( base_r.inSolvable() );
+	  if ( skipSolvable_r )
+	    base_r.nextSkipSolvable();
+	  ++base_r;
+	  if ( base_r == end() )
+	    base_r = nextIndexedBase( inSolvable );
+	}
+
+	/** Base iterator for the first candidate following \a after_r (or the first one at all). */
+	base_iterator nextIndexedBase( sat::Solvable after_r ) const
+	{
+	  const AttrMatchData & matchData( _attrMatchList.front() );
+
+	  std::vector<Repository>::const_iterator rit( _indexRepos.begin() );
+	  if ( after_r )
+	    rit = std::find( _indexRepos.begin(), _indexRepos.end(), after_r.repository() );
+
+	  for ( ; rit != _indexRepos.end(); ++rit, after_r = sat::Solvable::noSolvable )
+	  {
+	    const std::vector<sat::Solvable> * candidates( indexCandidates( *rit ) );
+	    if ( ! candidates )
+	    {
+	      if ( after_r )
+		continue;	// the scan of this repo is done
+	      sat::LookupAttr q( matchData.attr, *rit );
+	      q.setStrMatcher( matchData.strMatcher );
+	      base_iterator ret( q.begin() );
+	      if ( ret != end() )
+		return ret;
+	      continue;
+	    }
+
+	    std::vector<sat::Solvable>::const_iterator cit( after_r ? std::upper_bound( candidates->begin(), candidates->end(), after_r )
+	                                                            : candidates->begin() );
+	    for ( ; cit != candidates->end(); ++cit )
+	    {
+	      sat::LookupAttr q( matchData.attr, *cit );
+	      q.setStrMatcher( matchData.strMatcher );
+	      base_iterator ret( q.begin() );
+	      if ( ret != end() )
+		return ret;
+	    }
+	  }
+	  return end();
+	}
+
+	/** The index candidates in \a repo_r (cached), or \c nullptr if the repo must be scanned. */
+	const std::vector<sat::Solvable> * indexCandidates( Repository repo_r ) const
+	{
+	  auto it( _indexCandidates.find( repo_r ) );
+	  if ( it == _indexCandidates.end() )
+	  {
+	    std::pair<bool,std::vector<sat::Solvable>> & entry( _indexCandidates[repo_r] );
+	    const AttrMatchData & matchData( _attrMatchList.front() );
+	    entry.first = sat::SearchIndex::candidates( repo_r, matchData.attr, matchData.strMatcher, entry.second );
+	    return( entry.first ? &entry.second : nullptr );
+	  }
+	  return( it->second.first ? &it->second.second : nullptr );
+	}
+
 	/** Initialize a new base query. */
 	base_iterator startNewQyery() const
 	{
@@ -1595,7 +1994,7 @@ attremptycheckend:
 	  // else: handled in isAMatch.
 
 	  // Attribute restriction:
-	  if ( _attrMatchList.size() == 1 ) // all (SolvAttr::allAttr) or 1 attr
+	  if ( _attrMatchList.size() == 1 && ! _ownFileMatch ) // all (SolvAttr::allAttr) or 1 attr
 	  {
             const AttrMatchData & matchData( _attrMatchList.front() );
 	    q.setAttr( matchData.attr );
@@ -1605,7 +2004,7 @@ attremptycheckend:
           else // more than 1 attr (but not all)
           {
             // no restriction, it's all handled in isAMatch.
-            q.setAttr( sat::SolvAttr::allAttr );
+            q.setAttr( _restrictedToRepo ? sat::SolvAttr::name : sat::SolvAttr::allAttr );
           }
 
 	  return q.begin();
@@ -1639,6 +2038,12 @@ attremptycheckend:
 	    base_r.nextSkipRepo();
 	    return false;
 	  }
+	  // Kind restriction (whole repo):
+	  if ( ! repoKindsOk( inRepo ) )
+	  {
+	    base_r.nextSkipRepo();
+	    return false;
+	  }
 	  /////////////////////////////////////////////////////////////////////
 	  sat::Solvable inSolvable( base_r.inSolvable() );
 	  // Edition restriction:
@@ -1656,7 +2061,7 @@ attremptycheckend:
 	  /////////////////////////////////////////////////////////////////////
 	  // string and predicate matching:
 
-          if ( _attrMatchList.size() == 1 )
+          if ( _attrMatchList.size() == 1 && ! _ownFileMatch )
           {
             // String matching was done by the base iterator.
             // Now check any predicate:
@@ -1676,11 +2081,13 @@ attremptycheckend:
             if ( !matchData.predicate || matchData.predicate( base_r ) )
               return true;
 
+            if ( _solvablePredicate )
+              base_r.nextSkipSolvable();	// other values of this attr won't change the result
             return false; // no skip as there may be more occurrences in this solvable of this attr.
           }
 
           // Here: search all attributes ;(
-          for_( mi, _attrMatchList.begin(), _attrMatchList.end() )
+          for_( mi, _attrMatchByCost.begin(), _attrMatchByCost.end() )
           {
             const AttrMatchData & matchData( *mi );
 
@@ -1692,6 +2099,13 @@ attremptycheckend:
 	    else if ( !globalKindOk )
 	      continue;				// only matching kindPredicate could overwrite this
 
+            if ( _ownFileMatch && matchData.strMatcher.flags().test( Match::FILES ) )
+            {
+              if ( filelistMatch( inSolvable, matchData.strMatcher, _pathbuf ) )
+                return true;			// no predicate (see concurrencySafe)
+              continue;
+            }
+
             sat::LookupAttr q( matchData.attr, inSolvable );
             if ( matchData.strMatcher ) // an empty searchstring matches always
               q.setStrMatcher( matchData.strMatcher );
@@ -1720,6 +2134,11 @@ attremptycheckend:
         /** Repositories include in the search. */
         std::set<Repository> _repos;
 	DefaultIntegral<bool,false> _neverMatchRepo;
+        /** Worker copy searching a single repository. \see \ref restrictToRepo */
+	DefaultIntegral<bool,false> _restrictedToRepo;
+        /** Worker copy matching \c Match::FILES via \ref filelistMatch. */
+	DefaultIntegral<bool,false> _ownFileMatch;
+        mutable std::string _pathbuf;
         /** Resolvable kinds to include. */
         std::set<ResKind> _kinds;
         /** Edition filter. */
@@ -1729,6 +2148,19 @@ attremptycheckend:
         int _status_flags;
         /** StrMatcher per attribtue. */
         AttrMatchList _attrMatchList;
+        /** \ref _attrMatchList ordered by \ref attrCost (used by \ref isAMatch). */
+        AttrMatchList _attrMatchByCost;
+        /** Single attribute with a predicate depending on the solvable only. */
+	DefaultIntegral<bool,false> _solvablePredicate;
+        /** Whether only repos providing one of \ref _repoKinds can match. */
+	DefaultIntegral<bool,false> _restrictKinds;
+        std::set<ResKind> _repoKinds;
+        mutable std::map<Repository,bool> _repoKindsOk;
+        /** Whether to use the \ref sat::SearchIndex (single indexed attribute). */
+	DefaultIntegral<bool,false> _useIndex;
+        /** The repos searched via \ref nextIndexedBase. */
+        std::vector<Repository> _indexRepos;
+        mutable std::map<Repository,std::pair<bool,std::vector<sat::Solvable>>> _indexCandidates;
     };
     ///////////////////////////////////////////////////////////////////
 
@@ -1784,6 +2216,92 @@ attremptycheckend:
     return shared_ptr<detail::PoolQueryMatcher>( new detail::PoolQueryMatcher( _pimpl.getPtr() ) );
   }
 
+  namespace
+  {
+    /** The number of threads to search \a repos_r with \a matcher_r (\ref PoolQuery::collect). */
+    unsigned collectThreads( const detail::PoolQueryMatcher & matcher_r, const std::vector<Repository> & repos_r,
+                             unsigned maxParallel_r, const PoolQuery & query_r )
+    {
+      if ( ! maxParallel_r )
+        maxParallel_r = std::max( 1U, std::thread::hardware_concurrency() );
+      maxParallel_r = std::min<unsigned>( maxParallel_r, repos_r.size() );
+
+      if ( maxParallel_r > 1 && ! matcher_r.concurrencySafe() )
+      {
+        DBG << "Query can not be evaluated concurrently: " << query_r << endl;
+        maxParallel_r = 1;
+      }
+      return maxParallel_r;
+    }
+  } // namespace
+
+  unsigned PoolQuery::collectThreads( unsigned maxParallel ) const
+  {
+    detail::PoolQueryMatcher matcher( _pimpl.getPtr() );	// may throw
+    return zypp::collectThreads( matcher, matcher.searchRepos(), maxParallel, *this );
+  }
+
+  std::vector<sat::Solvable> PoolQuery::collect( unsigned maxParallel ) const
+  {
+    typedef detail::PoolQueryMatcher::base_iterator base_iterator;
+    std::vector<sat::Solvable> ret;
+
+    detail::PoolQueryMatcher matcher( _pimpl.getPtr() );	// may throw
+    std::vector<Repository> repos( matcher.searchRepos() );
+    maxParallel = zypp::collectThreads( matcher, repos, maxParallel, *this );
+
+    if ( maxParallel <= 1 )
+    {
+      for ( base_iterator it; matcher.advance( it ); )
+        ret.push_back( it.inSolvable() );
+      return ret;
+    }
+    matcher.prepareConcurrentSearch( repos );
+
+    // One matcher copy and result per repo; the results are joined in pool order.
+    // Workers must neither log nor throw.
+    std::vector<detail::PoolQueryMatcher> matchers( repos.size(), matcher );
+    std::vector<std::vector<sat::Solvable>> found( repos.size() );
+    std::vector<std::exception_ptr> errors( repos.size() );
+    for ( unsigned idx = 0; idx < repos.size(); ++idx )
+      matchers[idx].restrictToRepo( repos[idx] );
+
+    DBG << "Evaluating query on " << repos.size() << " repos using " << maxParallel << " threads" << endl;
+    std::atomic<unsigned> next( 0 );
+    auto worker = [&]() {
+      for ( unsigned idx = next++; idx < repos.size(); idx = next++ )
+      {
+        try
+        {
+          for ( base_iterator it; matchers[idx].advance( it ); )
+            found[idx].push_back( it.inSolvable() );
+        }
+        catch ( ... )
+        { errors[idx] = std::current_exception(); }
+      }
+    };
+    std::vector<std::thread> threads;
+    for ( unsigned i = 1; i < maxParallel; ++i )
+      threads.push_back( std::thread( worker ) );
+    worker();
+    for ( std::thread & thread : threads )
+      thread.join();
+
+    for ( const std::exception_ptr & error : errors )
+    {
+      if ( error )
+        std::rethrow_exception( error );
+    }
+
+    size_t total = 0;
+    for ( const std::vector<sat::Solvable> & part : found )
+      total += part.size();
+    ret.reserve( total );
+    for ( const std::vector<sat::Solvable> & part : found )
+      ret.insert( ret.end(), part.begin(), part.end() );
+    return ret;
+  }
+
   /////////////////////////////////////////////////////////////////
 } // namespace zypp
 ///////////////////////////////////////////////////////////////////
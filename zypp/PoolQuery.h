@@ -15,6 +15,7 @@
 #include <iosfwd>
 #include <set>
 #include <map>
+#include <vector>
 
 #include "zypp/base/Regex.h"
 #include "zypp/base/PtrTypes.h"
@@ -135,6 +136,30 @@ namespace zypp
      */
     void execute(ProcessResolvable fnc);
 
+    /**
+     * Collect the query result using up to \a maxParallel worker threads
+     * (\c 0 uses the number of available CPUs).
+     *
+     * Work is partitioned by repository. The matches are returned in the
+     * order \ref begin would visit them, no matter how many threads were used.
+     *
+     * \note Libsolv loads and stringifies some attributes on demand, which
+     * must not happen in concurrent threads. For queries on \c description
+     * or \c filelist the data of the searched repos are loaded (and kept in
+     * memory) before the threads start. Queries on other such attributes
+     * (e.g. \c changelog or checksums) or on all attributes are evaluated
+     * serially.
+     *
+     * \throws sat::MatchInvalidRegexException as \ref begin does.
+     */
+    std::vector<sat::Solvable> collect( unsigned maxParallel = 0 ) const;
+
+    /** The number of threads \ref collect would use (\c 1 if the query is
+     * evaluated serially).
+     * \throws sat::MatchInvalidRegexException as \ref begin does.
+     */
+    unsigned collectThreads( unsigned maxParallel = 0 ) const;
+
     /**
      * Filter by selectable kind.
      *
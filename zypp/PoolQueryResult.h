@@ -96,6 +96,22 @@ namespace zypp
       explicit PoolQueryResult( const PoolQuery & query_r )
       { operator+=( query_r ); }
 
+      /** Ctor adding one \ref PoolQuery result, evaluated by up to \a maxParallel threads.
+       * Like \ref operator+= an invalid query adds nothing, but an exception
+       * thrown while searching (e.g. in a worker thread) is passed on.
+       * \see \ref PoolQuery::collect
+       */
+      PoolQueryResult( const PoolQuery & query_r, unsigned maxParallel_r )
+      {
+        try
+        {
+          for ( sat::Solvable solv : query_r.collect( maxParallel_r ) )
+            _result.insert( solv );
+        }
+        catch ( const MatchException & )
+        {}
+      }
+
       /** Ctor adding a range of items for which \ref operator+= is defined. */
       template<class TQueryResultIter>
       PoolQueryResult( TQueryResultIter begin_r, TQueryResultIter end_r )
@@ -16,7 +16,11 @@
 #include <sstream>
 #include <list>
 #include <map>
+#include <vector>
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
 
 #include <solv/solvversion.h>
 
@@ -35,6 +39,7 @@
 
 #include "zypp/media/MediaManager.h"
 #include "zypp/media/CredentialManager.h"
+#include "zypp/media/MirrorStats.h"
 #include "zypp/MediaSetAccess.h"
 #include "zypp/ExternalProgram.h"
 #include "zypp/ManagedFile.h"
@@ -45,6 +50,7 @@
 #include "zypp/repo/yum/Downloader.h"
 #include "zypp/repo/susetags/Downloader.h"
 #include "zypp/repo/PluginServices.h"
+#include "zypp/repo/Repo2Solv.h"
 
 #include "zypp/Target.h" // for Target::targetDistribution() for repo index services
 #include "zypp/ZYppFactory.h" // to get the Target from ZYpp instance
@@ -53,6 +59,7 @@
 #include "zypp/ZYppCallbacks.h"
 
 #include "sat/Pool.h"
+#include "sat/SearchIndex.h"
 
 using std::endl;
 using std::string;
@@ -516,6 +523,8 @@ namespace zypp
     Impl( const RepoManagerOptions &opt )
       : _options(opt)
     {
+      // mirror statistics are kept in the (target root's) repo cache
+      media::MirrorStats::instance().setFile( _options.repoCachePath / "mirrorstats" );
       init_knownServices();
       init_knownRepositories();
     }
@@ -591,12 +600,16 @@ namespace zypp
 
     void refreshMetadata( const RepoInfo & info, RawMetadataRefreshPolicy policy, OPT_PROGRESS );
 
+    RefreshErrors refreshMetadata( const std::list<RepoInfo> & infos, RawMetadataRefreshPolicy policy, unsigned maxParallel, OPT_PROGRESS );
+
     void cleanMetadata( const RepoInfo & info, OPT_PROGRESS );
 
     void cleanPackages( const RepoInfo & info, OPT_PROGRESS );
 
     void buildCache( const RepoInfo & info, CacheBuildPolicy policy, OPT_PROGRESS );
 
+    RepoErrors buildCache( const std::list<RepoInfo> & infos, CacheBuildPolicy policy, unsigned maxParallel, OPT_PROGRESS );
+
     repo::RepoType probe( const Url & url, const Pathname & path = Pathname() ) const;
     repo::RepoType probeCache( const Pathname & path_r ) const;
 
@@ -677,6 +690,28 @@ namespace zypp
 
     void touchIndexFile( const RepoInfo & info );
 
+    /** Batch \ref refreshMetadata: Whether refreshing \a info from \a url needs the remote status files (to check or to download). */
+    bool needsRemoteStatus( const RepoInfo & info, const Url & url, RawMetadataRefreshPolicy policy ) const;
+    /** \ref checkIfToRefreshMetadata, \ref refreshMetadata: The media to check or download \a url (prepared by a batch refresh or a new one). */
+    shared_ptr<MediaSetAccess> refreshCheckMedia( const Url & url );
+    /** Batch \ref refreshMetadata: Prefetch the metadata the download of \a info from \a url will retrieve. Never throws. */
+    void prefetchMetadata( const RepoInfo & info, const Url & url );
+
+    /** Batch \ref refreshMetadata and \ref buildCache: Remember the exception
+     * currently handled as error of \a info (call from within a \c catch block).
+     */
+    static void rememberRepoError( RepoErrors & errors_r, const RepoInfo & info, const Exception & excpt )
+    {
+      ERR << info.alias() << ": " << excpt << endl;
+      errors_r[info.alias()] = std::current_exception();
+    }
+
+    struct CacheBuildJob;
+    /** \ref buildCache: Check and prepare; \c false if the cache is up to date. */
+    bool buildCacheSetup( CacheBuildJob & job_r, CacheBuildPolicy policy, const ProgressData::ReceiverFnc & progressrcv );
+    /** \ref buildCache: Build the solv file (unless done in-process already) and write the cookie. */
+    void buildCacheCommit( CacheBuildJob & job_r, const ProgressData::ReceiverFnc & progressrcv );
+
     template<typename OutputIterator>
     void getRepositoriesInService( const std::string & alias, OutputIterator out ) const
     {
@@ -700,6 +735,11 @@ namespace zypp
 
     DefaultIntegral<bool,false> _reposDirty;
 
+    /** Media with prefetched status files and metadata, kept during a batch \ref refreshMetadata. */
+    std::map<Url, shared_ptr<MediaSetAccess> > _refreshCheckMedia;
+    /** The remote master indices provided by \ref checkIfToRefreshMetadata during a batch \ref refreshMetadata, by alias. */
+    std::map<std::string, Pathname> _refreshCheckIndex;
+
   private:
     friend Impl * rwcowClone<Impl>( const Impl * rhs );
     /** clone for RWCOW_pointer */
@@ -1029,15 +1069,18 @@ namespace zypp
       {
 	case RepoType::RPMMD_e:
 	{
-	  MediaSetAccess media( url );
-	  newstatus = yum::Downloader( info, mediarootpath ).status( media );
+	  shared_ptr<MediaSetAccess> media( refreshCheckMedia( url ) );
+	  Pathname masterIndex;
+	  newstatus = yum::Downloader( info, mediarootpath ).status( *media, masterIndex );
+	  if ( _refreshCheckMedia.count( url ) )
+	    _refreshCheckIndex[info.alias()] = masterIndex;	// batch refresh prefetches the files listed there
 	}
 	break;
 
 	case RepoType::YAST2_e:
 	{
-	  MediaSetAccess media( url );
-	  newstatus = susetags::Downloader( info, mediarootpath ).status( media );
+	  shared_ptr<MediaSetAccess> media( refreshCheckMedia( url ) );
+	  newstatus = susetags::Downloader( info, mediarootpath ).status( *media );
 	}
 	break;
 
@@ -1074,6 +1117,74 @@ namespace zypp
     return REFRESH_NEEDED; // default
   }
 
+  bool RepoManager::Impl::needsRemoteStatus( const RepoInfo & info, const Url & url, RawMetadataRefreshPolicy policy ) const
+  {
+    // Mirrors the decisions checkIfToRefreshMetadata takes before asking the server.
+    if ( url.schemeIsVolatile() || url.schemeIsLocal() )
+      return false;
+
+    RepoStatus oldstatus = metadataStatus( info );
+    if ( policy == RefreshForced || oldstatus.empty() )
+      return true;	// no check, but the download starts with the status files
+
+    if ( policy != RefreshIfNeededIgnoreDelay )
+    {
+      double diff = difftime( (Date::ValueType)Date::now(), (Date::ValueType)oldstatus.timestamp() ) / 60;
+      if ( diff >= 0 && diff < ZConfig::instance().repo_refresh_delay() )
+	return false;
+    }
+    return true;
+  }
+
+  shared_ptr<MediaSetAccess> RepoManager::Impl::refreshCheckMedia( const Url & url )
+  {
+    auto it = _refreshCheckMedia.find( url );
+    if ( it != _refreshCheckMedia.end() )
+      return it->second;
+    return shared_ptr<MediaSetAccess>( new MediaSetAccess( url ) );
+  }
+
+  void RepoManager::Impl::prefetchMetadata( const RepoInfo & info, const Url & url )
+  {
+    try
+    {
+      shared_ptr<MediaSetAccess> media( refreshCheckMedia( url ) );
+      switch ( info.type().toEnum() )
+      {
+	case RepoType::RPMMD_e:
+	{
+	  yum::Downloader downloader( info, rawcache_path_for_repoinfo( _options, info ) );
+	  Pathname & masterIndex( _refreshCheckIndex[info.alias()] );
+	  if ( masterIndex.empty() )	// not checked (forced or initial refresh)
+	    downloader.status( *media, masterIndex );
+	  downloader.prefetch( *media, masterIndex );
+	}
+	break;
+
+	case RepoType::YAST2_e:
+	{
+	  // The files listed in the content file are retrieved by the download.
+	  Pathname masterIndex( info.path() + "/content" );
+	  std::list<OnMediaLocation> files;
+	  files.push_back( OnMediaLocation( "/media.1/media" ) );
+	  files.push_back( OnMediaLocation( masterIndex ) );
+	  files.push_back( OnMediaLocation( masterIndex.extend( ".asc" ) ) );
+	  files.push_back( OnMediaLocation( masterIndex.extend( ".key" ) ) );
+	  media->prefetchFiles( files );
+	}
+	break;
+
+	default:
+	  break;
+      }
+    }
+    catch ( const Exception & excpt )
+    {
+      // the download will report it
+      ZYPP_CAUGHT( excpt );
+    }
+  }
+
 
   void RepoManager::Impl::refreshMetadata( const RepoInfo & info, RawMetadataRefreshPolicy policy, const ProgressData::ReceiverFnc & progress )
   {
@@ -1146,7 +1257,7 @@ namespace zypp
         if ( ( repokind.toEnum() == RepoType::RPMMD_e ) ||
              ( repokind.toEnum() == RepoType::YAST2_e ) )
         {
-          MediaSetAccess media(url);
+          shared_ptr<MediaSetAccess> media( refreshCheckMedia( url ) );
           shared_ptr<repo::Downloader> downloader_ptr;
 
           MIL << "Creating downloader for [ " << info.alias() << " ]" << endl;
@@ -1169,7 +1280,7 @@ namespace zypp
               downloader_ptr->addCachePath(cachepath);
           }
 
-          downloader_ptr->download( media, tmpdir.path() );
+          downloader_ptr->download( *media, tmpdir.path() );
         }
         else if ( repokind.toEnum() == RepoType::RPMPLAINDIR_e )
         {
@@ -1213,6 +1324,105 @@ namespace zypp
     ZYPP_THROW(rexception);
   }
 
+  RepoManager::RefreshErrors RepoManager::Impl::refreshMetadata( const std::list<RepoInfo> & infos, RawMetadataRefreshPolicy policy, unsigned maxParallel, const ProgressData::ReceiverFnc & progress )
+  {
+    // Retrieve the status files of all remote repos at once. The media are
+    // remembered, so checkIfToRefreshMetadata and the downloads find the
+    // files prefetched. Problems here are not fatal; the per repo refresh
+    // will report them.
+    _refreshCheckMedia.clear();
+    _refreshCheckIndex.clear();
+    {
+      media::ScopedPrefetchBatch batch;
+      for ( const RepoInfo & info : infos )
+      {
+	try
+	{
+	  if ( info.alias().empty() || info.baseUrlsEmpty() )
+	    continue;
+	  Url url( *info.baseUrlsBegin() );
+	  if ( ! needsRemoteStatus( info, url, policy ) )
+	    continue;
+
+	  std::list<OnMediaLocation> files;
+	  switch ( info.type().toEnum() )
+	  {
+	    case RepoType::RPMMD_e:
+	      files.push_back( OnMediaLocation( info.path() / "/repodata/repomd.xml" ) );
+	      break;
+	    case RepoType::YAST2_e:
+	      files.push_back( OnMediaLocation( info.path() + "/content" ) );
+	      break;
+	    default:
+	      continue;	// unknown type needs probing; leave it to the per repo refresh
+	  }
+	  files.push_back( OnMediaLocation( "/media.1/media" ) );
+
+	  shared_ptr<MediaSetAccess> & media( _refreshCheckMedia[url] );
+	  if ( ! media )
+	    media.reset( new MediaSetAccess( url ) );
+	  media->prefetchFiles( files );
+	}
+	catch ( const Exception & excpt )
+	{
+	  ZYPP_CAUGHT( excpt );
+	}
+      }
+      MIL << "Checking " << _refreshCheckMedia.size() << " of " << infos.size() << " repos concurrently" << endl;
+      batch.run( maxParallel );
+    }
+
+    // Check the repos and retrieve the metadata of all changed ones at once.
+    // Repos whose check failed are left to the per repo refresh, which may
+    // try other urls.
+    std::list<std::pair<RepoInfo,RawMetadataRefreshPolicy> > torefresh;
+    {
+      media::ScopedPrefetchBatch batch;
+      for ( const RepoInfo & info : infos )
+      {
+	try
+	{
+	  assert_alias( info );
+	  assert_urls( info );
+	  Url url( *info.baseUrlsBegin() );
+	  if ( checkIfToRefreshMetadata( info, url, policy ) != REFRESH_NEEDED )
+	    continue;
+	  torefresh.push_back( std::make_pair( info, RefreshForced ) );	// already checked
+	  if ( _refreshCheckMedia.count( url ) )
+	    prefetchMetadata( info, url );
+	}
+	catch ( const Exception & excpt )
+	{
+	  ZYPP_CAUGHT( excpt );
+	  torefresh.push_back( std::make_pair( info, policy ) );
+	}
+      }
+      MIL << "Downloading " << torefresh.size() << " of " << infos.size() << " repos concurrently" << endl;
+      batch.run( maxParallel );
+    }
+
+    // Check (KeyRing) and store the downloaded metadata per repo, in order.
+    RefreshErrors errors;
+    for ( const auto & el : torefresh )
+    {
+      try
+      {
+	refreshMetadata( el.first, el.second, progress );
+      }
+      catch ( const Exception & excpt )
+      {
+	ZYPP_CAUGHT( excpt );
+	rememberRepoError( errors, el.first, excpt );
+      }
+    }
+    _refreshCheckMedia.clear();
+    _refreshCheckIndex.clear();
+
+    MIL << "Refreshed " << torefresh.size() - errors.size() << " of " << infos.size() << " repos, "
+        << errors.size() << " failed" << endl;
+    return errors;
+  }
+
   ////////////////////////////////////////////////////////////////////////////
 
   void RepoManager::Impl::cleanMetadata( const RepoInfo & info, const ProgressData::ReceiverFnc & progressfnc )
@@ -1235,25 +1445,45 @@ namespace zypp
   }
 
 
-  void RepoManager::Impl::buildCache( const RepoInfo & info, CacheBuildPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
+  /** \ref RepoManager::Impl::buildCache state passed from \ref buildCacheSetup
+   * to \ref buildCacheCommit. In between the solv file may be built in-process,
+   * by a worker thread.
+   */
+  struct RepoManager::Impl::CacheBuildJob
+  {
+    CacheBuildJob( const RepoInfo & info_r )
+    : info( info_r )
+    , built( false )
+    {}
+
+    RepoInfo info;
+    RepoStatus rawStatus;
+    repo::RepoType repokind;
+    Pathname productdatapath;
+    Pathname solvfile;
+    bool built;			///< solv file was built in-process
+    std::string errdetail;	///< why it was not built in-process
+  };
+
+  bool RepoManager::Impl::buildCacheSetup( CacheBuildJob & job_r, CacheBuildPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
   {
+    const RepoInfo & info( job_r.info );
     assert_alias(info);
-    Pathname mediarootpath = rawcache_path_for_repoinfo( _options, info );
-    Pathname productdatapath = rawproductdata_path_for_repoinfo( _options, info );
+    job_r.productdatapath = rawproductdata_path_for_repoinfo( _options, info );
 
     if( filesystem::assert_dir(_options.repoCachePath) )
     {
       Exception ex(str::form( _("Can't create %s"), _options.repoCachePath.c_str()) );
       ZYPP_THROW(ex);
     }
-    RepoStatus raw_metadata_status = metadataStatus(info);
-    if ( raw_metadata_status.empty() )
+    job_r.rawStatus = metadataStatus(info);
+    if ( job_r.rawStatus.empty() )
     {
        /* if there is no cache at this point, we refresh the raw
           in case this is the first time - if it's !autorefresh,
           we may still refresh */
       refreshMetadata(info, RefreshIfNeeded, progressrcv );
-      raw_metadata_status = metadataStatus(info);
+      job_r.rawStatus = metadataStatus(info);
     }
 
     bool needs_cleaning = false;
@@ -1262,7 +1492,7 @@ namespace zypp
       MIL << info.alias() << " is already cached." << endl;
       RepoStatus cache_status = cacheStatus(info);
 
-      if ( cache_status == raw_metadata_status )
+      if ( cache_status == job_r.rawStatus )
       {
         MIL << info.alias() << " cache is up to date with metadata." << endl;
         if ( policy == BuildIfNeeded )
@@ -1271,8 +1501,11 @@ namespace zypp
 	  const Pathname & base = solv_path_for_repoinfo( _options, info);
 	  if ( ! PathInfo(base/"solv.idx").isExist() )
 	    sat::updateSolvFileIndex( base/"solv" );
+	  // Same for a wanted search index.
+	  if ( ZConfig::instance().repo_search_index() && ! PathInfo( sat::SearchIndex::indexFile( base/"solv" ) ).isExist() )
+	    sat::SearchIndex::build( base/"solv", cache_status );
 
-	  return;
+	  return false;
         }
         else {
           MIL << info.alias() << " cache rebuild is forced" << endl;
@@ -1282,12 +1515,6 @@ namespace zypp
       needs_cleaning = true;
     }
 
-    ProgressData progress(100);
-    callback::SendReport<ProgressReport> report;
-    progress.sendTo( ProgressReportAdaptor( progressrcv, report ) );
-    progress.name(str::form(_("Building repository '%s' cache"), info.label().c_str()));
-    progress.toMin();
-
     if (needs_cleaning)
     {
       cleanCache(info);
@@ -1308,23 +1535,37 @@ namespace zypp
       Exception ex(str::form( _("Can't create cache at %s - no writing permissions."), base.c_str()) );
       ZYPP_THROW(ex);
     }
-    Pathname solvfile = base / "solv";
+    job_r.solvfile = base / "solv";
 
     // do we have type?
-    repo::RepoType repokind = info.type();
+    job_r.repokind = info.type();
 
     // if the type is unknown, try probing.
-    switch ( repokind.toEnum() )
+    switch ( job_r.repokind.toEnum() )
     {
       case RepoType::NONE_e:
         // unknown, probe the local metadata
-        repokind = probeCache( productdatapath );
+        job_r.repokind = probeCache( job_r.productdatapath );
       break;
       default:
       break;
     }
 
-    MIL << "repo type is " << repokind << endl;
+    MIL << "repo type is " << job_r.repokind << endl;
+    return true;
+  }
+
+  void RepoManager::Impl::buildCacheCommit( CacheBuildJob & job_r, const ProgressData::ReceiverFnc & progressrcv )
+  {
+    const RepoInfo & info( job_r.info );
+    const Pathname & solvfile( job_r.solvfile );
+    const repo::RepoType & repokind( job_r.repokind );
+
+    ProgressData progress(100);
+    callback::SendReport<ProgressReport> report;
+    progress.sendTo( ProgressReportAdaptor( progressrcv, report ) );
+    progress.name(str::form(_("Building repository '%s' cache"), info.label().c_str()));
+    progress.toMin();
 
     switch ( repokind.toEnum() )
     {
@@ -1334,49 +1575,63 @@ namespace zypp
       {
         // Take care we unlink the solvfile on exception
         ManagedFile guard( solvfile, filesystem::unlink );
-        scoped_ptr<MediaMounter> forPlainDirs;
 
-        ExternalProgram::Arguments cmd;
-        cmd.push_back( PathInfo( "/usr/bin/repo2solv" ).isFile() ? "repo2solv" : "repo2solv.sh" );
-        // repo2solv expects -o as 1st arg!
-        cmd.push_back( "-o" );
-        cmd.push_back( solvfile.asString() );
-	cmd.push_back( "-X" );	// autogenerate pattern from pattern-package
+        if ( ! job_r.built && job_r.errdetail.empty() && repo::repo2solvSupports( repokind ) )
+          job_r.built = repo::repo2solv( repokind, job_r.productdatapath, solvfile, job_r.errdetail );
 
-        if ( repokind == RepoType::RPMPLAINDIR )
+        if ( ! job_r.built )
         {
-          forPlainDirs.reset( new MediaMounter( *info.baseUrlsBegin() ) );
-          // recusive for plaindir as 2nd arg!
-          cmd.push_back( "-R" );
-          // FIXME this does only work form dir: URLs
-          cmd.push_back( forPlainDirs->getPathName( info.path() ).c_str() );
-        }
-        else
-          cmd.push_back( productdatapath.asString() );
+          if ( ! job_r.errdetail.empty() )
+            WAR << info.alias() << ": building the cache in-process failed, trying repo2solv: " << job_r.errdetail << endl;
+
+          scoped_ptr<MediaMounter> forPlainDirs;
 
-        ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
-        std::string errdetail;
+          ExternalProgram::Arguments cmd;
+          cmd.push_back( PathInfo( "/usr/bin/repo2solv" ).isFile() ? "repo2solv" : "repo2solv.sh" );
+          // repo2solv expects -o as 1st arg!
+          cmd.push_back( "-o" );
+          cmd.push_back( solvfile.asString() );
+          cmd.push_back( "-X" );	// autogenerate pattern from pattern-package
 
-        for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-          WAR << "  " << output;
-          if ( errdetail.empty() ) {
-            errdetail = prog.command();
-            errdetail += '\n';
+          if ( repokind == RepoType::RPMPLAINDIR )
+          {
+            forPlainDirs.reset( new MediaMounter( *info.baseUrlsBegin() ) );
+            // recusive for plaindir as 2nd arg!
+            cmd.push_back( "-R" );
+            // FIXME this does only work form dir: URLs
+            cmd.push_back( forPlainDirs->getPathName( info.path() ).c_str() );
+          }
+          else
+            cmd.push_back( job_r.productdatapath.asString() );
+
+          ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
+          std::string errdetail;
+
+          for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
+            WAR << "  " << output;
+            if ( errdetail.empty() ) {
+              errdetail = prog.command();
+              errdetail += '\n';
+            }
+            errdetail += output;
           }
-          errdetail += output;
-        }
 
-        int ret = prog.close();
-        if ( ret != 0 )
-        {
-          RepoException ex(str::form( _("Failed to cache repo (%d)."), ret ));
-          ex.remember( errdetail );
-          ZYPP_THROW(ex);
+          int ret = prog.close();
+          if ( ret != 0 )
+          {
+            RepoException ex(str::form( _("Failed to cache repo (%d)."), ret ));
+            ex.remember( errdetail );
+            ZYPP_THROW(ex);
+          }
         }
 
         // We keep it.
         guard.resetDispose();
 	sat::updateSolvFileIndex( solvfile );	// content digest for zypper bash completion
+	if ( ZConfig::instance().repo_search_index() )
+	  sat::SearchIndex::build( solvfile, job_r.rawStatus );
+	else
+	  filesystem::unlink( sat::SearchIndex::indexFile( solvfile ) );
       }
       break;
       default:
@@ -1384,11 +1639,92 @@ namespace zypp
       break;
     }
     // update timestamp and checksum
-    setCacheStatus(info, raw_metadata_status);
+    setCacheStatus(info, job_r.rawStatus);
     MIL << "Commit cache.." << endl;
     progress.toMax();
   }
 
+  void RepoManager::Impl::buildCache( const RepoInfo & info, CacheBuildPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
+  {
+    CacheBuildJob job( info );
+    if ( buildCacheSetup( job, policy, progressrcv ) )
+      buildCacheCommit( job, progressrcv );
+  }
+
+  RepoManager::RepoErrors RepoManager::Impl::buildCache( const std::list<RepoInfo> & infos, CacheBuildPolicy policy, unsigned maxParallel, const ProgressData::ReceiverFnc & progressrcv )
+  {
+    // Setup and commit (refresh if needed, cleanup, cookies,...) are done serially,
+    // just the in-process metadata conversion is spread across worker threads.
+    std::list<CacheBuildJob> jobs;
+    std::vector<CacheBuildJob*> convert;
+    RepoErrors errors;
+
+    for ( const RepoInfo & info : infos )
+    {
+      jobs.push_back( CacheBuildJob( info ) );
+      try
+      {
+        if ( ! buildCacheSetup( jobs.back(), policy, progressrcv ) )
+        {
+          jobs.pop_back();
+          continue;
+        }
+        if ( repo::repo2solvSupports( jobs.back().repokind ) )
+          convert.push_back( &jobs.back() );
+      }
+      catch ( const Exception & excpt )
+      {
+        ZYPP_CAUGHT( excpt );
+        rememberRepoError( errors, info, excpt );
+        jobs.pop_back();
+      }
+    }
+
+    if ( ! maxParallel )
+      maxParallel = std::max( 1U, std::thread::hardware_concurrency() );
+    maxParallel = std::min<unsigned>( maxParallel, convert.size() );
+
+    if ( maxParallel > 1 )
+    {
+      MIL << "Building " << convert.size() << " repo caches using " << maxParallel << " threads" << endl;
+      // Workers must neither log nor throw (repo::repo2solv does neither).
+      std::atomic<unsigned> next( 0 );
+      auto worker = [&convert,&next]() {
+        for ( unsigned idx = next++; idx < convert.size(); idx = next++ )
+        {
+          CacheBuildJob & job( *convert[idx] );
+          try
+          { job.built = repo::repo2solv( job.repokind, job.productdatapath, job.solvfile, job.errdetail ); }
+          catch ( ... )
+          { job.errdetail = "unexpected exception"; }
+        }
+      };
+      std::vector<std::thread> threads;
+      for ( unsigned i = 1; i < maxParallel; ++i )
+        threads.push_back( std::thread( worker ) );
+      worker();
+      for ( std::thread & thread : threads )
+        thread.join();
+    }
+
+    for ( CacheBuildJob & job : jobs )
+    {
+      try
+      {
+        buildCacheCommit( job, progressrcv );
+      }
+      catch ( const Exception & excpt )
+      {
+        ZYPP_CAUGHT( excpt );
+        rememberRepoError( errors, job.info, excpt );
+      }
+    }
+
+    MIL << "Cached " << infos.size() - errors.size() << " of " << infos.size() << " repos, "
+        << errors.size() << " failed" << endl;
+    return errors;
+  }
+
   ////////////////////////////////////////////////////////////////////////////
 
 
@@ -1587,6 +1923,7 @@ namespace zypp
         repo.eraseFromPool();
         ZYPP_THROW(Exception(str::Str() << "Solv-file was created by '"<<toolversion<<"'-parser (want "<<LIBSOLV_TOOLVERSION<<")."));
       }
+      sat::SearchIndex::attach( repo, solvfile, cacheStatus( info ) );
     }
     catch ( const Exception & exp )
     {
@@ -1595,7 +1932,8 @@ namespace zypp
       cleanCache( info, progressrcv );
       buildCache( info, BuildIfNeeded, progressrcv );
 
-      sat::Pool::instance().addRepoSolv( solvfile, info );
+      Repository repo = sat::Pool::instance().addRepoSolv( solvfile, info );
+      sat::SearchIndex::attach( repo, solvfile, cacheStatus( info ) );
     }
   }
 
@@ -2558,6 +2896,9 @@ namespace zypp
   void RepoManager::refreshMetadata( const RepoInfo &info, RawMetadataRefreshPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
   { return _pimpl->refreshMetadata( info, policy, progressrcv ); }
 
+  RepoManager::RefreshErrors RepoManager::refreshMetadata( const std::list<RepoInfo> & infos, RawMetadataRefreshPolicy policy, unsigned maxParallel, const ProgressData::ReceiverFnc & progressrcv )
+  { return _pimpl->refreshMetadata( infos, policy, maxParallel, progressrcv ); }
+
   void RepoManager::cleanMetadata( const RepoInfo &info, const ProgressData::ReceiverFnc & progressrcv )
   { return _pimpl->cleanMetadata( info, progressrcv ); }
 
@@ -2570,6 +2911,9 @@ namespace zypp
   void RepoManager::buildCache( const RepoInfo &info, CacheBuildPolicy policy, const ProgressData::ReceiverFnc & progressrcv )
   { return _pimpl->buildCache( info, policy, progressrcv ); }
 
+  RepoManager::RepoErrors RepoManager::buildCache( const std::list<RepoInfo> & infos, CacheBuildPolicy policy, unsigned maxParallel, const ProgressData::ReceiverFnc & progressrcv )
+  { return _pimpl->buildCache( infos, policy, maxParallel, progressrcv ); }
+
   void RepoManager::cleanCache( const RepoInfo &info, const ProgressData::ReceiverFnc & progressrcv )
   { return _pimpl->cleanCache( info, progressrcv ); }
 
@@ -14,6 +14,8 @@
 
 #include <iosfwd>
 #include <list>
+#include <map>
+#include <exception>
 
 #include "zypp/base/PtrTypes.h"
 #include "zypp/base/Iterator.h"
@@ -120,6 +122,13 @@ namespace zypp
     typedef RepoSet::const_iterator RepoConstIterator;
     typedef RepoSet::size_type RepoSizeType;
 
+    /** Errors of the repos processed by a batch operation, by repo alias
+     * (\ref refreshMetadata, \ref buildCache).
+     */
+    typedef std::map<std::string, std::exception_ptr> RepoErrors;
+    /** Errors of a batch \ref refreshMetadata, by repo alias */
+    typedef RepoErrors RefreshErrors;
+
   public:
    RepoManager( const RepoManagerOptions &options = RepoManagerOptions() );
    /** Dtor */
@@ -301,6 +310,28 @@ namespace zypp
                          RawMetadataRefreshPolicy policy = RefreshIfNeeded,
                          const ProgressData::ReceiverFnc & progressrcv = ProgressData::ReceiverFnc() );
 
+   /**
+    * \short Refresh the local raw caches of several repositories
+    *
+    * Like \ref refreshMetadata for each repo in \a infos, but the network
+    * transfers of all repos are overlapped, using up to \a maxParallel
+    * connections (\c 0 uses \ref ZConfig::download_max_parallel_downloads):
+    * First the remote status files of all repos due for a check are
+    * retrieved at once, then the metadata of all repos which changed.
+    * The downloaded metadata are then checked (\ref KeyRing) and stored
+    * per repo, in order.
+    *
+    * All repos are processed even if some of them fail. The exception
+    * \ref refreshMetadata would have thrown is returned for each failed
+    * repo.
+    *
+    * \return The errors by repo alias; empty if all repos were refreshed.
+    */
+   RefreshErrors refreshMetadata( const std::list<RepoInfo> & infos,
+                         RawMetadataRefreshPolicy policy = RefreshIfNeeded,
+                         unsigned maxParallel = 0,
+                         const ProgressData::ReceiverFnc & progressrcv = ProgressData::ReceiverFnc() );
+
    /**
     * \short Clean local metadata
     *
@@ -350,6 +381,24 @@ namespace zypp
                     CacheBuildPolicy policy = BuildIfNeeded,
                     const ProgressData::ReceiverFnc & progressrcv = ProgressData::ReceiverFnc() );
 
+   /**
+    * \short Refresh the local caches of several repositories
+    *
+    * Like \ref buildCache for each repo in \a infos, but the rpm-md and
+    * susetags metadata conversion is done in-process by up to \a maxParallel
+    * worker threads, each using its own libsolv pool (\c 0 uses one per CPU).
+    *
+    * All repos are processed even if some of them fail. The exception
+    * \ref buildCache would have thrown is returned for each failed repo,
+    * like \ref refreshMetadata for several repos does.
+    *
+    * \return The errors by repo alias; empty if all caches were built.
+    */
+   RepoErrors buildCache( const std::list<RepoInfo> & infos,
+                    CacheBuildPolicy policy = BuildIfNeeded,
+                    unsigned maxParallel = 0,
+                    const ProgressData::ReceiverFnc & progressrcv = ProgressData::ReceiverFnc() );
+
    /**
     * \short clean local cache
     *
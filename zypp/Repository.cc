@@ -25,6 +25,7 @@
 #include "zypp/ResPool.h"
 #include "zypp/Product.h"
 #include "zypp/sat/Pool.h"
+#include "zypp/sat/SearchIndex.h"
 
 using std::endl;
 
@@ -82,6 +83,18 @@ namespace zypp
       return _repo->subpriority;
     }
 
+    sat::detail::SolvableIdType Repository::satInternalSolvableIdBegin() const
+    {
+      NO_REPOSITORY_RETURN( sat::detail::noSolvableId );
+      return _repo->nsolvables ? _repo->start : sat::detail::noSolvableId;
+    }
+
+    sat::detail::SolvableIdType Repository::satInternalSolvableIdEnd() const
+    {
+      NO_REPOSITORY_RETURN( sat::detail::noSolvableId );
+      return _repo->nsolvables ? _repo->end : sat::detail::noSolvableId;
+    }
+
     Repository::ContentRevision Repository::contentRevision() const
     {
       NO_REPOSITORY_RETURN( ContentRevision() );
@@ -298,6 +311,7 @@ namespace zypp
     {
 	NO_REPOSITORY_RETURN();
         MIL << *this << " removed from pool" << endl;
+	sat::SearchIndex::detach( *this );	// libsolv reuses the repo
 	myPool()._deleteRepo( _repo );
 	_id = sat::detail::noRepoId;
     }
@@ -316,6 +316,14 @@ namespace zypp
         int satInternalPriority() const;
         int satInternalSubPriority() const;
         //@}
+        /** libsolv internal solvable id range <tt>[begin,end)</tt> occupied by the repo.
+         * The range may contain ids of solvables belonging to other repos.
+         * An empty range if the repo has no solvables.
+         */
+        //@{
+        sat::detail::SolvableIdType satInternalSolvableIdBegin() const;
+        sat::detail::SolvableIdType satInternalSolvableIdEnd() const;
+        //@}
 
     private:
         IdType _id;
@@ -36,6 +36,12 @@ namespace zypp
     return _val;
   }
 
+  pool::PoolImpl & pool::PoolImpl::instance()
+  {
+    static PoolImpl & _val( *ResPool::instance()._pimpl );
+    return _val;
+  }
+
   ///////////////////////////////////////////////////////////////////
   //
   //	METHOD NAME : ResPool::ResPool
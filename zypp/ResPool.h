@@ -415,6 +415,7 @@ namespace zypp
       const pool::PoolTraits::Id2ItemT & id2item() const;
 
     private:
+      friend class pool::PoolImpl;	// PoolImpl::instance
       /** Ctor */
       ResPool( pool::PoolTraits::Impl_Ptr impl_r );
       /** Access to implementation. */
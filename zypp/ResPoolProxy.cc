@@ -30,10 +30,7 @@ namespace zypp
   struct PoolItemSaver
   {
     void saveState( ResPool pool_r )
-    {
-      std::for_each( pool_r.begin(), pool_r.end(),
-                     std::mem_fun_ref(&PoolItem::saveState) );
-    }
+    { pool::PoolImpl::instance().saveState(); }
 
     void saveState( ResPool pool_r, const ResKind & kind_r )
     {
@@ -42,10 +39,7 @@ namespace zypp
     }
 
     void restoreState( ResPool pool_r )
-    {
-      std::for_each( pool_r.begin(), pool_r.end(),
-                     std::mem_fun_ref(&PoolItem::restoreState) );
-    }
+    { pool::PoolImpl::instance().restoreState(); }
 
     void restoreState( ResPool pool_r, const ResKind & kind_r )
     {
@@ -54,11 +48,7 @@ namespace zypp
     }
 
     bool diffState( ResPool pool_r ) const
-    {
-      // return whether some PoolItem::sameState reported \c false.
-      return( invokeOnEach( pool_r.begin(), pool_r.end(),
-                            std::mem_fun_ref(&PoolItem::sameState) ) < 0 );
-    }
+    { return pool::PoolImpl::instance().diffState(); }
 
     bool diffState( ResPool pool_r, const ResKind & kind_r ) const
     {
@@ -70,14 +60,11 @@ namespace zypp
 
   namespace
   {
-    ui::Selectable::Ptr makeSelectablePtr( pool::PoolImpl::Id2ItemT::const_iterator begin_r,
-                                           pool::PoolImpl::Id2ItemT::const_iterator end_r )
+    ui::Selectable::Ptr makeSelectablePtr( std::vector<PoolItem>::const_iterator begin_r,
+                                           std::vector<PoolItem>::const_iterator end_r )
     {
-      pool::PoolTraits::byIdent_iterator begin( begin_r, pool::PoolTraits::Id2ItemValueSelector() );
-      pool::PoolTraits::byIdent_iterator end( end_r, pool::PoolTraits::Id2ItemValueSelector() );
-      sat::Solvable solv( begin->satSolvable() );
-
-      return new ui::Selectable( ui::Selectable::Impl_Ptr( new ui::Selectable::Impl( solv.kind(), solv.name(), begin, end ) ) );
+      sat::Solvable solv( begin_r->satSolvable() );
+      return new ui::Selectable( ui::Selectable::Impl_Ptr( new ui::Selectable::Impl( solv.kind(), solv.name(), begin_r, end_r ) ) );
     }
   } // namespace
 
@@ -86,7 +73,11 @@ namespace zypp
   //	CLASS NAME : ResPoolProxy::Impl
   //
   /** ResPoolProxy implementation.
-   * \todo Seedup as it is still using old index
+   *
+   * Building a \ref ui::Selectable is not cheap, and callers often need
+   * just a few of them (\ref lookup). So the pools items are kept in a
+   * compact table grouped by ident, and Selectables are created on first
+   * access. Iterating a kind creates all Selectables of that kind.
   */
   struct ResPoolProxy::Impl
   {
@@ -96,73 +87,73 @@ namespace zypp
     typedef std::unordered_map<sat::detail::IdType,ui::Selectable::Ptr> SelectableIndex;
     typedef ResPoolProxy::const_iterator const_iterator;
 
+    /** An idents items in \ref _items: [_begin,_end) */
+    struct IdentRange
+    {
+      ResKind _kind;
+      unsigned _begin;
+      unsigned _end;
+    };
+    typedef std::unordered_map<sat::detail::IdType,IdentRange> IdentIndex;
+    typedef std::map<ResKind,SelectablePool> KindPool;
+
   public:
     Impl()
     :_pool( ResPool::instance() )
+    , _allCreated( true )
     {}
 
     Impl( ResPool pool_r, const pool::PoolImpl & poolImpl_r )
     : _pool( pool_r )
+    , _allCreated( false )
+    { buildIndex( poolImpl_r.id2item() ); }
+
+    Impl( const Impl & proxy_r, const std::unordered_set<sat::detail::IdType> & changedIdents_r, const pool::PoolImpl & poolImpl_r )
+    : _pool( proxy_r._pool )
+    , _allCreated( false )
     {
-      const pool::PoolImpl::Id2ItemT & id2item( poolImpl_r.id2item() );
-      if ( ! id2item.empty() )
+      buildIndex( poolImpl_r.id2item() );
+      // take over the Selectables already created for unchanged idents
+      for_( it, proxy_r._selIndex.begin(), proxy_r._selIndex.end() )
       {
-        // set startpoint
-        pool::PoolImpl::Id2ItemT::const_iterator cbegin = id2item.begin();
-
-        for_( it, id2item.begin(), id2item.end() )
-        {
-          if ( it->first != cbegin->first )
-          {
-            // starting a new Selectable, create the previous one
-            ui::Selectable::Ptr p( makeSelectablePtr( cbegin, it ) );
-            _selPool.insert( SelectablePool::value_type( p->kind(), p ) );
-            _selIndex[cbegin->first] = p;
-            // remember new startpoint
-            cbegin = it;
-          }
-        }
-        // create the final one
-        ui::Selectable::Ptr p( makeSelectablePtr( cbegin, id2item.end() ) );
-        _selPool.insert( SelectablePool::value_type( p->kind(), p ) );
-        _selIndex[cbegin->first] = p;
+        if ( ! changedIdents_r.count( it->first ) )
+          _selIndex.insert( *it );
       }
+      MIL << "Rebuilt " << changedIdents_r.size() << " of " << _identIndex.size() << " Selectables" << endl;
     }
 
   public:
     ui::Selectable::Ptr lookup( const pool::ByIdent & ident_r ) const
-    {
-      SelectableIndex::const_iterator it( _selIndex.find( ident_r.get() ) );
-      if ( it != _selIndex.end() )
-        return it->second;
-      return ui::Selectable::Ptr();
-    }
+    { return selectable( ident_r.get() ); }
 
   public:
     bool empty() const
-    { return _selPool.empty(); }
+    { return _identIndex.empty(); }
 
     size_type size() const
-    { return _selPool.size(); }
+    { return _identIndex.size(); }
 
     const_iterator begin() const
-    { return make_map_value_begin( _selPool ); }
+    { createAll(); return make_map_value_begin( _selPool ); }
 
     const_iterator end() const
-    { return make_map_value_end( _selPool ); }
+    { createAll(); return make_map_value_end( _selPool ); }
 
   public:
     bool empty( const ResKind & kind_r ) const
-    { return( _selPool.count( kind_r ) == 0 );  }
+    { return( size( kind_r ) == 0 );  }
 
     size_type size( const ResKind & kind_r ) const
-    { return _selPool.count( kind_r ); }
+    {
+      std::map<ResKind,size_type>::const_iterator it( _kindSize.find( kind_r ) );
+      return( it == _kindSize.end() ? 0 : it->second );
+    }
 
     const_iterator byKindBegin( const ResKind & kind_r ) const
-    { return make_map_value_lower_bound( _selPool, kind_r ); }
+    { return make_map_value_begin( kindPool( kind_r ) ); }
 
     const_iterator byKindEnd( const ResKind & kind_r ) const
-    { return make_map_value_upper_bound( _selPool, kind_r ); }
+    { return make_map_value_end( kindPool( kind_r ) ); }
 
   public:
     size_type knownRepositoriesSize() const
@@ -194,10 +185,80 @@ namespace zypp
     bool diffState( const ResKind & kind_r ) const
     { return PoolItemSaver().diffState( _pool, kind_r ); }
 
+  private:
+    /** Fill \ref _items and \ref _identIndex (equal keys are adjacent in \a id2item_r). */
+    void buildIndex( const pool::PoolImpl::Id2ItemT & id2item_r )
+    {
+      _items.reserve( id2item_r.size() );
+      _identIndex.reserve( id2item_r.size() / 2 );
+      for ( pool::PoolImpl::Id2ItemT::const_iterator it = id2item_r.begin(); it != id2item_r.end(); )
+      {
+        sat::detail::IdType key = it->first;
+        IdentRange range = { it->second.satSolvable().kind(), unsigned(_items.size()), 0 };
+        for ( ; it != id2item_r.end() && it->first == key; ++it )
+          _items.push_back( it->second );
+        range._end = _items.size();
+        _identIndex[key] = range;
+        ++_kindSize[range._kind];
+      }
+    }
+
+    /** The Selectable for \a key_r (created on demand). */
+    ui::Selectable::Ptr selectable( sat::detail::IdType key_r ) const
+    {
+      SelectableIndex::const_iterator sit( _selIndex.find( key_r ) );
+      if ( sit != _selIndex.end() )
+        return sit->second;
+
+      IdentIndex::const_iterator it( _identIndex.find( key_r ) );
+      if ( it == _identIndex.end() )
+        return ui::Selectable::Ptr();
+      ui::Selectable::Ptr p( makeSelectablePtr( _items.begin() + it->second._begin, _items.begin() + it->second._end ) );
+      _selIndex[key_r] = p;
+      return p;
+    }
+
+    /** The Selectables of \a kind_r.
+     * Each kind has a container of its own, filled at once on first use,
+     * so iterators handed out stay valid when further kinds are created.
+     */
+    const SelectablePool & kindPool( const ResKind & kind_r ) const
+    {
+      std::pair<KindPool::iterator,bool> res( _kindPool.insert( KindPool::value_type( kind_r, SelectablePool() ) ) );
+      if ( res.second )
+      {
+        for_( it, _identIndex.begin(), _identIndex.end() )
+        {
+          if ( it->second._kind == kind_r )
+            res.first->second.insert( SelectablePool::value_type( kind_r, selectable( it->first ) ) );
+        }
+      }
+      return res.first->second;
+    }
+
+    /** Create all Selectables and add them to \ref _selPool at once. */
+    void createAll() const
+    {
+      if ( _allCreated )
+        return;
+      for_( it, _identIndex.begin(), _identIndex.end() )
+        _selPool.insert( SelectablePool::value_type( it->second._kind, selectable( it->first ) ) );
+      _allCreated = true;
+    }
+
   private:
     ResPool _pool;
-    mutable SelectablePool _selPool;
+    /** The pools items grouped by ident. */
+    std::vector<PoolItem> _items;
+    IdentIndex _identIndex;
+    std::map<ResKind,size_type> _kindSize;
+    /** Selectables created so far. */
     mutable SelectableIndex _selIndex;
+    /** All Selectables (once iterated). */
+    mutable SelectablePool _selPool;
+    mutable bool _allCreated;
+    /** Selectables of the kinds iterated so far. */
+    mutable KindPool _kindPool;
 
   public:
     /** Offer default Impl. */
@@ -258,6 +319,10 @@ namespace zypp
   : _pimpl( new Impl( pool_r, poolImpl_r ) )
   {}
 
+  ResPoolProxy::ResPoolProxy( const ResPoolProxy & proxy_r, const std::unordered_set<sat::detail::IdType> & changedIdents_r, const pool::PoolImpl & poolImpl_r )
+  : _pimpl( new Impl( *proxy_r._pimpl, changedIdents_r, poolImpl_r ) )
+  {}
+
   ///////////////////////////////////////////////////////////////////
   //
   //	METHOD NAME : ResPoolProxy::~ResPoolProxy
@@ -13,6 +13,7 @@
 #define ZYPP_RESPOOLPROXY_H
 
 #include <iosfwd>
+#include <unordered_set>
 
 #include "zypp/base/PtrTypes.h"
 
@@ -247,6 +248,8 @@ namespace zypp
     friend class pool::PoolImpl;
     /** Ctor */
     ResPoolProxy( ResPool pool_r, const pool::PoolImpl & poolImpl_r );
+    /** Ctor updating \a proxy_r: Selectables for \a changedIdents_r are rebuilt, all others are taken over. */
+    ResPoolProxy( const ResPoolProxy & proxy_r, const std::unordered_set<sat::detail::IdType> & changedIdents_r, const pool::PoolImpl & poolImpl_r );
     /** Pointer to implementation */
     RW_pointer<Impl> _pimpl;
   };
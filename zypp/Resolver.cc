@@ -145,6 +145,9 @@ namespace zypp
   std::list<PoolItem> Resolver::problematicUpdateItems() const
   { return _pimpl->problematicUpdateItems(); }
 
+  const solver::detail::SolverStatistics & Resolver::statistics() const
+  { return _pimpl->statistics(); }
+
   bool Resolver::createSolverTestcase( const std::string & dumpPath, bool runSolver )
   {
     solver::detail::Testcase testcase (dumpPath);
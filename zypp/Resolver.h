@@ -153,6 +153,12 @@ namespace zypp
      **/
     std::list<PoolItem> problematicUpdateItems() const;
 
+    /**
+     * Timing and result counts of the last solver run
+     * (time spent in the solver and applying its result to the pool).
+     **/
+    const solver::detail::SolverStatistics & statistics() const;
+
     /**
      * Return the dependency problems found by the last call to
      * resolveDependencies(). If there were no problems, the returned
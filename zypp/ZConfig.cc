@@ -313,6 +313,7 @@ namespace zypp
         , repo_add_probe          	( false )
         , repo_refresh_delay      	( 10 )
         , repoLabelIsAlias              ( false )
+        , repo_search_index             ( false )
         , download_use_deltarpm   	( true )
         , download_use_deltarpm_always  ( false )
         , download_media_prefer_download( true )
@@ -322,6 +323,8 @@ namespace zypp
         , download_max_download_speed	( 0 )
         , download_max_silent_tries	( 5 )
         , download_transfer_timeout	( 180 )
+        , download_max_parallel_downloads( 5 )
+        , download_max_parallel_deltas	( 0 )
         , commit_downloadMode		( DownloadDefault )
 	, gpgCheck			( true )
 	, repoGpgCheck			( indeterminate )
@@ -426,6 +429,10 @@ namespace zypp
 		  repoRefreshLocales.insert( make_transform_iterator( tmp.begin(), transform ),
 					     make_transform_iterator( tmp.end(), transform ) );
 		}
+                else if ( entry == "repo.search.index" )
+                {
+                  repo_search_index = str::strToBool( value, repo_search_index );
+                }
                 else if ( entry == "download.use_deltarpm" )
                 {
                   download_use_deltarpm = str::strToBool( value, download_use_deltarpm );
@@ -466,6 +473,16 @@ namespace zypp
 		  if ( download_transfer_timeout < 0 )		download_transfer_timeout = 0;
 		  else if ( download_transfer_timeout > 3600 )	download_transfer_timeout = 3600;
                 }
+                else if ( entry == "download.max_parallel_downloads" )
+                {
+                  str::strtonum(value, download_max_parallel_downloads);
+		  if ( download_max_parallel_downloads < 1 )	download_max_parallel_downloads = 1;
+                }
+                else if ( entry == "download.max_parallel_deltas" )
+                {
+                  str::strtonum(value, download_max_parallel_deltas);
+		  if ( download_max_parallel_deltas < 0 )	download_max_parallel_deltas = 0;
+                }
                 else if ( entry == "commit.downloadMode" )
                 {
                   commit_downloadMode.set( deserializeDownloadMode( value ) );
@@ -637,6 +654,7 @@ namespace zypp
     unsigned	repo_refresh_delay;
     LocaleSet	repoRefreshLocales;
     bool	repoLabelIsAlias;
+    bool	repo_search_index;
 
     bool download_use_deltarpm;
     bool download_use_deltarpm_always;
@@ -648,6 +666,8 @@ namespace zypp
     int download_max_download_speed;
     int download_max_silent_tries;
     int download_transfer_timeout;
+    int download_max_parallel_downloads;
+    int download_max_parallel_deltas;
 
     Option<DownloadMode> commit_downloadMode;
 
@@ -957,6 +977,9 @@ namespace zypp
   LocaleSet ZConfig::repoRefreshLocales() const
   { return _pimpl->repoRefreshLocales.empty() ? Target::requestedLocales("") :_pimpl->repoRefreshLocales; }
 
+  bool ZConfig::repo_search_index() const
+  { return _pimpl->repo_search_index; }
+
   bool ZConfig::repoLabelIsAlias() const
   { return _pimpl->repoLabelIsAlias; }
 
@@ -993,6 +1016,12 @@ namespace zypp
   long ZConfig::download_transfer_timeout() const
   { return _pimpl->download_transfer_timeout; }
 
+  long ZConfig::download_max_parallel_downloads() const
+  { return _pimpl->download_max_parallel_downloads; }
+
+  long ZConfig::download_max_parallel_deltas() const
+  { return _pimpl->download_max_parallel_deltas; }
+
   Pathname ZConfig::download_mediaMountdir() const		{ return _pimpl->download_mediaMountdir; }
   void ZConfig::set_download_mediaMountdir( Pathname newval_r )	{ _pimpl->download_mediaMountdir.set( std::move(newval_r) ); }
   void ZConfig::set_default_download_mediaMountdir()		{ _pimpl->download_mediaMountdir.restoreToDefault(); }
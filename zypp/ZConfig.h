@@ -187,6 +187,13 @@ namespace zypp
        */
       LocaleSet repoRefreshLocales() const;
 
+      /**
+       * Whether to build a \ref sat::SearchIndex along with the repositories solv files.
+       / config option
+       * repo.search.index
+       */
+      bool repo_search_index() const;
+
       /**
        * Whether to use repository alias or name in user messages (progress,
        * exceptions, ...).
@@ -229,6 +236,22 @@ namespace zypp
        */
       long download_transfer_timeout() const;
 
+      /**
+       * Maximum number of files downloaded in parallel from the same
+       * host (e.g. when preloading the package cache before commit).
+       * Config option <tt>download.max_parallel_downloads (5)</tt>
+       * A value of \c 1 disables parallel downloads.
+       */
+      long download_max_parallel_downloads() const;
+
+      /**
+       * Maximum number of deltarpms applied in parallel (in the background
+       * while other packages are downloaded).
+       * Config option <tt>download.max_parallel_deltas (0)</tt>
+       * A value of \c 0 means one per cpu.
+       */
+      long download_max_parallel_deltas() const;
+
 
       /** Whether to consider using a deltarpm when downloading a package.
        * Config option <tt>download.use_deltarpm (true)</tt>
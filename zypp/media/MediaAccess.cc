@@ -40,6 +40,50 @@ using namespace std;
 namespace zypp {
   namespace media {
 
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  /** Whether to use \ref MediaMultiCurl for a downloading \a url_r
+   * (url query param \c mediahandler, $ZYPP_MULTICURL).
+   */
+  bool useMultiCurl( const Url & url_r, bool log_r )
+  {
+    bool use_multicurl = true;
+    string urlmediahandler ( url_r.getQueryParam("mediahandler") );
+    if ( urlmediahandler == "multicurl" )
+    {
+      use_multicurl = true;
+    }
+    else if ( urlmediahandler == "curl" )
+    {
+      use_multicurl = false;
+    }
+    else
+    {
+      if ( log_r && ! urlmediahandler.empty() )
+      {
+        WAR << "unknown mediahandler set: " << urlmediahandler << endl;
+      }
+      const char *multicurlenv = getenv( "ZYPP_MULTICURL" );
+      // if user disabled it manually
+      if ( use_multicurl && multicurlenv && ( strcmp(multicurlenv, "0" ) == 0 ) )
+      {
+          if ( log_r )
+            WAR << "multicurl manually disabled." << endl;
+          use_multicurl = false;
+      }
+      else if ( !use_multicurl && multicurlenv && ( strcmp(multicurlenv, "1" ) == 0 ) )
+      {
+          if ( log_r )
+            WAR << "multicurl manually enabled." << endl;
+          use_multicurl = true;
+      }
+    }
+    return use_multicurl;
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
 ///////////////////////////////////////////////////////////////////
 //
 //	CLASS NAME : MediaAccess
@@ -48,6 +92,13 @@ namespace zypp {
 
 const Pathname MediaAccess::_noPath; // empty path
 
+bool MediaAccess::usesMultiCurl( const Url & url_r )
+{
+  const std::string & scheme( url_r.getScheme() );
+  return ( scheme == "ftp" || scheme == "tftp" || scheme == "http" || scheme == "https" )
+      && useMultiCurl( url_r, false );
+}
+
 ///////////////////////////////////////////////////////////////////
 // constructor
 MediaAccess::MediaAccess ()
@@ -134,35 +185,7 @@ MediaAccess::open (const Url& o_url, const Pathname & preferred_attach_point)
 	_handler = new MediaCIFS (url,preferred_attach_point);
     else if (scheme == "ftp" || scheme == "tftp" || scheme == "http" || scheme == "https")
     {
-        bool use_multicurl = true;
-        string urlmediahandler ( url.getQueryParam("mediahandler") );
-        if ( urlmediahandler == "multicurl" )
-        {
-          use_multicurl = true;
-        }
-        else if ( urlmediahandler == "curl" )
-        {
-          use_multicurl = false;
-        }
-        else
-        {
-          if ( ! urlmediahandler.empty() )
-          {
-            WAR << "unknown mediahandler set: " << urlmediahandler << endl;
-          }
-          const char *multicurlenv = getenv( "ZYPP_MULTICURL" );
-          // if user disabled it manually
-          if ( use_multicurl && multicurlenv && ( strcmp(multicurlenv, "0" ) == 0 ) )
-          {
-              WAR << "multicurl manually disabled." << endl;
-              use_multicurl = false;
-          }
-          else if ( !use_multicurl && multicurlenv && ( strcmp(multicurlenv, "1" ) == 0 ) )
-          {
-              WAR << "multicurl manually enabled." << endl;
-              use_multicurl = true;
-          }
-        }
+        bool use_multicurl = useMultiCurl( url, true );
 
         MediaCurl *curl;
 
@@ -356,6 +379,26 @@ MediaAccess::setDeltafile( const Pathname & filename ) const
   _handler->setDeltafile( filename );
 }
 
+void
+MediaAccess::setDownloadDigest( const std::string & type ) const
+{
+  if ( !_handler ) {
+    ZYPP_THROW(MediaNotOpenException("setDownloadDigest(" + type + ")"));
+  }
+
+  _handler->setDownloadDigest( type );
+}
+
+void
+MediaAccess::prefetchFiles( const std::list<Pathname> & filenames ) const
+{
+  if ( !_handler ) {
+    ZYPP_THROW(MediaNotOpenException("prefetchFiles()"));
+  }
+
+  _handler->prefetchFiles( filenames );
+}
+
 void
 MediaAccess::releaseFile( const Pathname & filename ) const
 {
@@ -105,6 +105,12 @@ namespace zypp {
 	 */
 	bool        downloads() const;
 
+	/**
+	 * Whether \a url_r would be opened by \ref MediaMultiCurl, which
+	 * is able to follow metalinks (and to reuse blocks of a deltafile).
+	 */
+	static bool usesMultiCurl( const Url & url_r );
+
 	/**
 	 * Used Protocol if media is opened, otherwise 'unknown'.
 	 **/
@@ -279,6 +285,19 @@ namespace zypp {
 	 */
 	void setDeltafile( const Pathname & filename ) const;
 
+	/**
+	 * set the digest type to compute while downloading the next file
+	 */
+	void setDownloadDigest( const std::string & type ) const;
+
+	/**
+	 * Hint that the files will be requested soon. Downloading
+	 * handlers may retrieve them in advance (concurrently).
+	 *
+	 * \throws MediaException
+	 **/
+	void prefetchFiles( const std::list<Pathname> & filenames ) const;
+
     public:
 
 	/**
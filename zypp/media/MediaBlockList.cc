@@ -11,14 +11,23 @@
  */
 
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <expat.h>
 
 #include <vector>
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 #include "zypp/media/MediaBlockList.h"
 #include "zypp/base/Logger.h"
@@ -30,6 +39,9 @@ using namespace zypp::base;
 namespace zypp {
   namespace media {
 
+// files larger than this are scanned by several threads (one region each)
+#define SCANREGION	(32 * 1024 * 1024)
+
 MediaBlockList::MediaBlockList(off_t size)
 {
   filesize = size;
@@ -245,188 +257,312 @@ MediaBlockList::writeBlock(size_t blkno, FILE *fp, const unsigned char *buf, siz
   found[blocks.size()] = true;
 }
 
-static size_t
-fetchnext(FILE *fp, unsigned char *bp, size_t blksize, size_t pushback, unsigned char *pushbackp)
+///////////////////////////////////////////////////////////////////
+// rolling checksum scan
+///////////////////////////////////////////////////////////////////
+
+// the rsums of all blocks of the scan blocksize, for lookup while scanning
+struct MediaBlockList::RsumIndex
 {
-  size_t l = blksize;
-  int c;
+  typedef std::pair<unsigned int, size_t> Entry;	// (rsum, blkno)
 
-  if (pushback)
-    {
-      if (pushbackp != bp)
-        memmove(bp, pushbackp, pushback);
-      bp += pushback;
-      l -= pushback;
-    }
-  while (l)
-    {
-      c = getc(fp);
-      if (c == EOF)
-        break;
-      *bp++ = c;
-      l--;
-    }
-  if (l)
-    memset(bp, 0, l);
-  return blksize - l;
+  RsumIndex(const MediaBlockList &bl, size_t blksize)
+  {
+    size_t nblks = bl.blocks.size();
+    for (size_t i = 0; i < bl.rsums.size(); i++)
+      {
+	if (bl.blocks[i].size != blksize && (i != nblks - 1 || bl.rsumpad != blksize))
+	  continue;
+	entries.push_back(Entry(bl.rsums[i], i));
+      }
+    // A bit filter with about 32 bits per rsum rejects most positions with
+    // a single (cache friendly) bit test. The hits are looked up in a hash
+    // table of about 4 buckets per rsum.
+    fbits = 16;
+    while (fbits < 30 && (size_t(1) << fbits) < entries.size() * 32)
+      fbits++;
+    tbits = 10;
+    while (tbits < 28 && (size_t(1) << tbits) < entries.size() * 4)
+      tbits++;
+    filter.resize((size_t(1) << fbits) / 64);
+    for (size_t i = 0; i < entries.size(); i++)
+      {
+	unsigned int h = hash(entries[i].first, fbits);
+	filter[h >> 6] |= uint64_t(1) << (h & 63);
+      }
+    // entries ordered by bucket, within a bucket by blkno
+    unsigned int tb = tbits;
+    std::stable_sort(entries.begin(), entries.end(), [tb](const Entry &lhs, const Entry &rhs) {
+      return hash(lhs.first, tb) < hash(rhs.first, tb);
+    });
+    buckets.resize((size_t(1) << tbits) + 1);
+    size_t e = 0;
+    for (size_t h = 0; h < buckets.size(); h++)
+      {
+	buckets[h] = e;
+	while (e < entries.size() && hash(entries[e].first, tbits) == h)
+	  e++;
+      }
+  }
+
+  static inline unsigned int hash(unsigned int r, unsigned int bits)
+  { return (r * 2654435761U) >> (32 - bits); }
+
+  inline bool maybe(unsigned int r) const
+  {
+    unsigned int h = hash(r, fbits);
+    return filter[h >> 6] & (uint64_t(1) << (h & 63));
+  }
+
+  // the entries in the bucket of r (they may still have a different rsum)
+  inline const Entry *bucketBegin(unsigned int r) const
+  { return &entries[0] + buckets[hash(r, tbits)]; }
+  inline const Entry *bucketEnd(unsigned int r) const
+  { return &entries[0] + buckets[hash(r, tbits) + 1]; }
+
+  std::vector<Entry> entries;
+  std::vector<uint32_t> buckets;
+  std::vector<uint64_t> filter;
+  unsigned int fbits;
+  unsigned int tbits;
+};
+
+// the rsum of a window the way it is stored in the blocklist
+static inline unsigned int
+rsumKey(unsigned short a, unsigned short b, int rsumlen)
+{
+  if (rsumlen == 1)
+    return (unsigned int)b & 255;
+  if (rsumlen == 2)
+    return (unsigned int)b;
+  if (rsumlen == 3)
+    return ((unsigned int)a & 255) << 16 | (unsigned int)b;
+  return (unsigned int)a << 16 | (unsigned int)b;
 }
 
+#define RSUMBATCH 256
 
+// Check the windows starting at data[0..npos) for blocks of size blksize.
+// data must provide avail >= npos + blksize - 1 bytes. Verified blocks are
+// appended to matches. This is called from worker threads and must neither
+// log nor throw.
 void
-MediaBlockList::reuseBlocks(FILE *wfp, string filename)
+MediaBlockList::scanRsums(const unsigned char *data, size_t avail, size_t npos, size_t blksize, int sql, const RsumIndex &idx, vector<bool> &found, vector<pair<size_t, const unsigned char *> > &matches) const
 {
-  FILE *fp;
-
-  if (!chksumlen || (fp = fopen(filename.c_str(), "r")) == 0)
-    return;
   size_t nblks = blocks.size();
-  vector<bool> found;
-  found.resize(nblks + 1);
-  if (rsumlen && !rsums.empty())
+  unsigned short mul = (unsigned short)blksize;
+  unsigned short delta[RSUMBATCH], oldm[RSUMBATCH];
+  unsigned int keys[RSUMBATCH];
+  unsigned short a = 0, b = 0;
+  size_t p = 0;
+  bool init = true;
+  while (p < npos)
     {
-      size_t blksize = blocks[0].size;
-      if (nblks == 1 && rsumpad && rsumpad > blksize)
-	blksize = rsumpad;
-      // create hash of checksums
-      unsigned int hm = rsums.size() * 2;
-      while (hm & (hm - 1))
-	hm &= hm - 1;
-      hm = hm * 2 - 1;
-      if (hm < 16383)
-	hm = 16383;
-      unsigned int *ht = new unsigned int[hm + 1];
-      memset(ht, 0, (hm + 1) * sizeof(unsigned int));
-      for (unsigned int i = 0; i < rsums.size(); i++)
+      if (init)
 	{
-	  if (blocks[i].size != blksize && (i != nblks - 1 || rsumpad != blksize))
-	    continue;
-	  unsigned int r = rsums[i];
-	  unsigned int h = r & hm;
-	  unsigned int hh = 7;
-	  while (ht[h])
-	    h = (h + hh++) & hm;
-	  ht[h] = i + 1;
+	  // (re)start at window p
+	  a = b = 0;
+	  for (size_t k = 0; k < blksize; k++)
+	    {
+	      a += data[p + k];
+	      b += a;
+	    }
+	  init = false;
+	}
+      // Compute the keys of the next batch of windows. The byte wise
+      // loops are free of dependencies, so the compiler vectorizes them;
+      // only the two running sums are left to the sequential loop.
+      size_t n = npos - p > RSUMBATCH ? RSUMBATCH : npos - p;
+      const unsigned char *in = data + p;
+      const unsigned char *out = data + p + blksize;
+      size_t nroll = p + n < npos ? n : n - 1;	// no roll beyond the last window
+      for (size_t k = 0; k < nroll; k++)
+	{
+	  delta[k] = (unsigned short)out[k] - (unsigned short)in[k];
+	  oldm[k] = (unsigned short)in[k] * mul;
+	}
+      keys[0] = rsumKey(a, b, rsumlen);
+      for (size_t k = 0; k < nroll; k++)
+	{
+	  a += delta[k];
+	  b += a - oldm[k];
+	  if (k + 1 < n)
+	    keys[k + 1] = rsumKey(a, b, rsumlen);
 	}
 
-      unsigned char *buf = new unsigned char[blksize];
-      unsigned char *buf2 = new unsigned char[blksize];
-      size_t pushback = 0;
-      unsigned char *pushbackp = 0;
-      int bshift = 0;
-      if ((blksize & (blksize - 1)) == 0)
-	for (bshift = 0; size_t(1 << bshift) != blksize; bshift++)
-	  ;
-      unsigned short a, b;
-      a = b = 0;
-      memset(buf, 0, blksize);
-      bool eof = 0;
-      bool init = 1;
-      int sql = nblks > 1 && chksumlen < 16 ? 2 : 1;
-      while (!eof)
+      size_t k = 0;
+      for (; k < n; k++)
 	{
-	  for (size_t i = 0; i < blksize; i++)
+	  if (!idx.maybe(keys[k]))
+	    continue;
+	  size_t pos = p + k;
+	  size_t next = 0;	// where to continue after a match
+	  const RsumIndex::Entry *end = idx.bucketEnd(keys[k]);
+	  for (const RsumIndex::Entry *it = idx.bucketBegin(keys[k]); it != end; ++it)
 	    {
-	      int c;
-	      if (eof)
-		c = 0;
-	      else
+	      size_t blkno = it->second;
+	      if (it->first != keys[k] || found[blkno])
+		continue;
+	      if (sql == 2)
 		{
-		   if (pushback)
-		    {
-		      c = *pushbackp++;
-		      pushback--;
-		    }
-		  else
-		    c = getc(fp);
-		  if (c == EOF)
-		    {
-		      eof = true;
-		      c = 0;
-		      if (!i || sql == 2)
-			break;
-		    }
+		  if (blkno + 1 >= nblks || pos + blksize + blocks[blkno + 1].size > avail)
+		    continue;
+		  if (!checkRsum(blkno + 1, data + pos + blksize, blocks[blkno + 1].size))
+		    continue;
 		}
-	      int oc = buf[i];
-	      buf[i] = c;
-	      a += c - oc;
-	      if (bshift)
-		b += a - (oc << bshift);
-	      else
-		b += a - oc * blksize;
-	      if (init)
+	      if (!checkChecksum(blkno, data + pos, blksize))
+		continue;
+	      if (sql == 2 && !checkChecksum(blkno + 1, data + pos + blksize, blocks[blkno + 1].size))
+		continue;
+	      found[blkno] = true;
+	      matches.push_back(make_pair(blkno, data + pos));
+	      next = pos + blksize;
+	      if (sql == 2)
 		{
-		  if (size_t(i) != blksize - 1)
-		    continue;
-		  init = 0;
+		  found[++blkno] = true;
+		  matches.push_back(make_pair(blkno, data + next));
+		  next += blocks[blkno].size;
 		}
-	      unsigned int r;
-	      if (rsumlen == 1)
-		r = ((unsigned int)b & 255);
-	      else if (rsumlen == 2)
-		r = ((unsigned int)b & 65535);
-	      else if (rsumlen == 3)
-		r = ((unsigned int)a & 255) << 16 | ((unsigned int)b & 65535);
-	      else
-		r = ((unsigned int)a & 65535) << 16 | ((unsigned int)b & 65535);
-	      unsigned int h = r & hm;
-	      unsigned int hh = 7;
-	      for (; ht[h]; h = (h + hh++) & hm)
+	      // the following blocks are likely to be in place, too
+	      for (blkno++; blkno < nblks && next + blocks[blkno].size <= avail; blkno++)
 		{
-		  size_t blkno = ht[h] - 1;
-		  if (rsums[blkno] != r)
-		    continue;
-		  if (found[blkno])
-		    continue;
-		  if (sql == 2)
-		    {
-		      if (eof || blkno + 1 >= nblks)
-			continue;
-		      pushback = fetchnext(fp, buf2, blksize, pushback, pushbackp);
-		      pushbackp = buf2;
-		      if (!pushback)
-			continue;
-		      if (!checkRsum(blkno + 1, buf2, blksize))
-			continue;
-		    }
-		  if (!checkChecksumRotated(blkno, buf, blksize, i + 1))
-		    continue;
-		  if (sql == 2 && !checkChecksum(blkno + 1, buf2, blksize))
-		    continue;
-		  writeBlock(blkno, wfp, buf, blksize, i + 1, found);
-		  if (sql == 2)
-		    {
-		      writeBlock(blkno + 1, wfp, buf2, blksize, 0, found);
-		      pushback = 0;
-		      blkno++;
-		    }
-		  while (!eof)
-		    {
-		      blkno++;
-		      pushback = fetchnext(fp, buf2, blksize, pushback, pushbackp);
-		      pushbackp = buf2;
-		      if (!pushback)
-			break;
-		      if (!checkRsum(blkno, buf2, blksize))
-			break;
-		      if (!checkChecksum(blkno, buf2, blksize))
-			break;
-		      writeBlock(blkno, wfp, buf2, blksize, 0, found);
-		      pushback = 0;
-		    }
-		  init = false;
-		  memset(buf, 0, blksize);
-	 	  a = b = 0;
-		  i = size_t(-1);	// start with 0 on next iteration
-		  break;
+		  size_t size = blocks[blkno].size;
+		  if (found[blkno] || !checkRsum(blkno, data + next, size) || !checkChecksum(blkno, data + next, size))
+		    break;
+		  found[blkno] = true;
+		  matches.push_back(make_pair(blkno, data + next));
+		  next += size;
 		}
+	      break;
+	    }
+	  if (next)
+	    {
+	      p = next;
+	      init = true;
+	      break;
 	    }
 	}
-      delete[] buf2;
-      delete[] buf;
-      delete[] ht;
+      if (k == n)
+	p += n;
+    }
+}
+
+
+off_t
+MediaBlockList::reuseBlocks(FILE *wfp, string filename, unsigned threads)
+{
+  if (!chksumlen)
+    return 0;
+  size_t nblks = blocks.size();
+  vector<bool> found;
+  found.resize(nblks + 1);
+  if (rsumlen && !rsums.empty())
+    {
+      size_t blksize = blocks[0].size;
+      if (nblks == 1 && rsumpad && rsumpad > blksize)
+	blksize = rsumpad;
+      int sql = nblks > 1 && chksumlen < 16 ? 2 : 1;
+
+      int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd == -1)
+	return 0;
+      struct stat st;
+      if (fstat(fd, &st) || !S_ISREG(st.st_mode) || !st.st_size)
+	{
+	  close(fd);
+	  return 0;
+	}
+      size_t filesize = st.st_size;
+      void *map = mmap(0, filesize, PROT_READ, MAP_PRIVATE, fd, 0);
+      close(fd);
+      if (map == MAP_FAILED)
+	{
+	  WAR << "Can't map " << filename << ": " << strerror(errno) << endl;
+	  return 0;
+	}
+      madvise(map, filesize, MADV_SEQUENTIAL);
+      const unsigned char *data = (const unsigned char *)map;
+
+      RsumIndex idx(*this, blksize);
+      {
+	// set up the digests before going parallel
+	Digest dig;
+	createDigest(dig);
+      }
+
+      struct ScanJob
+      {
+	ScanJob(const unsigned char *data_r, size_t avail_r, size_t npos_r)
+	: data(data_r), avail(avail_r), npos(npos_r)
+	{}
+	const unsigned char *data;
+	size_t avail;
+	size_t npos;
+	vector<bool> found;
+	vector<pair<size_t, const unsigned char *> > matches;
+      };
+      vector<ScanJob> jobs;
+
+      // the windows within the file, split into a region per thread
+      size_t npos = filesize >= blksize ? filesize - blksize + 1 : 0;
+      if (!threads)
+	{
+	  threads = filesize / SCANREGION;
+	  if (threads > std::thread::hardware_concurrency())
+	    threads = std::thread::hardware_concurrency();
+	}
+      if (threads < 1)
+	threads = 1;
+      size_t chunk = (npos + threads - 1) / threads;
+      for (size_t start = 0; start < npos; start += chunk)
+	jobs.push_back(ScanJob(data + start, filesize - start, npos - start > chunk ? chunk : npos - start));
+      // windows reaching beyond the end are zero padded (the last block may be short)
+      vector<unsigned char> tail;
+      if (sql == 1)
+	{
+	  tail.assign(data + npos, data + filesize);
+	  tail.resize(tail.size() + blksize);
+	  jobs.push_back(ScanJob(&tail[0], tail.size(), filesize - npos));
+	}
+
+      std::atomic<unsigned> next(0);
+      auto worker = [&]() {
+	for (unsigned i = next++; i < jobs.size(); i = next++)
+	  {
+	    ScanJob &job = jobs[i];
+	    job.found.resize(nblks + 1);
+	    try
+	      {
+		scanRsums(job.data, job.avail, job.npos, blksize, sql, idx, job.found, job.matches);
+	      }
+	    catch (...)
+	      {}
+	  }
+      };
+      if (threads > jobs.size())
+	threads = jobs.size();
+      std::vector<std::thread> workers;
+      for (unsigned i = 1; i < threads; ++i)
+	workers.push_back(std::thread(worker));
+      worker();
+      for (std::thread &thread : workers)
+	thread.join();
+
+      // regions may have found the same block, write it once
+      for (size_t i = 0; i < jobs.size(); ++i)
+	for (size_t m = 0; m < jobs[i].matches.size(); ++m)
+	  {
+	    size_t blkno = jobs[i].matches[m].first;
+	    if (!found[blkno])
+	      writeBlock(blkno, wfp, jobs[i].matches[m].second, blocks[blkno].size, 0, found);
+	  }
+      munmap(map, filesize);
     }
   else if (chksumlen >= 16)
     {
+      FILE *fp = fopen(filename.c_str(), "r");
+      if (!fp)
+	return 0;
       // dummy variant, just check the checksums
       size_t bufl = 4096;
       off_t off = 0;
@@ -457,17 +593,22 @@ MediaBlockList::reuseBlocks(FILE *wfp, string filename)
 	    writeBlock(blkno, wfp, buf, blksize, 0, found);
 	  off += blksize;
 	}
+      delete[] buf;
+      fclose(fp);
     }
   if (!found[nblks])
-    return;
+    return 0;
   // now throw out all of the blocks we found
   std::vector<MediaBlock> nblocks;
   std::vector<unsigned char> nchksums;
   std::vector<unsigned int> nrsums;
+  off_t reused = 0;
 
   for (size_t blkno = 0; blkno < blocks.size(); ++blkno)
     {
-      if (!found[blkno])
+      if (found[blkno])
+	reused += blocks[blkno].size;
+      else
 	{
 	  // still need it
 	  nblocks.push_back(blocks[blkno]);
@@ -483,6 +624,7 @@ MediaBlockList::reuseBlocks(FILE *wfp, string filename)
   blocks = nblocks;
   chksums = nchksums;
   rsums = nrsums;
+  return reused;
 }
 
 std::string
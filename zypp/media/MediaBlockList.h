@@ -111,8 +111,15 @@ public:
   /**
    * scan a file for blocks from our blocklist. if we find a suitable block,
    * it is removed from the list
+   *
+   * the file is memory mapped and, if the blocklist has rolling checksums,
+   * scanned for blocks at any offset. large files are split into regions
+   * scanned by up to \a threads threads (0: one per 32MB region, at most
+   * one per cpu)
+   *
+   * returns the number of bytes written to \a wfp
    **/
-  void reuseBlocks(FILE *wfp, std::string filename);
+  off_t reuseBlocks(FILE *wfp, std::string filename, unsigned threads = 0);
 
   /**
    * return block list as string
@@ -120,6 +127,8 @@ public:
   std::string asString() const;
 
 private:
+  struct RsumIndex;
+  void scanRsums(const unsigned char *data, size_t avail, size_t npos, size_t blksize, int sql, const RsumIndex &idx, std::vector<bool> &found, std::vector<std::pair<size_t, const unsigned char *> > &matches) const;
   void writeBlock(size_t blkno, FILE *fp, const unsigned char *buf, size_t bufl, size_t start, std::vector<bool> &found) const;
   bool checkChecksumRotated(size_t blkno, const unsigned char *buf, size_t bufl, size_t start) const;
 
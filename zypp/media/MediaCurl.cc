@@ -12,6 +12,9 @@
 
 #include <iostream>
 #include <list>
+#include <map>
+#include <mutex>
+#include <algorithm>
 
 #include "zypp/base/Logger.h"
 #include "zypp/ExternalProgram.h"
@@ -21,6 +24,7 @@
 #include "zypp/base/Gettext.h"
 
 #include "zypp/media/MediaCurl.h"
+#include "zypp/media/MediaManager.h"
 #include "zypp/media/ProxyInfo.h"
 #include "zypp/media/MediaUserAuth.h"
 #include "zypp/media/CredentialManager.h"
@@ -29,6 +33,8 @@
 #include "zypp/Target.h"
 #include "zypp/ZYppFactory.h"
 #include "zypp/ZConfig.h"
+#include "zypp/Digest.h"
+#include "zypp/media/StreamedChecksums.h"
 
 #include <cstdlib>
 #include <sys/types.h>
@@ -148,8 +154,66 @@ namespace
 
     return max;
   }
+
+  /** One lock per kind of shared data; media may be accessed from several threads. */
+  std::mutex & curlShareMutex( curl_lock_data data_r )
+  {
+    static std::mutex _mutex[CURL_LOCK_DATA_LAST];
+    return _mutex[data_r];
+  }
+
+  extern "C" void curlShareLock( CURL *, curl_lock_data data_r, curl_lock_access, void * )
+  { curlShareMutex( data_r ).lock(); }
+
+  extern "C" void curlShareUnlock( CURL *, curl_lock_data data_r, void * )
+  { curlShareMutex( data_r ).unlock(); }
+
+  /** Guards \ref MediaCurl::_prefetchQueue and the handlers prefetch results;
+   * files may be requested from several threads. Recursive, as a pump
+   * started under the lock finishes jobs. Don't send callbacks holding it.
+   */
+  std::recursive_mutex & prefetchMutex()
+  {
+    static std::recursive_mutex _mutex;
+    return _mutex;
+  }
 }
 
+namespace zypp {
+  namespace media {
+
+  /** Process wide share handle for all \ref MediaCurl instances.
+   * DNS cache, TLS sessions and (curl >= 7.57) the connection cache are
+   * shared, so talking to the same host again reuses an established
+   * (maybe HTTP/2) connection instead of doing another TLS handshake.
+   * The handle is never released (like curl_global_cleanup).
+   */
+  CURLSH * MediaCurl::sharedCurlHandle()
+  {
+    static CURLSH * _share = []() -> CURLSH * {
+      CURLSH * share = curl_share_init();
+      if ( ! share )
+      {
+	WAR << "curl_share_init failed: no shared connection cache" << endl;
+	return nullptr;
+      }
+      curl_share_setopt( share, CURLSHOPT_LOCKFUNC, curlShareLock );
+      curl_share_setopt( share, CURLSHOPT_UNLOCKFUNC, curlShareUnlock );
+      curl_share_setopt( share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS );
+#if CURLVERSION_AT_LEAST(7,23,0)
+      curl_share_setopt( share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION );
+#endif
+#if CURLVERSION_AT_LEAST(7,57,0)
+      curl_share_setopt( share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT );
+#endif
+      return share;
+    }();
+    return _share;
+  }
+
+  } // namespace media
+} // namespace zypp
+
 namespace zypp {
 
   ///////////////////////////////////////////////////////////////////
@@ -181,6 +245,28 @@ namespace zypp {
   namespace media {
 
   namespace {
+    /** CURLOPT_WRITEFUNCTION writing to \a file while computing its \a digest. */
+    struct DigestingWrite
+    {
+      DigestingWrite( FILE * file_r )
+        : file( file_r )
+        , ok( true )
+      {}
+
+      static size_t write( char * ptr, size_t size, size_t nmemb, void * userdata )
+      {
+        DigestingWrite & self( *reinterpret_cast<DigestingWrite *>( userdata ) );
+        size_t written = ::fwrite( ptr, size, nmemb, self.file );
+        if ( self.ok && ! self.digest.update( ptr, written * size ) )
+          self.ok = false;
+        return written;
+      }
+
+      FILE * file;
+      Digest digest;
+      bool   ok;
+    };
+
     struct ProgressData
     {
       ProgressData( CURL *_curl, time_t _timeout = 0, const Url & _url = Url(),
@@ -665,6 +751,10 @@ void MediaCurl::setupEasy()
   SET_OPTION(CURLOPT_FAILONERROR, 1L);
   SET_OPTION(CURLOPT_NOSIGNAL, 1L);
 
+  // Reuse connections opened by other MediaCurl instances (not fatal if unsupported).
+  if ( CURLSH * share = MediaCurl::sharedCurlHandle() )
+    curl_easy_setopt( _curl, CURLOPT_SHARE, share );
+
   // create non persistant settings
   // so that we don't add headers twice
   TransferSettings vol_settings(_settings);
@@ -940,6 +1030,11 @@ void MediaCurl::disconnectFrom()
     curl_easy_cleanup( _curl );
     _curl = NULL;
   }
+
+  std::lock_guard<std::recursive_mutex> guard( prefetchMutex() );
+  _prefetched.clear();
+  _prefetchedMissing.clear();
+  discardPrefetchJobs( this );
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -967,6 +1062,23 @@ Url MediaCurl::getFileUrl( const Pathname & filename_r ) const
 
 void MediaCurl::getFile( const Pathname & filename ) const
 {
+    // Serve files retrieved by getFilesPrefetch; wait for them if
+    // still in transfer, otherwise keep the other transfers going.
+    if ( ! waitForPrefetch( filename.absolutename() ) )
+      pumpPrefetchQueue();
+
+    bool prefetched = false;
+    {
+      std::lock_guard<std::recursive_mutex> guard( prefetchMutex() );
+      _prefetchedMissing.erase( filename.absolutename() );
+      prefetched = _prefetched.erase( filename.absolutename() );
+    }
+    if ( prefetched && PathInfo( localPath( filename ) ).isFile() )
+    {
+      DBG << "provide prefetched " << filename << endl;
+      return;
+    }
+
     // Use absolute file name to prevent access of files outside of the
     // hierarchy below the attach point.
     getFileCopy(filename, localPath(filename).absolutename());
@@ -1017,6 +1129,18 @@ void MediaCurl::getFileCopy( const Pathname & filename , const Pathname & target
 
 bool MediaCurl::getDoesFileExist( const Pathname & filename ) const
 {
+  // Answer from what getFilesPrefetch already learned.
+  {
+    std::lock_guard<std::recursive_mutex> guard( prefetchMutex() );
+    if ( _prefetched.count( filename.absolutename() ) )
+      return true;
+    if ( _prefetchedMissing.erase( filename.absolutename() ) )
+    {
+      DBG << "prefetch found no " << filename << endl;
+      return false;
+    }
+  }
+
   bool retry = false;
 
   do
@@ -1466,17 +1590,543 @@ void MediaCurl::doGetFileCopy( const Pathname & filename , const Pathname & targ
         ERR << "Rename failed" << endl;
         ZYPP_THROW(MediaWriteException(dest));
       }
+      rememberDownloadChecksum( dest );
     }
     else
     {
       // close and remove the temp file
       ::fclose( file );
       filesystem::unlink( destNew );
+      _downloadChecksum = CheckSum();
     }
 
     DBG << "done: " << PathInfo(dest) << endl;
 }
 
+void MediaCurl::rememberDownloadChecksum( const Pathname & dest ) const
+{
+  if ( ! _downloadChecksum.empty() )
+  {
+    StreamedChecksums::remember( dest, _downloadChecksum );
+    _downloadChecksum = CheckSum();
+  }
+}
+
+///////////////////////////////////////////////////////////////////
+
+/** A single transfer driven by \ref MediaCurl::getFilesPrefetch. */
+struct MediaCurl::PrefetchJob
+{
+  const MediaCurl * handler = nullptr;	///< the media the file belongs to
+  Pathname    filename;	///< the file on the media
+  Pathname    dest;		///< final location below the attach point
+  std::string destNew;	///< temp file we download to
+  std::string url;		///< url passed to curl
+  std::string host;	///< host the rolling window is bounded for
+  FILE *      file = nullptr;
+  CURL *      easy = nullptr;
+  char        error[CURL_ERROR_SIZE];
+};
+
+/** The rolling window of transfers requested outside a \ref ScopedPrefetchBatch.
+ * Jobs are started in request order, at most \ref ZConfig::download_max_parallel_downloads
+ * per host. The easy handles point to the elements of \c running, so they must not
+ * be copied.
+ */
+struct MediaCurl::PrefetchQueue
+{
+  CURLM * multi = nullptr;
+  std::list<PrefetchJob> pending;	///< not yet started
+  std::list<PrefetchJob> running;	///< transfers in the multi handle
+  std::map<std::string,long> runningPerHost;
+};
+
+thread_local std::vector<MediaCurl::PrefetchJob> * MediaCurl::_prefetchBatch = nullptr;
+MediaCurl::PrefetchQueue * MediaCurl::_prefetchQueue = nullptr;
+
+namespace
+{
+  /** HTTP/2 streams per connection \ref MediaCurl::runPrefetchJobs keeps busy.
+   * Each running transfer holds an open temp file, so don't go beyond. */
+  const long prefetchStreamsPerConnection = 16;
+
+  /** Close and remove the temp file of a failed prefetch job. */
+  template <class TJob>
+  inline void discardPrefetchJob( TJob & job_r )
+  {
+    if ( job_r.file )
+    {
+      ::fclose( job_r.file );
+      job_r.file = nullptr;
+    }
+    filesystem::unlink( job_r.destNew );
+  }
+} // namespace
+
+void MediaCurl::getFilesPrefetch( const std::list<Pathname> & filenames ) const
+{
+#if CURLVERSION_AT_LEAST(7,28,0)
+  long maxParallel = ZConfig::instance().download_max_parallel_downloads();
+  if ( ! _prefetchBatch && maxParallel < 2 )
+    return;	// nothing to gain, getFile will do the job
+
+  if( ! _curl || !_url.isValid() || _url.getHost().empty() )
+    return;
+
+  std::lock_guard<std::recursive_mutex> guard( prefetchMutex() );
+  // Prepare the jobs first; they are either queued in the active
+  // batch or in the rolling window.
+  std::vector<PrefetchJob> jobs;
+  jobs.reserve( filenames.size() );
+  for ( const Pathname & filename : filenames )
+  {
+    Pathname file( filename.absolutename() );
+    if ( _prefetched.count( file ) || _prefetchedMissing.count( file ) || queuedPrefetchJob( file ) )
+      continue;
+    jobs.push_back( PrefetchJob() );
+    PrefetchJob & job( jobs.back() );
+    job.handler  = this;
+    job.filename = file;
+    job.dest     = localPath( file ).absolutename();
+    job.url      = clearQueryString( getFileUrl( file ) ).asString();
+    job.host     = _url.getHost();
+    job.error[0] = '\0';
+  }
+  if ( jobs.empty() )
+    return;
+
+  if ( _prefetchBatch )
+  {
+    DBG << "Queue " << jobs.size() << " files from " << _url << " for batch prefetch" << endl;
+    _prefetchBatch->insert( _prefetchBatch->end(), jobs.begin(), jobs.end() );
+    return;
+  }
+
+  if ( ! _prefetchQueue )
+  {
+    CURLM * multi = curl_multi_init();
+    if ( ! multi )
+    {
+      WAR << "curl_multi_init failed: no prefetch" << endl;
+      return;
+    }
+#if CURLVERSION_AT_LEAST(7,30,0)
+    curl_multi_setopt( multi, CURLMOPT_MAX_HOST_CONNECTIONS, maxParallel );
+#endif
+    _prefetchQueue = new PrefetchQueue;
+    _prefetchQueue->multi = multi;
+  }
+  MIL << "Prefetch " << jobs.size() << " files from " << _url << " (" << maxParallel << " parallel)" << endl;
+  _prefetchQueue->pending.insert( _prefetchQueue->pending.end(), jobs.begin(), jobs.end() );
+  pumpPrefetchQueue();
+#endif // CURLVERSION_AT_LEAST(7,28,0)
+}
+
+bool MediaCurl::startPrefetchJob( CURLM * multi, PrefetchJob & job )
+{
+#if CURLVERSION_AT_LEAST(7,28,0)
+  if ( ! job.handler->_curl || assert_dir( job.dest.dirname() ) )
+    return false;
+
+  job.destNew = job.dest.asString() + ".new.zypp.XXXXXX";
+  int tmp_fd = ::mkostemp( &job.destNew[0], O_CLOEXEC );
+  if ( tmp_fd == -1 )
+    return false;
+  if ( ! ( job.file = ::fdopen( tmp_fd, "we" ) ) )
+  {
+    ::close( tmp_fd );
+    discardPrefetchJob( job );
+    return false;
+  }
+
+  if ( ! ( job.easy = curl_easy_duphandle( job.handler->_curl ) ) )
+  {
+    discardPrefetchJob( job );
+    return false;
+  }
+  curl_easy_setopt( job.easy, CURLOPT_URL, job.url.c_str() );
+  curl_easy_setopt( job.easy, CURLOPT_WRITEDATA, job.file );
+  curl_easy_setopt( job.easy, CURLOPT_ERRORBUFFER, job.error );
+  curl_easy_setopt( job.easy, CURLOPT_PRIVATE, &job );
+  curl_easy_setopt( job.easy, CURLOPT_TIMECONDITION, CURL_TIMECOND_NONE );
+  curl_easy_setopt( job.easy, CURLOPT_TIMEVALUE, 0L );
+#if CURLVERSION_AT_LEAST(7,47,0)
+  // Prefer HTTP/2 for https, so prefetched files are multiplexed on a
+  // single connection (not fatal if curl lacks HTTP/2 support).
+  curl_easy_setopt( job.easy, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS );
+#endif
+#if CURLVERSION_AT_LEAST(7,43,0)
+  // rather wait for a connection that may multiplex than open another one
+  curl_easy_setopt( job.easy, CURLOPT_PIPEWAIT, 1L );
+#endif
+  // no progress callbacks: use curls own no-data timeout instead
+  curl_easy_setopt( job.easy, CURLOPT_NOPROGRESS, 1L );
+  curl_easy_setopt( job.easy, CURLOPT_PROGRESSDATA, NULL );
+  if ( job.handler->_settings.timeout() )
+  {
+    curl_easy_setopt( job.easy, CURLOPT_LOW_SPEED_LIMIT, 1L );
+    curl_easy_setopt( job.easy, CURLOPT_LOW_SPEED_TIME, job.handler->_settings.timeout() );
+  }
+
+  if ( curl_multi_add_handle( multi, job.easy ) != CURLM_OK )
+  {
+    curl_easy_cleanup( job.easy );
+    job.easy = nullptr;
+    discardPrefetchJob( job );
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif // CURLVERSION_AT_LEAST(7,28,0)
+}
+
+bool MediaCurl::finishPrefetchJob( CURLM * multi, PrefetchJob & job, CURLcode result )
+{
+  long httpCode = 0;
+  if ( result == CURLE_HTTP_RETURNED_ERROR )
+    curl_easy_getinfo( job.easy, CURLINFO_RESPONSE_CODE, &httpCode );
+  curl_multi_remove_handle( multi, job.easy );
+  curl_easy_cleanup( job.easy );
+  job.easy = nullptr;
+
+  if ( result != CURLE_OK )
+  {
+    DBG << "prefetch failed: " << job.url << ": " << result << ": " << job.error << endl;
+    discardPrefetchJob( job );
+    // Remember definitely missing files, so getDoesFileExist
+    // does not need to ask again.
+    if ( httpCode == 404 || result == CURLE_REMOTE_FILE_NOT_FOUND || result == CURLE_FTP_COULDNT_RETR_FILE )
+    {
+      std::lock_guard<std::recursive_mutex> guard( prefetchMutex() );
+      job.handler->_prefetchedMissing.insert( job.filename );
+    }
+    return false;
+  }
+
+  if ( ::fchmod( ::fileno( job.file ), filesystem::applyUmaskTo( 0644 ) ) )
+    ERR << "Failed to chmod file " << job.destNew << endl;
+  int res = ::fclose( job.file );
+  job.file = nullptr;
+  if ( res != 0 || rename( job.destNew, job.dest ) != 0 )
+  {
+    ERR << "prefetch failed to write " << job.dest << endl;
+    filesystem::unlink( job.destNew );
+    return false;
+  }
+  std::lock_guard<std::recursive_mutex> guard( prefetchMutex() );
+  job.handler->_prefetched.insert( job.filename );
+  return true;
+}
+
+void MediaCurl::pumpPrefetchQueue( int timeout_r )
+{
+#if CURLVERSION_AT_LEAST(7,28,0)
+  std::lock_guard<std::recursive_mutex> guard( prefetchMutex() );
+  PrefetchQueue * queue = _prefetchQueue;
+  if ( ! queue )
+    return;
+  long window = std::max( 1L, ZConfig::instance().download_max_parallel_downloads() );
+
+  for ( bool refill = true; refill; )
+  {
+    // Start the pending jobs (in order) as far as their hosts window allows.
+    for ( auto it = queue->pending.begin(); it != queue->pending.end(); )
+    {
+      long & running( queue->runningPerHost[it->host] );
+      if ( running >= window )
+      {
+        ++it;
+        continue;
+      }
+      auto job( it++ );
+      queue->running.splice( queue->running.end(), queue->pending, job );
+      if ( startPrefetchJob( queue->multi, *job ) )
+        ++running;
+      else
+        queue->running.erase( job );
+    }
+    if ( queue->running.empty() )
+      break;
+
+    int stillRunning = 0;
+    if ( curl_multi_perform( queue->multi, &stillRunning ) != CURLM_OK )
+    {
+      WAR << "curl_multi_perform failed: stop prefetch" << endl;
+      discardPrefetchJobs( nullptr );
+      return;
+    }
+
+    refill = false;
+    int msgsLeft = 0;
+    while ( CURLMsg * msg = curl_multi_info_read( queue->multi, &msgsLeft ) )
+    {
+      if ( msg->msg != CURLMSG_DONE )
+        continue;
+      char * jobp = nullptr;
+      curl_easy_getinfo( msg->easy_handle, CURLINFO_PRIVATE, &jobp );
+      PrefetchJob * job = reinterpret_cast<PrefetchJob *>( jobp );
+      CURLcode result = msg->data.result;	// msg is invalid after finishPrefetchJob
+      finishPrefetchJob( queue->multi, *job, result );
+      --queue->runningPerHost[job->host];
+      queue->running.remove_if( [job]( const PrefetchJob & job_r ) { return &job_r == job; } );
+      refill = true;
+    }
+  }
+
+  if ( queue->pending.empty() && queue->running.empty() )
+  {
+    curl_multi_cleanup( queue->multi );
+    delete queue;
+    _prefetchQueue = nullptr;
+    return;
+  }
+  if ( timeout_r )
+    curl_multi_wait( queue->multi, NULL, 0, timeout_r, NULL );
+#endif // CURLVERSION_AT_LEAST(7,28,0)
+}
+
+void MediaCurl::discardPrefetchJobs( const MediaCurl * handler_r )
+{
+  auto match( [handler_r]( const PrefetchJob & job_r ) { return ! handler_r || job_r.handler == handler_r; } );
+  std::lock_guard<std::recursive_mutex> guard( prefetchMutex() );
+
+  if ( _prefetchBatch )
+    _prefetchBatch->erase( std::remove_if( _prefetchBatch->begin(), _prefetchBatch->end(), match ),
+                           _prefetchBatch->end() );
+
+  if ( PrefetchQueue * queue = _prefetchQueue )
+  {
+    queue->pending.remove_if( match );
+    for ( auto it = queue->running.begin(); it != queue->running.end(); )
+    {
+      if ( ! match( *it ) )
+      {
+        ++it;
+        continue;
+      }
+      curl_multi_remove_handle( queue->multi, it->easy );
+      curl_easy_cleanup( it->easy );
+      discardPrefetchJob( *it );
+      --queue->runningPerHost[it->host];
+      it = queue->running.erase( it );
+    }
+    if ( queue->pending.empty() && queue->running.empty() )
+    {
+      curl_multi_cleanup( queue->multi );
+      delete queue;
+      _prefetchQueue = nullptr;
+    }
+  }
+}
+
+MediaCurl::PrefetchJob * MediaCurl::queuedPrefetchJob( const Pathname & file_r ) const
+{
+  if ( _prefetchQueue )
+  {
+    for ( std::list<PrefetchJob> * jobs : { &_prefetchQueue->running, &_prefetchQueue->pending } )
+    {
+      for ( PrefetchJob & job : *jobs )
+      {
+        if ( job.handler == this && job.filename == file_r )
+          return &job;
+      }
+    }
+  }
+  return nullptr;
+}
+
+bool MediaCurl::waitForPrefetch( const Pathname & file_r ) const
+{
+#if CURLVERSION_AT_LEAST(7,28,0)
+  Pathname dest;
+  {
+    std::lock_guard<std::recursive_mutex> guard( prefetchMutex() );
+    PrefetchJob * job = queuedPrefetchJob( file_r );
+    if ( ! job )
+      return false;
+
+    PrefetchQueue * queue = _prefetchQueue;
+    if ( ! job->easy )
+    {
+      // Needed now: start it ahead of the window.
+      auto it( std::find_if( queue->pending.begin(), queue->pending.end(),
+                             [job]( const PrefetchJob & job_r ) { return &job_r == job; } ) );
+      queue->running.splice( queue->running.end(), queue->pending, it );
+      if ( ! startPrefetchJob( queue->multi, *job ) )
+      {
+        queue->running.erase( it );
+        return false;
+      }
+      ++queue->runningPerHost[job->host];
+    }
+    dest = job->dest;
+  }
+
+  // Callbacks are sent without holding the prefetch lock.
+  callback::SendReport<DownloadProgressReport> report;
+  Url url( getFileUrl( file_r ) );
+  DBG << "wait for prefetched " << file_r << endl;
+  report->start( url, dest );
+  ProgressData progressData( nullptr, 0, url, &report );
+  while ( true )
+  {
+    double dltotal = 0.0;
+    double dlnow = 0.0;
+    {
+      std::lock_guard<std::recursive_mutex> guard( prefetchMutex() );
+      PrefetchJob * job = queuedPrefetchJob( file_r );
+      if ( ! job )
+        break;	// gone once finished
+      curl_easy_getinfo( job->easy, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &dltotal );
+      curl_easy_getinfo( job->easy, CURLINFO_SIZE_DOWNLOAD, &dlnow );
+    }
+    progressData.updateStats( std::max( dltotal, 0.0 ), dlnow );
+    if ( progressData.reportProgress() )
+    {
+      WAR << "User abort while waiting for " << file_r << ": cancel all prefetches" << endl;
+      discardPrefetchJobs( nullptr );
+      MediaCurlException excpt( url, "User abort", "" );
+      report->finish( url, DownloadProgressReport::ERROR, excpt.asUserHistory() );
+      ZYPP_THROW( excpt );
+    }
+    pumpPrefetchQueue( 50 );
+  }
+
+  bool missing = false;
+  bool prefetched = false;
+  {
+    std::lock_guard<std::recursive_mutex> guard( prefetchMutex() );
+    missing = _prefetchedMissing.count( file_r );
+    prefetched = _prefetched.count( file_r );
+  }
+  if ( prefetched )
+    report->finish( url, DownloadProgressReport::NO_ERROR, "" );
+  else if ( missing )
+    report->finish( url, DownloadProgressReport::NOT_FOUND, "" );
+  else	// getFile retries with a download of its own
+    report->finish( url, DownloadProgressReport::ERROR, "prefetch failed" );
+  return true;
+#else
+  return false;
+#endif // CURLVERSION_AT_LEAST(7,28,0)
+}
+
+void MediaCurl::runPrefetchJobs( std::vector<PrefetchJob> & jobs, long maxParallel )
+{
+#if CURLVERSION_AT_LEAST(7,28,0)
+  // The easy handles point into the vector, so it must
+  // not be resized once transfers are started.
+  if ( jobs.empty() )
+    return;
+  if ( maxParallel < 1 )
+    maxParallel = 1;
+
+  CURLM * multi = curl_multi_init();
+  if ( ! multi )
+  {
+    WAR << "curl_multi_init failed: no prefetch" << endl;
+    return;
+  }
+  // Transfers to start at once. With HTTP/2 they are multiplexed as
+  // streams on the connections, otherwise they are queued by curl until
+  // a connection is free. Connections are bounded by maxParallel.
+  long maxRunning = maxParallel;
+#if CURLVERSION_AT_LEAST(7,30,0)
+  // A batch may address many servers; don't hit a single one harder
+  // than a plain prefetch would.
+  curl_multi_setopt( multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+                     std::max( 1L, std::min( maxParallel, ZConfig::instance().download_max_parallel_downloads() ) ) );
+  curl_multi_setopt( multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, maxParallel );
+#endif
+#if CURLVERSION_AT_LEAST(7,43,0)
+  curl_multi_setopt( multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX );
+  maxRunning = maxParallel * prefetchStreamsPerConnection;
+#endif
+
+  unsigned next = 0;
+  unsigned running = 0;
+  unsigned succeeded = 0;
+  while ( next < jobs.size() || running )
+  {
+    while ( running < unsigned(maxRunning) && next < jobs.size() )
+    {
+      if ( startPrefetchJob( multi, jobs[next] ) )
+	++running;
+      ++next;
+    }
+
+    int stillRunning = 0;
+    if ( curl_multi_perform( multi, &stillRunning ) != CURLM_OK )
+    {
+      WAR << "curl_multi_perform failed: stop prefetch" << endl;
+      break;
+    }
+
+    int msgsLeft = 0;
+    while ( CURLMsg * msg = curl_multi_info_read( multi, &msgsLeft ) )
+    {
+      if ( msg->msg != CURLMSG_DONE )
+	continue;
+      char * jobp = nullptr;
+      curl_easy_getinfo( msg->easy_handle, CURLINFO_PRIVATE, &jobp );
+      CURLcode result = msg->data.result;	// msg is invalid after finishPrefetchJob
+      if ( finishPrefetchJob( multi, *reinterpret_cast<PrefetchJob *>( jobp ), result ) )
+	++succeeded;
+      --running;
+    }
+
+    if ( running )
+      curl_multi_wait( multi, NULL, 0, 1000, NULL );
+  }
+
+  // cleanup jobs left over after an error
+  for ( PrefetchJob & job : jobs )
+  {
+    if ( job.easy )
+    {
+      curl_multi_remove_handle( multi, job.easy );
+      curl_easy_cleanup( job.easy );
+      job.easy = nullptr;
+      discardPrefetchJob( job );
+    }
+  }
+  curl_multi_cleanup( multi );
+
+  MIL << "Prefetched " << succeeded << " of " << jobs.size() << " files" << endl;
+#endif // CURLVERSION_AT_LEAST(7,28,0)
+}
+
+bool MediaCurl::beginPrefetchBatch()
+{
+  if ( _prefetchBatch )
+    return false;
+  _prefetchBatch = new std::vector<PrefetchJob>;
+  return true;
+}
+
+void MediaCurl::endPrefetchBatch()
+{
+  if ( ! _prefetchBatch )
+    return;
+  if ( ! _prefetchBatch->empty() )
+    DBG << "Discard " << _prefetchBatch->size() << " batched prefetch jobs" << endl;
+  delete _prefetchBatch;
+  _prefetchBatch = nullptr;
+}
+
+void MediaCurl::runPrefetchBatch( long maxParallel_r )
+{
+  if ( ! _prefetchBatch || _prefetchBatch->empty() )
+    return;
+
+  std::vector<PrefetchJob> jobs;
+  jobs.swap( *_prefetchBatch );	// handlers may queue again meanwhile
+
+  MIL << "Batch prefetch " << jobs.size() << " files (" << maxParallel_r << " parallel)" << endl;
+  runPrefetchJobs( jobs, maxParallel_r );
+}
+
 ///////////////////////////////////////////////////////////////////
 
 void MediaCurl::doGetFileCopyFile( const Pathname & filename , const Pathname & dest, FILE *file, callback::SendReport<DownloadProgressReport> & report, RequestOptions options ) const
@@ -1526,6 +2176,17 @@ void MediaCurl::doGetFileCopyFile( const Pathname & filename , const Pathname &
       WAR << "Can't set CURLOPT_PROGRESSDATA: " << _curlError << endl;;
     }
 
+    // Compute the digest while receiving the data, so the
+    // FileChecker does not need to read the file again.
+    _downloadChecksum = CheckSum();
+    DigestingWrite digesting( file );
+    bool digest = ! downloadDigest().empty() && digesting.digest.create( downloadDigest() );
+    if ( digest )
+    {
+      curl_easy_setopt( _curl, CURLOPT_WRITEFUNCTION, &DigestingWrite::write );
+      curl_easy_setopt( _curl, CURLOPT_WRITEDATA, &digesting );
+    }
+
     ret = curl_easy_perform( _curl );
 #if CURLVERSION_AT_LEAST(7,19,4)
     // bnc#692260: If the client sends a request with an If-Modified-Since header
@@ -1553,6 +2214,14 @@ void MediaCurl::doGetFileCopyFile( const Pathname & filename , const Pathname &
       WAR << "Can't unset CURLOPT_PROGRESSDATA: " << _curlError << endl;;
     }
 
+    if ( digest )
+    {
+      curl_easy_setopt( _curl, CURLOPT_WRITEFUNCTION, NULL );
+      curl_easy_setopt( _curl, CURLOPT_WRITEDATA, file );
+      if ( ret == 0 && digesting.ok )
+        _downloadChecksum = CheckSum( downloadDigest(), digesting.digest.digest() );
+    }
+
     if ( ret != 0 )
     {
       ERR << "curl error: " << ret << ": " << _curlError
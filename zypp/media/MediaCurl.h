@@ -12,7 +12,11 @@
 #ifndef ZYPP_MEDIA_MEDIACURL_H
 #define ZYPP_MEDIA_MEDIACURL_H
 
+#include <set>
+#include <vector>
+
 #include "zypp/base/Flags.h"
+#include "zypp/CheckSum.h"
 #include "zypp/media/TransferSettings.h"
 #include "zypp/media/MediaHandler.h"
 #include "zypp/ZYppCallbacks.h"
@@ -91,6 +95,22 @@ class MediaCurl : public MediaHandler
      */
     virtual void doGetFileCopy( const Pathname & srcFilename, const Pathname & targetFilename, callback::SendReport<DownloadProgressReport> & _report, RequestOptions options = OPTION_NONE ) const;
 
+    /**
+     * Queue the files for download below the attach point. The transfers
+     * of all media share a rolling window: at most
+     * \ref ZConfig::download_max_parallel_downloads per host are running,
+     * and the window is refilled as files complete. Transfers proceed
+     * whenever a handler is asked for a file. Successfully prefetched files
+     * are remembered and served by \ref getFile without contacting the
+     * server again. A file still in transfer is awaited by \ref getFile,
+     * reporting its progress like a download. A user abort cancels all
+     * running and queued transfers.
+     *
+     * Within a \ref ScopedPrefetchBatch the files are just queued and
+     * retrieved together with the files of other media by
+     * \ref ScopedPrefetchBatch::run.
+     */
+    virtual void getFilesPrefetch( const std::list<Pathname> & filenames ) const;
 
     virtual bool checkAttachPoint(const Pathname &apoint) const;
 
@@ -105,6 +125,21 @@ class MediaCurl : public MediaHandler
 
     static void setCookieFile( const Pathname & );
 
+    /** Process wide curl share handle (DNS, TLS sessions, connections) used by
+     * all instances; thread safe. \c NULL if curl can't share.
+     */
+    static CURLSH * sharedCurlHandle();
+
+    /** \name Backend of \ref ScopedPrefetchBatch, collecting this thread's prefetch requests. */
+    //@{
+    /** Start collecting; \c false if a batch is already active in this thread. */
+    static bool beginPrefetchBatch();
+    /** Discard the requests still collected and stop collecting. */
+    static void endPrefetchBatch();
+    /** Retrieve the collected requests using up to \a maxParallel_r connections. */
+    static void runPrefetchBatch( long maxParallel_r );
+    //@}
+
     class Callbacks
     {
       public:
@@ -151,6 +186,11 @@ class MediaCurl : public MediaHandler
 
     void doGetFileCopyFile( const Pathname & srcFilename, const Pathname & dest, FILE *file, callback::SendReport<DownloadProgressReport> & _report, RequestOptions options = OPTION_NONE ) const;
 
+    /** Remember the checksum computed by the last \ref doGetFileCopyFile
+     * for the file verification, now that the file was moved to \a dest.
+     */
+    void rememberDownloadChecksum( const Pathname & dest ) const;
+
   private:
     /**
      * Return a comma separated list of available authentication methods
@@ -162,13 +202,47 @@ class MediaCurl : public MediaHandler
 
     bool detectDirIndex() const;
 
+    struct PrefetchJob;
+    struct PrefetchQueue;
+    /** Run \a jobs_r (of any \ref MediaCurl) using up to \a maxParallel_r connections. */
+    static void runPrefetchJobs( std::vector<PrefetchJob> & jobs_r, long maxParallel_r );
+    /** Start the transfer of \a job_r; \c false if it could not be started (not fatal). */
+    static bool startPrefetchJob( CURLM * multi_r, PrefetchJob & job_r );
+    /** Finish the transfer of \a job_r; \c true if the file is available. */
+    static bool finishPrefetchJob( CURLM * multi_r, PrefetchJob & job_r, CURLcode result_r );
+    /** Refill the window of the \ref PrefetchQueue and progress its transfers,
+     * waiting up to \a timeout_r ms for activity. */
+    static void pumpPrefetchQueue( int timeout_r = 0 );
+    /** Drop the prefetch jobs of \a handler_r (all if \c nullptr), cancelling running transfers. */
+    static void discardPrefetchJobs( const MediaCurl * handler_r );
+    /** The job of this handler queued for \a file_r, or \c nullptr (prefetch lock held). */
+    PrefetchJob * queuedPrefetchJob( const Pathname & file_r ) const;
+    /** Wait for the queued transfer of \a file_r; \c false if it is not queued.
+     * Only if there is a transfer to wait for, its progress is sent as
+     * \ref DownloadProgressReport, finished before returning.
+     * \throws MediaCurlException if the user aborts.
+     */
+    bool waitForPrefetch( const Pathname & file_r ) const;
+
   private:
     long _curlDebug;
 
     std::string _currentCookieFile;
     static Pathname _cookieFile;
 
+    /** Files downloaded by \ref getFilesPrefetch and not yet requested (prefetch lock). */
+    mutable std::set<Pathname> _prefetched;
+    /** Files \ref getFilesPrefetch found to be missing on the server (prefetch lock). */
+    mutable std::set<Pathname> _prefetchedMissing;
+    /** Jobs queued while a \ref ScopedPrefetchBatch is active in this thread. */
+    static thread_local std::vector<PrefetchJob> * _prefetchBatch;
+    /** Jobs queued outside a batch, shared by all handlers and threads (prefetch lock). */
+    static PrefetchQueue * _prefetchQueue;
+
   protected:
+    /** Digest (\ref downloadDigest) of the file received by the last \ref doGetFileCopyFile. */
+    mutable CheckSum _downloadChecksum;
+
     CURL *_curl;
     char _curlError[ CURL_ERROR_SIZE ];
     curl_slist *_customHeaders;
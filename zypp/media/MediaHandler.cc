@@ -1000,6 +1000,20 @@ void MediaHandler::provideFile( Pathname filename ) const
   DBG << "provideFile(" << filename << ")" << endl;
 }
 
+void MediaHandler::prefetchFiles( const std::list<Pathname> & filenames ) const
+{
+  if ( !isAttached() ) {
+    INT << "Error: Not attached on prefetchFiles(" << filenames.size() << " files)" << endl;
+    ZYPP_THROW(MediaNotAttachedException(url()));
+  }
+
+  if ( filenames.empty() )
+    return;
+
+  getFilesPrefetch( filenames ); // pass to concrete handler
+  DBG << "prefetchFiles(" << filenames.size() << " files)" << endl;
+}
+
 
 ///////////////////////////////////////////////////////////////////
 //
@@ -1240,6 +1254,11 @@ void MediaHandler::getFileCopy ( const Pathname & srcFilename, const Pathname &
   }
 }
 
+void MediaHandler::getFilesPrefetch( const std::list<Pathname> & /*filenames*/ ) const
+{
+  // nothing to prefetch by default
+}
+
 
 
 ///////////////////////////////////////////////////////////////////
@@ -1392,6 +1411,15 @@ Pathname MediaHandler::deltafile() const {
   return _deltafile;
 }
 
+void MediaHandler::setDownloadDigest( const std::string & type ) const
+{
+  _downloadDigest = type;
+}
+
+std::string MediaHandler::downloadDigest() const {
+  return _downloadDigest;
+}
+
   } // namespace media
 } // namespace zypp
 // vim: set ts=8 sts=2 sw=2 ai noet:
@@ -103,6 +103,9 @@ class MediaHandler {
 	/** file usable for delta downloads */
 	mutable Pathname _deltafile;
 
+	/** digest to compute while downloading */
+	mutable std::string _downloadDigest;
+
     protected:
         /**
 	 * Url to handle
@@ -373,6 +376,21 @@ class MediaHandler {
          **/
         virtual void getFileCopy( const Pathname & srcFilename, const Pathname & targetFilename ) const;
 
+        /**
+         * Call concrete handler to retrieve a batch of files below the
+         * attach point in advance, so a subsequent \ref getFile for
+         * them does not need to access the media again.
+         *
+         * Downloading handlers may override this to retrieve the files
+         * concurrently. Errors must not be propagated; files which could
+         * not be retrieved are simply provided by \ref getFile as usual.
+         *
+         * Default implementation provided that does nothing.
+         *
+         * Asserted that media is attached.
+         **/
+        virtual void getFilesPrefetch( const std::list<Pathname> & filenames ) const;
+
 
 	/**
 	 * Call concrete handler to provide directory content (not recursive!)
@@ -586,6 +604,16 @@ class MediaHandler {
 	 **/
         void provideFileCopy( Pathname srcFilename, Pathname targetFilename) const;
 
+	/**
+	 * Use concrete handler to retrieve the files denoted by path below
+	 * 'localRoot' in advance. This is just a hint, the files must still
+	 * be requested via \ref provideFile. Errors are not propagated.
+	 *
+	 * \throws MediaNotAttachedException if the media is not attached.
+	 *
+	 **/
+	void prefetchFiles( const std::list<Pathname> & filenames ) const;
+
 	/**
 	 * Use concrete handler to provide directory denoted
 	 * by path below 'localRoot' (not recursive!).
@@ -650,6 +678,17 @@ class MediaHandler {
 	 */
 	Pathname deltafile () const;
 
+        /*
+         * set the digest type to compute while downloading the next file
+         * (so the file checker does not need to read it again)
+         */
+	void setDownloadDigest( const std::string & type = std::string() ) const;
+
+	/*
+	 * return the digest type set with setDownloadDigest()
+	 */
+	std::string downloadDigest() const;
+
     public:
 
 	/**
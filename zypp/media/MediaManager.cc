@@ -17,6 +17,7 @@
 #include "zypp/media/MediaException.h"
 #include "zypp/media/MediaManager.h"
 #include "zypp/media/MediaHandler.h"
+#include "zypp/media/MediaCurl.h"
 #include "zypp/media/Mount.h"
 #include "zypp/thread/Mutex.h"
 #include "zypp/thread/MutexLock.h"
@@ -25,6 +26,7 @@
 #include "zypp/base/Logger.h"
 #include "zypp/Pathname.h"
 #include "zypp/PathInfo.h"
+#include "zypp/ZConfig.h"
 
 //////////////////////////////////////////////////////////////////////
 namespace zypp
@@ -682,6 +684,20 @@ namespace zypp
       ref.handler->provideFile(filename);
     }
 
+    // ---------------------------------------------------------------
+    void
+    MediaManager::prefetchFiles(MediaAccessId   accessId,
+                                const std::list<Pathname> &filenames ) const
+    {
+      MutexLock glock(g_Mutex);
+
+      ManagedMedia &ref( m_impl->findMM(accessId));
+
+      ref.checkDesired(accessId);
+
+      ref.handler->prefetchFiles(filenames);
+    }
+
     // ---------------------------------------------------------------
     void
     MediaManager::setDeltafile(MediaAccessId   accessId,
@@ -696,6 +712,20 @@ namespace zypp
       ref.handler->setDeltafile(filename);
     }
 
+    // ---------------------------------------------------------------
+    void
+    MediaManager::setDownloadDigest(MediaAccessId      accessId,
+                                    const std::string &type ) const
+    {
+      MutexLock glock(g_Mutex);
+
+      ManagedMedia &ref( m_impl->findMM(accessId));
+
+      ref.checkDesired(accessId);
+
+      ref.handler->setDownloadDigest(type);
+    }
+
     // ---------------------------------------------------------------
     void
     MediaManager::provideDir(MediaAccessId   accessId,
@@ -972,6 +1002,29 @@ namespace zypp
       }
     }
 
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	CLASS NAME : ScopedPrefetchBatch
+    //
+    ///////////////////////////////////////////////////////////////////
+
+    ScopedPrefetchBatch::ScopedPrefetchBatch()
+      : _active( MediaCurl::beginPrefetchBatch() )
+    {}
+
+    ScopedPrefetchBatch::~ScopedPrefetchBatch()
+    {
+      if ( _active )
+        MediaCurl::endPrefetchBatch();
+    }
+
+    void ScopedPrefetchBatch::run( unsigned maxParallel_r )
+    {
+      if ( ! _active )
+        return;
+      MediaCurl::runPrefetchBatch( maxParallel_r ? maxParallel_r : ZConfig::instance().download_max_parallel_downloads() );
+    }
+
     //////////////////////////////////////////////////////////////////
   } // namespace media
   ////////////////////////////////////////////////////////////////////
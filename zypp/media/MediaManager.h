@@ -763,6 +763,26 @@ namespace zypp
       provideFile(MediaAccessId   accessId,
                   const Pathname &filename ) const;
 
+      /**
+       * Hint that the files denoted by relative path below of the
+       * 'attach point' will be requested via \ref provideFile soon.
+       *
+       * Downloading handlers may retrieve them in advance (concurrently),
+       * so the following \ref provideFile calls are served locally.
+       * Files which could not be retrieved are silently left to the
+       * regular \ref provideFile.
+       *
+       * \param accessId  The media access id to use.
+       * \param filenames The filenames to prefetch, relative to localRoot().
+       *
+       * \throws MediaNotOpenException in case of invalid access id.
+       * \throws MediaNotAttachedException in case, that the media is not attached.
+       * \throws MediaNotDesiredException in case, that the media verification failed.
+       */
+      void
+      prefetchFiles(MediaAccessId   accessId,
+                    const std::list<Pathname> &filenames ) const;
+
       /**
        * FIXME: see MediaAccess class.
        */
@@ -840,6 +860,10 @@ namespace zypp
       setDeltafile(MediaAccessId   accessId,
                   const Pathname &filename ) const;
 
+      void
+      setDownloadDigest(MediaAccessId      accessId,
+                        const std::string &type ) const;
+
     public:
       /**
        * Get the modification time of the /etc/mtab file.
@@ -913,6 +937,42 @@ namespace zypp
       static zypp::RW_pointer<MediaManager_Impl> m_impl;
     };
 
+    ///////////////////////////////////////////////////////////////////
+    /// \class ScopedPrefetchBatch
+    /// \brief Collect prefetch requests across media and run them at once.
+    ///
+    /// While a batch is active, \ref MediaManager::prefetchFiles on
+    /// downloading media just queues the files. \ref run then retrieves
+    /// all of them concurrently, no matter which media they belong to.
+    /// This is used to e.g. check the metadata status of many remote
+    /// repositories within the time of a single round-trip.
+    ///
+    /// The media must stay attached until \ref run returns. Requests still
+    /// queued when the batch is destroyed are discarded. A batch collects
+    /// the requests of its own thread only. Batches do not nest; an inner
+    /// batch is inactive and prefetches work as usual.
+    ///////////////////////////////////////////////////////////////////
+    class ScopedPrefetchBatch : private zypp::base::NonCopyable
+    {
+    public:
+      ScopedPrefetchBatch();
+      ~ScopedPrefetchBatch();
+
+      /** Whether this batch collects the prefetch requests. */
+      bool active() const
+      { return _active; }
+
+      /** Retrieve all queued files using up to \a maxParallel connections
+       * (\c 0: \ref ZConfig::download_max_parallel_downloads).
+       * Files which could not be retrieved are left to the regular
+       * \ref MediaManager::provideFile. Never throws.
+       */
+      void run( unsigned maxParallel_r = 0 );
+
+    private:
+      bool _active;
+    };
+
 
     //////////////////////////////////////////////////////////////////
   } // namespace media
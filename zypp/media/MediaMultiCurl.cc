@@ -12,11 +12,9 @@
 
 #include <ctype.h>
 #include <sys/types.h>
-#include <signal.h>
-#include <sys/wait.h>
-#include <netdb.h>
-#include <arpa/inet.h>
+#include <sys/epoll.h>
 
+#include <cmath>
 #include <vector>
 #include <iostream>
 #include <algorithm>
@@ -26,6 +24,7 @@
 #include "zypp/base/Logger.h"
 #include "zypp/media/MediaMultiCurl.h"
 #include "zypp/media/MetaLinkParser.h"
+#include "zypp/media/MirrorStats.h"
 
 using namespace std;
 using namespace zypp::base;
@@ -56,10 +55,7 @@ public:
   bool checkChecksum();
   bool recheckChecksum();
   void disableCompetition();
-
-  void checkdns();
-  void adddnsfd(fd_set &rset, int &maxfd);
-  void dnsevent(fd_set &rset);
+  size_t blocksize() const;
 
   int _workerno;
 
@@ -95,13 +91,9 @@ private:
   off_t _off;
   size_t _size;
   Digest _dig;
-
-  pid_t _pid;
-  int _dnspipe;
 };
 
 #define WORKER_STARTING 0
-#define WORKER_LOOKUP   1
 #define WORKER_FETCH    2
 #define WORKER_DISCARD  3
 #define WORKER_DONE     4
@@ -120,6 +112,8 @@ public:
 protected:
   friend class multifetchworker;
 
+  void socketaction(curl_socket_t s, int evbitmask);
+
   const MediaMultiCurl *_context;
   const Pathname _filename;
   Url _baseurl;
@@ -138,7 +132,6 @@ protected:
   size_t _blkno;
   off_t _blkoff;
   size_t _activeworkers;
-  size_t _lookupworkers;
   size_t _sleepworkers;
   double _minsleepuntil;
   bool _finished;
@@ -158,10 +151,15 @@ public:
   double _connect_timeout;
   double _maxspeed;
   int _maxworkers;
+
+  MirrorStats::FetchPlan _plan;
 };
 
 #define BLKSIZE		131072
+#define MAXBLKSIZE	4194304
+#define BLKTIME		1.0	// grow blocks to about this many seconds of transfer
 #define MAXURLS		10
+#define MAXEVENTS	64
 
 
 //////////////////////////////////////////////////////////////////////
@@ -175,6 +173,43 @@ currentTime()
   return tv.tv_sec + tv.tv_usec / 1000000.;
 }
 
+// CURLMOPT_SOCKETFUNCTION: keep the epoll set in sync with the sockets
+// curl wants to be watched. userp points to the epoll fd.
+static int
+multisocketcallback(CURL *easy, curl_socket_t s, int what, void *userp, void *socketp)
+{
+  int epollfd = *(int *)userp;
+  if (what == CURL_POLL_REMOVE)
+    {
+      // fails if curl already closed the socket, which is fine
+      epoll_ctl(epollfd, EPOLL_CTL_DEL, s, NULL);
+      return 0;
+    }
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = (what & CURL_POLL_IN ? EPOLLIN : 0) | (what & CURL_POLL_OUT ? EPOLLOUT : 0);
+  ev.data.fd = s;
+  if (epoll_ctl(epollfd, EPOLL_CTL_MOD, s, &ev) == -1)
+    {
+      if (errno != ENOENT || epoll_ctl(epollfd, EPOLL_CTL_ADD, s, &ev) == -1)
+	{
+	  ERR << "epoll_ctl failed for socket " << s << ": " << strerror(errno) << endl;
+	  return -1;
+	}
+    }
+  return 0;
+}
+
+// CURLMOPT_TIMERFUNCTION: remember when curl wants to be called with
+// CURL_SOCKET_TIMEOUT. userp points to the absolute time (0: no timer).
+static int
+multitimercallback(CURLM *multi, long timeout_ms, void *userp)
+{
+  double *timer = (double *)userp;
+  *timer = timeout_ms < 0 ? 0 : currentTime() + timeout_ms / 1000.;
+  return 0;
+}
+
 size_t
 multifetchworker::writefunction(void *ptr, size_t size)
 {
@@ -306,8 +341,6 @@ multifetchworker::multifetchworker(int no, multifetchrequest &request, const Url
   _size = _blksize = 0;
   _pass = 0;
   _blkno = 0;
-  _pid = 0;
-  _dnspipe = -1;
   _blkreceived = 0;
   _received = 0;
   _blkstarttime = 0;
@@ -371,7 +404,6 @@ multifetchworker::multifetchworker(int no, multifetchrequest &request, const Url
 	  }
 	}
     }
-  checkdns();
 }
 
 multifetchworker::~multifetchworker()
@@ -396,157 +428,11 @@ multifetchworker::~multifetchworker()
         curl_easy_cleanup(_curl);
       _curl = 0;
     }
-  if (_pid)
-    {
-      kill(_pid, SIGKILL);
-      int status;
-      while (waitpid(_pid, &status, 0) == -1)
-        if (errno != EINTR)
-	  break;
-      _pid = 0;
-    }
-  if (_dnspipe != -1)
-    {
-      close(_dnspipe);
-      _dnspipe = -1;
-    }
   // the destructor in MediaCurl doesn't call disconnect() if
   // the media is not attached, so we do it here manually
   disconnectFrom();
 }
 
-static inline bool env_isset(string name)
-{
-  const char *s = getenv(name.c_str());
-  return s && *s ? true : false;
-}
-
-void
-multifetchworker::checkdns()
-{
-  string host = _url.getHost();
-
-  if (host.empty())
-    return;
-
-  if (_request->_context->isDNSok(host))
-    return;
-
-  // no need to do dns checking for numeric hosts
-  char addrbuf[128];
-  if (inet_pton(AF_INET, host.c_str(), addrbuf) == 1)
-    return;
-  if (inet_pton(AF_INET6, host.c_str(), addrbuf) == 1)
-    return;
-
-  // no need to do dns checking if we use a proxy
-  if (!_settings.proxy().empty())
-    return;
-  if (env_isset("all_proxy") || env_isset("ALL_PROXY"))
-    return;
-  string schemeproxy = _url.getScheme() + "_proxy";
-  if (env_isset(schemeproxy))
-    return;
-  if (schemeproxy != "http_proxy")
-    {
-      std::transform(schemeproxy.begin(), schemeproxy.end(), schemeproxy.begin(), ::toupper);
-      if (env_isset(schemeproxy))
-	return;
-    }
-
-  XXX << "checking DNS lookup of " << host << endl;
-  int pipefds[2];
-  if (pipe(pipefds))
-    {
-      _state = WORKER_BROKEN;
-      strncpy(_curlError, "DNS pipe creation failed", CURL_ERROR_SIZE);
-      return;
-    }
-  _pid = fork();
-  if (_pid == pid_t(-1))
-    {
-      close(pipefds[0]);
-      close(pipefds[1]);
-      _pid = 0;
-      _state = WORKER_BROKEN;
-      strncpy(_curlError, "DNS checker fork failed", CURL_ERROR_SIZE);
-      return;
-    }
-  else if (_pid == 0)
-    {
-      close(pipefds[0]);
-      // XXX: close all other file descriptors
-      struct addrinfo *ai, aihints;
-      memset(&aihints, 0, sizeof(aihints));
-      aihints.ai_family = PF_UNSPEC;
-      int tstsock = socket(PF_INET6, SOCK_DGRAM | SOCK_CLOEXEC, 0);
-      if (tstsock == -1)
-	aihints.ai_family = PF_INET;
-      else
-	close(tstsock);
-      aihints.ai_socktype = SOCK_STREAM;
-      aihints.ai_flags = AI_CANONNAME;
-      unsigned int connecttimeout = _request->_connect_timeout;
-      if (connecttimeout)
-	alarm(connecttimeout);
-      signal(SIGALRM, SIG_DFL);
-      if (getaddrinfo(host.c_str(), NULL, &aihints, &ai))
-        _exit(1);
-      _exit(0);
-    }
-  close(pipefds[1]);
-  _dnspipe = pipefds[0];
-  _state = WORKER_LOOKUP;
-}
-
-void
-multifetchworker::adddnsfd(fd_set &rset, int &maxfd)
-{
-  if (_state != WORKER_LOOKUP)
-    return;
-  FD_SET(_dnspipe, &rset);
-  if (maxfd < _dnspipe)
-    maxfd = _dnspipe;
-}
-
-void
-multifetchworker::dnsevent(fd_set &rset)
-{
-
-  if (_state != WORKER_LOOKUP || !FD_ISSET(_dnspipe, &rset))
-    return;
-  int status;
-  while (waitpid(_pid, &status, 0) == -1)
-    {
-      if (errno != EINTR)
-        return;
-    }
-  _pid = 0;
-  if (_dnspipe != -1)
-    {
-      close(_dnspipe);
-      _dnspipe = -1;
-    }
-  if (!WIFEXITED(status))
-    {
-      _state = WORKER_BROKEN;
-      strncpy(_curlError, "DNS lookup failed", CURL_ERROR_SIZE);
-      _request->_activeworkers--;
-      return;
-    }
-  int exitcode = WEXITSTATUS(status);
-  XXX << "#" << _workerno << ": DNS lookup returned " << exitcode << endl;
-  if (exitcode != 0)
-    {
-      _state = WORKER_BROKEN;
-      strncpy(_curlError, "DNS lookup failed", CURL_ERROR_SIZE);
-      _request->_activeworkers--;
-      return;
-    }
-  _request->_context->setDNSok(_url.getHost());
-  nextjob();
-}
-
 bool
 multifetchworker::checkChecksum()
 {
@@ -691,6 +577,27 @@ multifetchworker::disableCompetition()
 }
 
 
+size_t
+multifetchworker::blocksize() const
+{
+  // fast links get bigger blocks, so we spend less time in request round trips
+  double speed = _avgspeed;
+  if (!speed)
+    speed = MirrorStats::instance().stats(_url.getHost()).speed;
+  size_t blksize = BLKSIZE;
+  if (speed * BLKTIME > BLKSIZE)
+    blksize = speed * BLKTIME > MAXBLKSIZE ? MAXBLKSIZE : (size_t)(speed * BLKTIME) & ~(size_t)4095;
+  // but do not take more than our share of what is left, so that
+  // no single mirror holds up the end of the download
+  if (blksize > BLKSIZE && _request->_filesize != off_t(-1) && _request->_activeworkers > 1)
+    {
+      off_t share = (_request->_filesize - _request->_blkoff) / (off_t)_request->_activeworkers;
+      if (share < (off_t)blksize)
+	blksize = share > BLKSIZE ? (size_t)share : BLKSIZE;
+    }
+  return blksize;
+}
+
 void
 multifetchworker::nextjob()
 {
@@ -702,9 +609,10 @@ multifetchworker::nextjob()
     }
 
   MediaBlockList *blklist = _request->_blklist;
+  size_t maxblksize = blocksize();
   if (!blklist)
     {
-      _blksize = BLKSIZE;
+      _blksize = maxblksize;
       if (_request->_filesize != off_t(-1))
 	{
 	  if (_request->_blkoff >= _request->_filesize)
@@ -713,8 +621,8 @@ multifetchworker::nextjob()
 	      return;
 	    }
 	  _blksize = _request->_filesize - _request->_blkoff;
-	  if (_blksize > BLKSIZE)
-	    _blksize = BLKSIZE;
+	  if (_blksize > maxblksize)
+	    _blksize = maxblksize;
 	}
     }
   else
@@ -731,9 +639,13 @@ multifetchworker::nextjob()
 	  _request->_blkoff = blk.off;
 	}
       _blksize = blk.off + blk.size - _request->_blkoff;
-      if (_blksize > BLKSIZE && !blklist->haveChecksum(_request->_blkno))
-	_blksize = BLKSIZE;
+      if (_blksize > maxblksize && !blklist->haveChecksum(_request->_blkno))
+	_blksize = maxblksize;
     }
+  if (!_request->_plan.minBlocksize || _blksize < _request->_plan.minBlocksize)
+    _request->_plan.minBlocksize = _blksize;
+  if (_blksize > _request->_plan.maxBlocksize)
+    _request->_plan.maxBlocksize = _blksize;
   _blkno = _request->_blkno;
   _blkstart = _request->_blkoff;
   _request->_blkoff += _blksize;
@@ -797,7 +709,6 @@ multifetchrequest::multifetchrequest(const MediaMultiCurl *context, const Pathna
   else
     _blkoff = 0;
   _activeworkers = 0;
-  _lookupworkers = 0;
   _sleepworkers = 0;
   _minsleepuntil = 0;
   _finished = false;
@@ -825,6 +736,21 @@ multifetchrequest::multifetchrequest(const MediaMultiCurl *context, const Pathna
 
 multifetchrequest::~multifetchrequest()
 {
+  _plan.elapsed = currentTime() - _starttime;
+  for (std::list<multifetchworker *>::iterator workeriter = _workers.begin(); workeriter != _workers.end(); ++workeriter)
+    {
+      multifetchworker *worker = *workeriter;
+      if ((size_t)worker->_workerno >= _plan.mirrors.size())
+	continue;
+      MirrorStats::FetchPlan::Mirror &mirror = _plan.mirrors[worker->_workerno];
+      mirror.used = true;
+      mirror.failed = worker->_state == WORKER_BROKEN;
+      mirror.received = worker->_received;
+    }
+  DBG << _plan << endl;
+  MirrorStats::instance().setLastPlan(_plan);
+  MirrorStats::instance().save();
+
   for (std::list<multifetchworker *>::iterator workeriter = _workers.begin(); workeriter != _workers.end(); ++workeriter)
     {
       multifetchworker *worker = *workeriter;
@@ -841,8 +767,7 @@ multifetchrequest::run(std::vector<Url> &urllist)
   std::vector<Url>::iterator urliter = urllist.begin();
   for (;;)
     {
-      fd_set rset, wset, xset;
-      int maxfd, nqueue;
+      int nqueue;
 
       if (_finished)
 	{
@@ -858,12 +783,7 @@ multifetchrequest::run(std::vector<Url> &urllist)
 	  if (worker->_state != WORKER_BROKEN)
 	    {
 	      _activeworkers++;
-	      if (worker->_state != WORKER_LOOKUP)
-		{
-		  worker->nextjob();
-		}
-	      else
-	        _lookupworkers++;
+	      worker->nextjob();
 	    }
 	  ++urliter;
 	  continue;
@@ -881,21 +801,9 @@ multifetchrequest::run(std::vector<Url> &urllist)
 	  break;
 	}
 
-      FD_ZERO(&rset);
-      FD_ZERO(&wset);
-      FD_ZERO(&xset);
-
-      curl_multi_fdset(_multi, &rset, &wset, &xset, &maxfd);
-
-      if (_lookupworkers)
-        for (std::list<multifetchworker *>::iterator workeriter = _workers.begin(); workeriter != _workers.end(); ++workeriter)
-	  (*workeriter)->adddnsfd(rset, maxfd);
-
-      timeval tv;
-      // if we added a new job we have to call multi_perform once
-      // to make it show up in the fd set. do not sleep in this case.
-      tv.tv_sec = 0;
-      tv.tv_usec = _havenewjob ? 0 : 200000;
+      // if we added a new job we have to kick curl once
+      // to make it start the transfer. do not sleep in this case.
+      int timeoutms = _havenewjob ? 0 : 200;
       if (_sleepworkers && !_havenewjob)
 	{
 	  if (_minsleepuntil == 0)
@@ -916,35 +824,41 @@ multifetchrequest::run(std::vector<Url> &urllist)
 	      _minsleepuntil = 0;
 	    }
 	  if (sl < .2)
-	    tv.tv_usec = sl * 1000000;
+	    timeoutms = ceil(sl * 1000);
 	}
-      int r = select(maxfd + 1, &rset, &wset, &xset, &tv);
+      // do not sleep past curl's timer
+      double &multitimer = _context->_multitimer;
+      if (multitimer && timeoutms)
+	{
+	  double tl = multitimer - currentTime();
+	  if (tl < 0)
+	    tl = 0;
+	  if (tl < timeoutms / 1000.)
+	    timeoutms = ceil(tl * 1000);
+	}
+      struct epoll_event events[MAXEVENTS];
+      int r = epoll_wait(_context->_epollfd, events, MAXEVENTS, timeoutms);
       if (r == -1 && errno != EINTR)
-	ZYPP_THROW(MediaCurlException(_baseurl, "select() failed", "unknown error"));
-      if (r != 0 && _lookupworkers)
-	for (std::list<multifetchworker *>::iterator workeriter = _workers.begin(); workeriter != _workers.end(); ++workeriter)
-	  {
-	    multifetchworker *worker = *workeriter;
-	    if (worker->_state != WORKER_LOOKUP)
-	      continue;
-	    (*workeriter)->dnsevent(rset);
-	    if (worker->_state != WORKER_LOOKUP)
-	      _lookupworkers--;
-	  }
-      _havenewjob = false;
+	ZYPP_THROW(MediaCurlException(_baseurl, "epoll_wait() failed", "unknown error"));
 
       // run curl
-      for (;;)
-        {
-          CURLMcode mcode;
-	  int tasks;
-          mcode = curl_multi_perform(_multi, &tasks);
-          if (mcode == CURLM_CALL_MULTI_PERFORM)
-            continue;
-	  if (mcode != CURLM_OK)
-	    ZYPP_THROW(MediaCurlException(_baseurl, "curl_multi_perform", "unknown error"));
-	  break;
-        }
+      for (int i = 0; i < r; i++)
+	{
+	  int evbitmask = 0;
+	  if (events[i].events & EPOLLIN)
+	    evbitmask |= CURL_CSELECT_IN;
+	  if (events[i].events & EPOLLOUT)
+	    evbitmask |= CURL_CSELECT_OUT;
+	  if (events[i].events & (EPOLLERR | EPOLLHUP))
+	    evbitmask |= CURL_CSELECT_ERR;
+	  socketaction(events[i].data.fd, evbitmask);
+	}
+      if (_havenewjob || (multitimer && multitimer <= currentTime()))
+	{
+	  multitimer = 0;
+	  socketaction(CURL_SOCKET_TIMEOUT, 0);
+	}
+      _havenewjob = false;
 
       double now = currentTime();
 
@@ -997,6 +911,14 @@ multifetchrequest::run(std::vector<Url> &urllist)
 		worker->_avgspeed = worker->_blkreceived / (now - worker->_blkstarttime);
 	    }
 	  XXX << "#" << worker->_workerno << ": BLK " << worker->_blkno << " done code " << cc << " speed " << worker->_avgspeed << endl;
+	  if (cc == 0 && worker->_blkreceived && !_maxspeed && now > worker->_blkstarttime)
+	    {
+	      // rate limited transfers tell nothing about the mirror
+	      double latency = 0;
+	      (void)curl_easy_getinfo(easy, CURLINFO_STARTTRANSFER_TIME, &latency);
+	      MirrorStats::instance().addSample(worker->_url.getHost(), worker->_blkreceived, now - worker->_blkstarttime, latency);
+	      _plan.mirrors[worker->_workerno].blocks++;
+	    }
 	  curl_multi_remove_handle(_multi, easy);
 	  if (cc == CURLE_HTTP_RETURNED_ERROR)
 	    {
@@ -1030,6 +952,7 @@ multifetchrequest::run(std::vector<Url> &urllist)
 	      if (!worker->checkChecksum())
 		{
 		  WAR << "#" << worker->_workerno << ": checksum error, disable worker" << endl;
+		  MirrorStats::instance().addFailure(worker->_url.getHost());
 		  worker->_state = WORKER_BROKEN;
 		  strncpy(worker->_curlError, "checksum error", CURL_ERROR_SIZE);
 		  _activeworkers--;
@@ -1111,6 +1034,7 @@ multifetchrequest::run(std::vector<Url> &urllist)
 	    }
 	  else
 	    {
+	      MirrorStats::instance().addFailure(worker->_url.getHost());
 	      worker->_state = WORKER_BROKEN;
 	      _activeworkers--;
 	      if (!_activeworkers && !(urliter != urllist.end() && _workers.size() < MAXURLS))
@@ -1149,6 +1073,23 @@ multifetchrequest::run(std::vector<Url> &urllist)
 }
 
 
+void
+multifetchrequest::socketaction(curl_socket_t s, int evbitmask)
+{
+  for (;;)
+    {
+      CURLMcode mcode;
+      int tasks;
+      mcode = curl_multi_socket_action(_multi, s, evbitmask, &tasks);
+      if (mcode == CURLM_CALL_MULTI_PERFORM)
+	continue;
+      if (mcode != CURLM_OK)
+	ZYPP_THROW(MediaCurlException(_baseurl, "curl_multi_socket_action", "unknown error"));
+      break;
+    }
+}
+
+
 //////////////////////////////////////////////////////////////////////
 
 
@@ -1157,11 +1098,15 @@ MediaMultiCurl::MediaMultiCurl(const Url &url_r, const Pathname & attach_point_h
 {
   MIL << "MediaMultiCurl::MediaMultiCurl(" << url_r << ", " << attach_point_hint_r << ")" << endl;
   _multi = 0;
+  _epollfd = -1;
+  _multitimer = 0;
+  _reused = 0;
   _customHeadersMetalink = 0;
 }
 
 MediaMultiCurl::~MediaMultiCurl()
 {
+  MirrorStats::instance().save(true);
   if (_customHeadersMetalink)
     {
       curl_slist_free_all(_customHeadersMetalink);
@@ -1172,6 +1117,11 @@ MediaMultiCurl::~MediaMultiCurl()
       curl_multi_cleanup(_multi);
       _multi = 0;
     }
+  if (_epollfd != -1)
+    {
+      close(_epollfd);
+      _epollfd = -1;
+    }
   std::map<std::string, CURL *>::iterator it;
   for (it = _easypool.begin(); it != _easypool.end(); it++)
     {
@@ -1393,6 +1343,7 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
   if (ismetalink)
     {
       bool userabort = false;
+      _downloadChecksum = CheckSum();	// digest of the metalink, not the file
       fclose(file);
       file = NULL;
       Pathname failedFile = ZConfig::instance().repoCachePath() / "MultiCurl.failed";
@@ -1406,16 +1357,17 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
 	  file = fopen(destNew.c_str(), "w+e");
 	  if (!file)
 	    ZYPP_THROW(MediaWriteException(destNew));
+	  off_t reused = 0;
 	  if (PathInfo(target).isExist())
 	    {
 	      XXX << "reusing blocks from file " << target << endl;
-	      bl.reuseBlocks(file, target.asString());
+	      reused += bl.reuseBlocks(file, target.asString());
 	      XXX << bl << endl;
 	    }
 	  if (bl.haveChecksum(1) && PathInfo(failedFile).isExist())
 	    {
 	      XXX << "reusing blocks from file " << failedFile << endl;
-	      bl.reuseBlocks(file, failedFile.asString());
+	      reused += bl.reuseBlocks(file, failedFile.asString());
 	      XXX << bl << endl;
 	      filesystem::unlink(failedFile);
 	    }
@@ -1423,9 +1375,12 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
 	  if (!df.empty())
 	    {
 	      XXX << "reusing blocks from file " << df << endl;
-	      bl.reuseBlocks(file, df.asString());
+	      off_t dfreused = bl.reuseBlocks(file, df.asString());
+	      MIL << "reused " << dfreused << " bytes of " << filename << " from " << df << endl;
+	      reused += dfreused;
 	      XXX << bl << endl;
 	    }
+	  _reused = reused;
 	  try
 	    {
 	      multifetch(filename, file, &urls, &report, &bl);
@@ -1435,10 +1390,12 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
 	      userabort = ex.errstr() == "User abort";
 	      ZYPP_RETHROW(ex);
 	    }
+	  _reused = 0;
 	}
       catch (Exception &ex)
 	{
 	  // something went wrong. fall back to normal download
+	  _reused = 0;
 	  if (file)
 	    fclose(file);
 	  file = NULL;
@@ -1474,6 +1431,7 @@ void MediaMultiCurl::doGetFileCopy( const Pathname & filename , const Pathname &
       ERR << "Rename failed" << endl;
       ZYPP_THROW(MediaWriteException(dest));
     }
+  rememberDownloadChecksum( dest );
   DBG << "done: " << PathInfo(dest) << endl;
 }
 
@@ -1509,9 +1467,27 @@ void MediaMultiCurl::multifetch(const Pathname & filename, FILE *fp, std::vector
     return;
   if (!_multi)
     {
+      _epollfd = epoll_create1(EPOLL_CLOEXEC);
+      if (_epollfd == -1)
+	ZYPP_THROW(MediaCurlInitException(baseurl));
       _multi = curl_multi_init();
       if (!_multi)
-	ZYPP_THROW(MediaCurlInitException(baseurl));
+	{
+	  close(_epollfd);
+	  _epollfd = -1;
+	  ZYPP_THROW(MediaCurlInitException(baseurl));
+	}
+      // event driven: curl tells us which sockets to watch and when to call back
+      curl_multi_setopt(_multi, CURLMOPT_SOCKETFUNCTION, &multisocketcallback);
+      curl_multi_setopt(_multi, CURLMOPT_SOCKETDATA, &_epollfd);
+      curl_multi_setopt(_multi, CURLMOPT_TIMERFUNCTION, &multitimercallback);
+      curl_multi_setopt(_multi, CURLMOPT_TIMERDATA, &_multitimer);
+      // host names are resolved by curl itself (and cached in the multi handle)
+      const curl_version_info_data *vinfo = curl_version_info(CURLVERSION_NOW);
+      if (vinfo && (vinfo->features & CURL_VERSION_ASYNCHDNS))
+	MIL << "libcurl resolves host names asynchronously" << endl;
+      else
+	WAR << "libcurl uses a blocking resolver, slow mirror lookups will stall the download" << endl;
     }
   multifetchrequest req(this, filename, baseurl, _multi, fp, report, blklist, filesize);
   req._timeout = _settings.timeout();
@@ -1540,6 +1516,20 @@ void MediaMultiCurl::multifetch(const Pathname & filename, FILE *fp, std::vector
     }
   if (!myurllist.size())
     myurllist.push_back(baseurl);
+  // try the mirrors expected to be done first (only the first MAXURLS are used)
+  MirrorStats &mirrorstats = MirrorStats::instance();
+  mirrorstats.rank(myurllist, filesize);
+  req._plan.filename = filename;
+  req._plan.filesize = filesize;
+  req._plan.reused = _reused;
+  req._plan.maxMirrors = MAXURLS;
+  for (std::vector<Url>::iterator urliter = myurllist.begin(); urliter != myurllist.end(); ++urliter)
+    {
+      MirrorStats::FetchPlan::Mirror mirror;
+      mirror.url = *urliter;
+      mirror.expectedTime = mirrorstats.expectedTime(urliter->getHost(), filesize);
+      req._plan.mirrors.push_back(mirror);
+    }
   req.run(myurllist);
   checkFileDigest(baseurl, fp, blklist);
 }
@@ -1560,16 +1550,6 @@ void MediaMultiCurl::checkFileDigest(Url &url, FILE *fp, MediaBlockList *blklist
     ZYPP_THROW(MediaCurlException(url, "file verification failed", "checksum error"));
 }
 
-bool MediaMultiCurl::isDNSok(const string &host) const
-{
-  return _dnsok.find(host) == _dnsok.end() ? false : true;
-}
-
-void MediaMultiCurl::setDNSok(const string &host) const
-{
-  _dnsok.insert(host);
-}
-
 CURL *MediaMultiCurl::fromEasyPool(const string &host) const
 {
   if (_easypool.find(host) == _easypool.end())
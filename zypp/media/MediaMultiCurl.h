@@ -51,9 +51,6 @@ public:
 
 protected:
 
-  bool isDNSok(const std::string &host) const;
-  void setDNSok(const std::string &host) const;
-
   CURL *fromEasyPool(const std::string &host) const;
   void toEasyPool(const std::string &host, CURL *easy) const;
 
@@ -65,7 +62,9 @@ private:
   // the custom headers from MediaCurl plus a "Accept: metalink" header
   curl_slist *_customHeadersMetalink;
   mutable CURLM *_multi;	// reused for all fetches so we can make use of the dns cache
-  mutable std::set<std::string> _dnsok;
+  mutable int _epollfd;		// the sockets _multi wants to be watched
+  mutable double _multitimer;	// when _multi wants to be called with CURL_SOCKET_TIMEOUT (0: never)
+  mutable off_t _reused;		// bytes of the file to fetch already taken from local files
   mutable std::map<std::string, CURL *> _easypool;
 };
 
@@ -0,0 +1,343 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/media/MirrorStats.cc
+ *
+*/
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+#include "zypp/base/Logger.h"
+#include "zypp/base/NonCopyable.h"
+#include "zypp/base/String.h"
+#include "zypp/PathInfo.h"
+
+#include "zypp/media/MirrorStats.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace media
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      const char *           HEADER		= "# zypp mirror statistics v1";
+      const double           WEIGHT		= 0.3;		// of a new sample in the averages
+      const Date::ValueType  EXPIRE		= 30 * Date::day;	// forget hosts not used for this long
+      const Date::ValueType  SAVEDELAY	= 10;		// min seconds between two (unforced) saves
+      const off_t            TYPICALSIZE	= 1024 * 1024;	// assumed if the filesize is unknown
+
+      inline double average( double avg_r, double val_r, unsigned samples_r )
+      { return samples_r ? avg_r + WEIGHT * ( val_r - avg_r ) : val_r; }
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    /// \class MirrorStats::Impl
+    /// \brief MirrorStats implementation.
+    ///////////////////////////////////////////////////////////////////
+    class MirrorStats::Impl : private base::NonCopyable
+    {
+    public:
+      Impl( const Pathname & file_r )
+      : _file( file_r )
+      , _loaded( file_r.empty() )
+      , _dirty( false )
+      , _lastSave( 0 )
+      {}
+
+      /** Lazy load on first use; \c _mutex must be locked. */
+      void load() const
+      {
+        if ( _loaded )
+          return;
+        _loaded = true;
+
+        std::ifstream file( _file.c_str() );
+        if ( ! file )
+        {
+          DBG << "No mirror statistics in " << _file << endl;
+          return;
+        }
+        Date::ValueType expire = Date::now() - EXPIRE;
+        std::string line;
+        while ( std::getline( file, line ) )
+        {
+          if ( line.empty() || line[0] == '#' )
+            continue;
+          std::istringstream l( line );
+          std::string host;
+          HostStats st;
+          Date::ValueType lastUsed = 0;
+          if ( ! ( l >> host >> st.speed >> st.latency >> st.samples >> st.failures >> lastUsed ) )
+          {
+            WAR << _file << ": ignore malformed line '" << line << "'" << endl;
+            continue;
+          }
+          if ( lastUsed < expire )
+            continue;
+          st.lastUsed = lastUsed;
+          _hosts[host] = st;
+        }
+        MIL << "Read statistics of " << _hosts.size() << " mirrors from " << _file << endl;
+      }
+
+      /** The average known host to judge unknown ones; \c _mutex must be locked. */
+      HostStats typical() const
+      {
+        HostStats ret;
+        for ( const auto & el : _hosts )
+        {
+          if ( ! el.second.samples )
+            continue;
+          ret.speed   += el.second.speed;
+          ret.latency += el.second.latency;
+          ++ret.samples;
+        }
+        if ( ret.samples )
+        {
+          ret.speed   /= ret.samples;
+          ret.latency /= ret.samples;
+        }
+        return ret;
+      }
+
+      /** \c _mutex must be locked. */
+      double expectedTime( const std::string & host_r, off_t bytes_r, const HostStats & typical_r ) const
+      {
+        if ( bytes_r < 0 )
+          bytes_r = TYPICALSIZE;
+
+        HostStats st;
+        auto it = _hosts.find( host_r );
+        if ( it != _hosts.end() )
+          st = it->second;
+        if ( ! st.samples )
+        {
+          if ( ! typical_r.samples )
+            return st.failures ? st.failures : 0.0;	// just failures; rank behind the rest
+          st.speed   = typical_r.speed;
+          st.latency = typical_r.latency;
+        }
+        double ret = st.latency + ( st.speed > 0 ? bytes_r / st.speed : 0 );
+        // a failing mirror costs a timeout and a retry elsewhere
+        return ret * ( 1 + st.failures );
+      }
+
+    public:
+      mutable std::mutex _mutex;
+      Pathname _file;
+      mutable bool _loaded;
+      bool _dirty;
+      Date::ValueType _lastSave;
+      mutable std::map<std::string,HostStats> _hosts;	// lazy loaded
+      FetchPlan _lastPlan;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    MirrorStats & MirrorStats::instance()
+    {
+      static MirrorStats _instance;
+      return _instance;
+    }
+
+    MirrorStats::MirrorStats( const Pathname & file_r )
+    : _pimpl( new Impl( file_r ) )
+    {}
+
+    MirrorStats::~MirrorStats()
+    {}
+
+    Pathname MirrorStats::file() const
+    {
+      std::lock_guard<std::mutex> lock( _pimpl->_mutex );
+      return _pimpl->_file;
+    }
+
+    void MirrorStats::setFile( const Pathname & file_r )
+    {
+      if ( file() == file_r )
+        return;
+      save( true );
+
+      std::lock_guard<std::mutex> lock( _pimpl->_mutex );
+      MIL << "Mirror statistics in " << file_r << endl;
+      _pimpl->_file = file_r;
+      _pimpl->_loaded = file_r.empty();
+      _pimpl->_dirty = false;
+      _pimpl->_lastSave = 0;
+      _pimpl->_hosts.clear();
+    }
+
+    void MirrorStats::addSample( const std::string & host_r, off_t bytes_r, double seconds_r, double latency_r )
+    {
+      if ( host_r.empty() || bytes_r <= 0 || seconds_r <= 0 )
+        return;
+      // the latency is part of the block time; don't count it twice
+      double transfer = seconds_r - latency_r;
+      if ( transfer < seconds_r / 10 )
+        transfer = seconds_r / 10;
+
+      std::lock_guard<std::mutex> lock( _pimpl->_mutex );
+      _pimpl->load();
+      HostStats & st( _pimpl->_hosts[host_r] );
+      st.speed   = average( st.speed, bytes_r / transfer, st.samples );
+      st.latency = average( st.latency, latency_r < 0 ? 0 : latency_r, st.samples );
+      ++st.samples;
+      st.failures /= 2;	// forgive slowly
+      st.lastUsed = Date::now();
+      _pimpl->_dirty = true;
+    }
+
+    void MirrorStats::addFailure( const std::string & host_r )
+    {
+      if ( host_r.empty() )
+        return;
+      std::lock_guard<std::mutex> lock( _pimpl->_mutex );
+      _pimpl->load();
+      HostStats & st( _pimpl->_hosts[host_r] );
+      ++st.failures;
+      st.lastUsed = Date::now();
+      _pimpl->_dirty = true;
+    }
+
+    bool MirrorStats::known( const std::string & host_r ) const
+    {
+      std::lock_guard<std::mutex> lock( _pimpl->_mutex );
+      _pimpl->load();
+      return _pimpl->_hosts.count( host_r );
+    }
+
+    MirrorStats::HostStats MirrorStats::stats( const std::string & host_r ) const
+    {
+      std::lock_guard<std::mutex> lock( _pimpl->_mutex );
+      _pimpl->load();
+      auto it = _pimpl->_hosts.find( host_r );
+      return it == _pimpl->_hosts.end() ? HostStats() : it->second;
+    }
+
+    double MirrorStats::expectedTime( const std::string & host_r, off_t bytes_r ) const
+    {
+      std::lock_guard<std::mutex> lock( _pimpl->_mutex );
+      _pimpl->load();
+      return _pimpl->expectedTime( host_r, bytes_r, _pimpl->typical() );
+    }
+
+    void MirrorStats::rank( std::vector<Url> & urls_r, off_t bytes_r ) const
+    {
+      if ( urls_r.size() < 2 )
+        return;
+
+      std::vector<std::pair<double,Url> > ranked;
+      ranked.reserve( urls_r.size() );
+      {
+        std::lock_guard<std::mutex> lock( _pimpl->_mutex );
+        _pimpl->load();
+        if ( _pimpl->_hosts.empty() )
+          return;
+        HostStats typical( _pimpl->typical() );
+        for ( const Url & url : urls_r )
+          ranked.push_back( std::make_pair( _pimpl->expectedTime( url.getHost(), bytes_r, typical ), url ) );
+      }
+      std::stable_sort( ranked.begin(), ranked.end(),
+                        []( const std::pair<double,Url> & lhs, const std::pair<double,Url> & rhs )
+                        { return lhs.first < rhs.first; } );
+      for ( unsigned i = 0; i < ranked.size(); ++i )
+        urls_r[i] = ranked[i].second;
+    }
+
+    bool MirrorStats::save( bool force_r )
+    {
+      std::lock_guard<std::mutex> lock( _pimpl->_mutex );
+      if ( ! _pimpl->_dirty || _pimpl->_file.empty() )
+        return true;
+      Date::ValueType now = Date::now();
+      if ( ! force_r && now - _pimpl->_lastSave < SAVEDELAY )
+        return true;
+      _pimpl->_lastSave = now;
+
+      filesystem::assert_dir( _pimpl->_file.dirname() );
+      Pathname tmpfile( _pimpl->_file.extend( ".new" ) );
+      {
+        std::ofstream file( tmpfile.c_str(), std::ios::trunc );
+        file << HEADER << endl;
+        for ( const auto & el : _pimpl->_hosts )
+        {
+          const HostStats & st( el.second );
+          file << el.first << ' ' << st.speed << ' ' << st.latency << ' '
+               << st.samples << ' ' << st.failures << ' ' << Date::ValueType(st.lastUsed) << endl;
+        }
+        if ( ! file )
+        {
+          DBG << "Can't write " << tmpfile << endl;	// e.g. not root
+          filesystem::unlink( tmpfile );
+          return false;
+        }
+      }
+      if ( filesystem::rename( tmpfile, _pimpl->_file ) != 0 )
+      {
+        filesystem::unlink( tmpfile );
+        return false;
+      }
+      _pimpl->_dirty = false;
+      return true;
+    }
+
+    MirrorStats::FetchPlan MirrorStats::lastPlan() const
+    {
+      std::lock_guard<std::mutex> lock( _pimpl->_mutex );
+      return _pimpl->_lastPlan;
+    }
+
+    void MirrorStats::setLastPlan( const FetchPlan & plan_r )
+    {
+      std::lock_guard<std::mutex> lock( _pimpl->_mutex );
+      _pimpl->_lastPlan = plan_r;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const MirrorStats & obj )
+    {
+      std::lock_guard<std::mutex> lock( obj._pimpl->_mutex );
+      obj._pimpl->load();
+      str << "MirrorStats(" << obj._pimpl->_file << ") {" << endl;
+      for ( const auto & el : obj._pimpl->_hosts )
+        str << "  " << el.first << ": " << el.second << endl;
+      return str << "}";
+    }
+
+    std::ostream & operator<<( std::ostream & str, const MirrorStats::HostStats & obj )
+    {
+      return str << str::form( "%.1fKiB/s %.0fms ", obj.speed / 1024, obj.latency * 1000 )
+                 << obj.samples << " samples " << obj.failures << " failures";
+    }
+
+    std::ostream & operator<<( std::ostream & str, const MirrorStats::FetchPlan & obj )
+    {
+      str << "FetchPlan(" << obj.filename << ", " << obj.filesize << " bytes (" << obj.reused << " reused), "
+          << obj.mirrors.size() << " mirrors, max " << obj.maxMirrors << ", blocks "
+          << obj.minBlocksize << "-" << obj.maxBlocksize << ", " << obj.elapsed << "s) {" << endl;
+      for ( const auto & m : obj.mirrors )
+      {
+        str << "  " << ( m.used ? ( m.failed ? "FAIL " : "USED " ) : "     " ) << m.url.getHost()
+            << " expected " << m.expectedTime << "s received " << m.received << " in " << m.blocks << " blocks" << endl;
+      }
+      return str << "}";
+    }
+
+  } // namespace media
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,175 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/media/MirrorStats.h
+ *
+*/
+#ifndef ZYPP_MEDIA_MIRRORSTATS_H
+#define ZYPP_MEDIA_MIRRORSTATS_H
+
+#include <sys/types.h>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "zypp/base/PtrTypes.h"
+#include "zypp/Date.h"
+#include "zypp/Pathname.h"
+#include "zypp/Url.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace media
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class MirrorStats
+    /// \brief Per host download statistics used to rank mirrors.
+    ///
+    /// \ref MediaMultiCurl records the throughput and latency of each block
+    /// fetched from a mirror (and failing mirrors). Mirrors are then tried in
+    /// order of their expected completion time for the file to download,
+    /// rather than in plain metalink order. The statistics are kept across
+    /// runs in \ref ZConfig::repoCachePath <tt>/mirrorstats</tt>.
+    ///
+    /// The \ref FetchPlan of the most recent download tells which mirrors were
+    /// chosen and what they actually delivered.
+    ///
+    /// \note Thread safe.
+    ///////////////////////////////////////////////////////////////////
+    class MirrorStats
+    {
+      friend std::ostream & operator<<( std::ostream & str, const MirrorStats & obj );
+
+    public:
+      /** What we know about a host. */
+      struct HostStats
+      {
+        HostStats()
+        : speed( 0 ), latency( 0 ), samples( 0 ), failures( 0 )
+        {}
+        double   speed;		//!< average throughput (bytes/s)
+        double   latency;	//!< average time to first byte (s)
+        unsigned samples;	//!< number of blocks measured
+        unsigned failures;	//!< (decaying) number of failed transfers
+        Date     lastUsed;
+      };
+
+      /** The mirrors chosen for a download and how they performed. */
+      struct FetchPlan
+      {
+        struct Mirror
+        {
+          Mirror()
+          : expectedTime( 0 ), received( 0 ), blocks( 0 ), used( false ), failed( false )
+          {}
+          Url      url;
+          double   expectedTime;	//!< predicted time for the whole file (s, 0 if unknown)
+          off_t    received;		//!< bytes actually received
+          unsigned blocks;		//!< blocks successfully fetched
+          bool     used;		//!< whether a worker was started for it
+          bool     failed;		//!< whether the mirror was given up
+        };
+
+        FetchPlan()
+        : filesize( -1 ), reused( 0 ), maxMirrors( 0 ), minBlocksize( 0 ), maxBlocksize( 0 ), elapsed( 0 )
+        {}
+        Pathname            filename;
+        off_t               filesize;		//!< -1 if unknown
+        off_t               reused;		//!< bytes taken from local files rather than downloaded
+        unsigned            maxMirrors;		//!< at most this many mirrors are used
+        size_t              minBlocksize;	//!< smallest block requested
+        size_t              maxBlocksize;	//!< largest block requested
+        double              elapsed;		//!< download time (s)
+        std::vector<Mirror> mirrors;		//!< in the order they are tried
+      };
+
+    public:
+      /** The statistics shared by all downloads.
+       * They are kept in memory only until a \ref RepoManager assigns
+       * the file in its repo cache (\ref setFile). So a target root
+       * passed in the \ref RepoManagerOptions is honoured.
+       */
+      static MirrorStats & instance();
+
+      /** Ctor using (and later saving to) \a file_r. An empty path keeps the statistics in memory only. */
+      explicit MirrorStats( const Pathname & file_r = Pathname() );
+
+      /** Dtor. Pending changes are not saved, call \ref save before. */
+      ~MirrorStats();
+
+    public:
+      /** The file the statistics are read from and saved to. */
+      Pathname file() const;
+
+      /** Use \a file_r from now on.
+       * Pending changes are saved to the old file, the statistics
+       * in \a file_r are lazy loaded on next use.
+       */
+      void setFile( const Pathname & file_r );
+
+    public:
+      /** Record \a bytes_r received from \a host_r in \a seconds_r, the first one after \a latency_r seconds. */
+      void addSample( const std::string & host_r, off_t bytes_r, double seconds_r, double latency_r );
+
+      /** Record a failed transfer from \a host_r. */
+      void addFailure( const std::string & host_r );
+
+      /** Whether anything is known about \a host_r. */
+      bool known( const std::string & host_r ) const;
+
+      /** The statistics of \a host_r (all \c 0 if unknown). */
+      HostStats stats( const std::string & host_r ) const;
+
+      /** The expected time (s) to fetch \a bytes_r from \a host_r.
+       * Unknown hosts are assumed to perform like the average known host.
+       * \return \c 0 if there is nothing to base a guess on.
+       */
+      double expectedTime( const std::string & host_r, off_t bytes_r ) const;
+
+      /** Stable sort \a urls_r by the expected time to fetch \a bytes_r from them.
+       * Without statistics the order is not changed. If \a bytes_r is unknown
+       * (\c -1) a typical package size is assumed.
+       */
+      void rank( std::vector<Url> & urls_r, off_t bytes_r ) const;
+
+    public:
+      /** Write the statistics if they changed (and, unless \a force_r, the last save was a while ago).
+       * \return \c false if writing failed.
+       */
+      bool save( bool force_r = false );
+
+    public:
+      /** The \ref FetchPlan of the most recent download. */
+      FetchPlan lastPlan() const;
+
+      /** Remember \a plan_r as the most recent one. */
+      void setLastPlan( const FetchPlan & plan_r );
+
+    public:
+      class Impl;
+    private:
+      RW_pointer<Impl> _pimpl;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    /** \relates MirrorStats Stream output */
+    std::ostream & operator<<( std::ostream & str, const MirrorStats & obj );
+
+    /** \relates MirrorStats::HostStats Stream output */
+    std::ostream & operator<<( std::ostream & str, const MirrorStats::HostStats & obj );
+
+    /** \relates MirrorStats::FetchPlan Stream output */
+    std::ostream & operator<<( std::ostream & str, const MirrorStats::FetchPlan & obj );
+
+  } // namespace media
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_MEDIA_MIRRORSTATS_H
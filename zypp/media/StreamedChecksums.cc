@@ -0,0 +1,96 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/media/StreamedChecksums.cc
+ *
+*/
+#include <sys/stat.h>
+#include <map>
+#include <mutex>
+
+#include "zypp/base/String.h"
+#include "zypp/media/StreamedChecksums.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace media
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      /** Identifies the content of a file as long as it is not modified. */
+      struct StreamedChecksumEntry
+      {
+        off_t    size;
+        timespec mtime;
+        CheckSum checksum;
+      };
+      typedef std::map<std::pair<dev_t,ino_t>, StreamedChecksumEntry> StreamedChecksumMap;
+
+      inline StreamedChecksumMap & streamedChecksumMap()
+      {
+        static StreamedChecksumMap _map;
+        return _map;
+      }
+
+      /** Guards \ref streamedChecksumMap (downloads may run in parallel). */
+      inline std::mutex & streamedChecksumMutex()
+      {
+        static std::mutex _mutex;
+        return _mutex;
+      }
+
+      /** Never remember more than this (a checksum is verified right after download). */
+      const StreamedChecksumMap::size_type streamedChecksumMapMax = 256;
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    void StreamedChecksums::remember( const Pathname & file_r, const CheckSum & checksum_r )
+    {
+      struct stat st;
+      if ( checksum_r.empty() || ::stat( file_r.c_str(), &st ) != 0 )
+        return;
+
+      std::lock_guard<std::mutex> guard( streamedChecksumMutex() );
+      StreamedChecksumMap & map( streamedChecksumMap() );
+      if ( map.size() >= streamedChecksumMapMax )
+        map.clear();
+      map[std::make_pair( st.st_dev, st.st_ino )] = StreamedChecksumEntry{ st.st_size, st.st_mtim, checksum_r };
+    }
+
+    CheckSum StreamedChecksums::lookup( const Pathname & file_r, const std::string & type_r )
+    {
+      struct stat st;
+      if ( ::stat( file_r.c_str(), &st ) != 0 )
+        return CheckSum();
+
+      std::lock_guard<std::mutex> guard( streamedChecksumMutex() );
+      StreamedChecksumMap & map( streamedChecksumMap() );
+      StreamedChecksumMap::iterator it( map.find( std::make_pair( st.st_dev, st.st_ino ) ) );
+      if ( it == map.end() )
+        return CheckSum();
+
+      const StreamedChecksumEntry & entry( it->second );
+      if ( entry.size != st.st_size
+           || entry.mtime.tv_sec != st.st_mtim.tv_sec
+           || entry.mtime.tv_nsec != st.st_mtim.tv_nsec )
+      {
+        map.erase( it );	// modified meanwhile
+        return CheckSum();
+      }
+      if ( entry.checksum.type() != str::toLower( type_r ) )
+        return CheckSum();
+      return entry.checksum;
+    }
+
+  } // namespace media
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
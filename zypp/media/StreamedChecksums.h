@@ -0,0 +1,52 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/media/StreamedChecksums.h
+ * Internal, not installed.
+*/
+#ifndef ZYPP_MEDIA_STREAMEDCHECKSUMS_H
+#define ZYPP_MEDIA_STREAMEDCHECKSUMS_H
+
+#include <string>
+
+#include "zypp/Pathname.h"
+#include "zypp/CheckSum.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace media
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class StreamedChecksums
+    /// \brief Checksums computed while a file was downloaded.
+    ///
+    /// \ref MediaCurl computes the digest of a file while receiving it and
+    /// remembers it here. \ref ChecksumFileChecker then uses it instead of
+    /// reading the whole file again. An entry is used only as long as the
+    /// file (device, inode, size and mtime) did not change, so hardlinked
+    /// copies of the file are found too.
+    ///
+    /// The registry is thread safe. It must only be fed by the media layer
+    /// with checksums of data it actually received.
+    ///////////////////////////////////////////////////////////////////
+    class StreamedChecksums
+    {
+    public:
+      /** Remember \a checksum_r was computed for the current content of \a file_r. */
+      static void remember( const Pathname & file_r, const CheckSum & checksum_r );
+      /** The remembered checksum of type \a type_r for \a file_r (or an empty one). */
+      static CheckSum lookup( const Pathname & file_r, const std::string & type_r );
+    };
+
+  } // namespace media
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_MEDIA_STREAMEDCHECKSUMS_H
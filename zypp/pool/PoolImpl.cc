@@ -10,8 +10,10 @@
  *
 */
 #include <iostream>
+#include <algorithm>
 #include "zypp/base/LogTools.h"
 
+#include "zypp/sat/detail/PoolImpl.h"
 #include "zypp/pool/PoolImpl.h"
 
 using std::endl;
@@ -36,6 +38,9 @@ namespace zypp
     //	METHOD TYPE : Ctor
     //
     PoolImpl::PoolImpl()
+    : _status( 1 )
+    , _savedStatus( 1 )
+    , _buddy( 1, sat::detail::noId )
     {}
 
     ///////////////////////////////////////////////////////////////////
@@ -46,6 +51,227 @@ namespace zypp
     PoolImpl::~PoolImpl()
     {}
 
+    namespace
+    {
+      /** \ref PoolImpl::id2item key: srcpackages use the negative ident. */
+      inline sat::detail::IdType id2itemKey( const sat::Solvable & slv_r )
+      {
+        sat::detail::IdType id = slv_r.ident().id();
+        return slv_r.isKind( ResKind::srcpackage ) ? -id : id;
+      }
+    } // namespace
+
+    const PoolImpl::ContainerT & PoolImpl::store() const
+    {
+      checkSerial();
+      if ( _storeDirty )
+      {
+        sat::Pool pool( satpool() );
+        bool addedItems = false;
+        bool removedItems = false;
+        bool reusedIDs = _watcherIDs.remember( pool.serialIDs() );
+        std::list<PoolItem> addedProducts;
+        std::vector<PoolItem> newItems;
+
+        // Compare the repos solvable id ranges to the ones we saw last time.
+        // Only ranges of added, removed or changed repos need to be visited.
+        std::vector<RepoRange> repoRanges;
+        repoRanges.reserve( pool.reposSize() );
+        for_( it, pool.reposBegin(), pool.reposEnd() )
+        {
+          RepoRange r = { it->id(), it->satInternalSolvableIdBegin(), it->satInternalSolvableIdEnd(), unsigned(it->solvablesSize()),
+                          it->satInternalPriority(), it->satInternalSubPriority() };
+          repoRanges.push_back( r );
+        }
+
+        typedef std::pair<SolvableIdType,SolvableIdType> IdRange;	// [begin,end)
+        std::vector<IdRange> dirty;
+        bool prioritiesChanged = false;
+        size_type capacity = pool.capacity();
+
+        if ( reusedIDs || _repoRanges.empty() )
+        {
+          dirty.push_back( IdRange( 1, std::max( capacity, _store.size() ) ) );
+          invalidate();	// id2item and proxy need a full rebuild
+        }
+        else
+        {
+          for ( const RepoRange & o : _repoRanges )
+          {
+            auto n( std::find_if( repoRanges.begin(), repoRanges.end(), [&o]( const RepoRange & r ) { return r.sameRange( o ); } ) );
+            if ( n == repoRanges.end() )
+              dirty.push_back( IdRange( o._begin, o._end ) );
+            else if ( ! n->samePriority( o ) )
+              prioritiesChanged = true;
+          }
+          for ( const RepoRange & n : repoRanges )
+          {
+            if ( std::find_if( _repoRanges.begin(), _repoRanges.end(), [&n]( const RepoRange & r ) { return r.sameRange( n ); } ) == _repoRanges.end() )
+              dirty.push_back( IdRange( n._begin, n._end ) );
+          }
+          if ( capacity != _store.size() )
+            dirty.push_back( IdRange( std::min( capacity, _store.size() ), std::max( capacity, _store.size() ) ) );
+        }
+        _repoRanges.swap( repoRanges );
+
+        if ( capacity > _store.size() )
+        {
+          _store.resize( capacity );
+          resizeItemTables( capacity );
+        }
+
+        for ( const IdRange & range : dirty )
+        {
+          SolvableIdType begin = std::max( range.first, SolvableIdType(1) );
+          SolvableIdType end = std::min( range.second, SolvableIdType(_store.size()) );
+          for ( SolvableIdType i = end; i-- > begin; )
+          {
+            sat::Solvable s( i < capacity ? sat::Solvable( i ) : sat::Solvable::noSolvable );
+            PoolItem & pi( _store[i] );
+            if ( ! s &&  pi )
+            {
+              // the PoolItem got invalidated (e.g unloaded repo)
+              pi = PoolItem();
+              clearItem( i );
+              removedItems = true;
+            }
+            else if ( reusedIDs || (s && ! pi) )
+            {
+              // new PoolItem to add
+              pi = PoolItem::makePoolItem( s ); // the only way to create a new one!
+              clearItem( i );
+              _status[i] = ResStatus( s.isSystem() );
+              // remember products for buddy processing (requires clean store)
+              if ( s.isKind( ResKind::product ) )
+                addedProducts.push_back( pi );
+              if ( s )
+                newItems.push_back( pi );
+              if ( !addedItems )
+                addedItems = true;
+            }
+          }
+        }
+
+        if ( capacity < _store.size() )
+        {
+          _store.resize( capacity );
+          resizeItemTables( capacity );
+        }
+        _storeDirty = false;
+        DBG << "Store updated: " << dirty.size() << " id ranges, " << newItems.size() << " new items"
+            << ( removedItems ? ", some removed" : "" ) << endl;
+
+        // Now, as the pool is adjusted, ....
+
+        // .... we check for product buddies.
+        if ( ! addedProducts.empty() )
+        {
+          for_( it, addedProducts.begin(), addedProducts.end() )
+          {
+            setBuddy( *it, asKind<Product>(*it)->referencePackage() );
+          }
+        }
+
+        // .... we maintain the ident index and selectables.
+        if ( ! _id2itemDirty && ( removedItems || ! newItems.empty() ) )
+          updateId2item( removedItems, newItems );
+        if ( prioritiesChanged )
+        {
+          // selectables sort their available items by repo priority
+          _poolProxy.reset();
+          _proxyChangedIdents.clear();
+        }
+
+        // .... we must reapply those query based hard locks.
+        if ( addedItems )
+        {
+          reapplyHardLocks( newItems );
+        }
+      }
+      return _store;
+    }
+
+    const PoolImpl::Id2ItemT & PoolImpl::id2item() const
+    {
+      store();
+      if ( _id2itemDirty )
+      {
+        _id2item = Id2ItemT( size() );
+        for_( it, begin(), end() )
+        {
+          _id2item.insert( std::make_pair( id2itemKey( it->satSolvable() ), *it ) );
+        }
+        //INT << _id2item << endl;
+        _id2itemDirty = false;
+      }
+      return _id2item;
+    }
+
+    void PoolImpl::updateId2item( bool removedItems_r, const std::vector<PoolItem> & addedItems_r ) const
+    {
+      if ( removedItems_r )
+      {
+        for ( Id2ItemT::iterator it = _id2item.begin(); it != _id2item.end(); )
+        {
+          SolvableIdType id = it->second.id();
+          if ( id < _store.size() && _store[id] == it->second )
+            ++it;
+          else
+          {
+            if ( _poolProxy )
+              _proxyChangedIdents.insert( it->first );
+            it = _id2item.erase( it );
+          }
+        }
+      }
+      for ( const PoolItem & pi : addedItems_r )
+      {
+        sat::detail::IdType key = id2itemKey( pi.satSolvable() );
+        _id2item.insert( std::make_pair( key, pi ) );
+        if ( _poolProxy )
+          _proxyChangedIdents.insert( key );
+      }
+    }
+
+    void PoolImpl::resizeItemTables( size_type size_r ) const
+    {
+      if ( size_r < 1 )
+        size_r = 1; // slot 0 for empty PoolItems
+      _status.resize( size_r );
+      _savedStatus.resize( size_r );
+      _buddy.resize( size_r, sat::detail::noId );
+    }
+
+    void PoolImpl::clearItem( SolvableIdType id_r ) const
+    {
+      sat::detail::IdType buddy = _buddy[id_r];
+      if ( buddy )
+      {
+        SolvableIdType other = ( buddy < 0 ? -buddy : buddy );
+        if ( other < _buddy.size() )
+          _buddy[other] = sat::detail::noId;
+        _buddy[id_r] = sat::detail::noId;
+      }
+      _status[id_r] = ResStatus();
+      _savedStatus[id_r] = ResStatus();
+    }
+
+    void PoolImpl::setBuddy( const PoolItem & pi_r, const sat::Solvable & buddy_r ) const
+    {
+      if ( ! ( buddy_r && buddy_r.id() < _store.size() && _store[buddy_r.id()] ) )
+        return;
+
+      const PoolItem & myBuddy( _store[buddy_r.id()] );
+      if ( _buddy[buddy_r.id()] )
+      {
+        ERR << pi_r << " would be buddy2 in " << myBuddy << endl;
+        return;
+      }
+      _buddy[buddy_r.id()] = -pi_r.id();
+      _buddy[pi_r.id()] = buddy_r.id();
+      DBG << pi_r << " has buddy " << myBuddy << endl;
+    }
+
     /////////////////////////////////////////////////////////////////
   } // namespace pool
   ///////////////////////////////////////////////////////////////////
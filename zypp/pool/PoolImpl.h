@@ -13,6 +13,11 @@
 #define ZYPP_POOL_POOLIMPL_H
 
 #include <iosfwd>
+#include <algorithm>
+#include <deque>
+#include <set>
+#include <unordered_set>
+#include <vector>
 
 #include "zypp/base/Easy.h"
 #include "zypp/base/LogTools.h"
@@ -24,6 +29,7 @@
 #include "zypp/PoolQueryResult.h"
 
 #include "zypp/sat/Pool.h"
+#include "zypp/sat/SolvableMap.h"
 #include "zypp/Product.h"
 
 using std::endl;
@@ -177,23 +183,147 @@ namespace zypp
         //
         ///////////////////////////////////////////////////////////////////
       public:
-        /** \name Save and restore state. */
+        /** \name Save and restore state.
+         * Linear passes over the status table; per kind
+         * save/restore iterates the \ref PoolItem.
+         */
         //@{
-        void SaveState( const ResKind & kind_r );
+        void saveState() const
+        {
+          const ContainerT & mystore( store() );
+          for ( SolvableIdType i = 1; i < mystore.size(); ++i )
+          {
+            if ( mystore[i] )
+              _savedStatus[i] = itemStatus( i );
+          }
+        }
+
+        void restoreState() const
+        {
+          const ContainerT & mystore( store() );
+          for ( SolvableIdType i = 1; i < mystore.size(); ++i )
+          {
+            if ( mystore[i] )
+              itemStatus( i ) = _savedStatus[i];
+          }
+        }
+
+        /** Whether some items status differs from the saved one (\see \ref sameStatus). */
+        bool diffState() const
+        {
+          const ContainerT & mystore( store() );
+          for ( SolvableIdType i = 1; i < mystore.size(); ++i )
+          {
+            if ( mystore[i] && ! sameStatus( itemStatus( i ), _savedStatus[i] ) )
+              return true;
+          }
+          return false;
+        }
+        //@}
+
+        ///////////////////////////////////////////////////////////////////
+        //
+        ///////////////////////////////////////////////////////////////////
+      public:
+        /** \name PoolItem status table.
+         * The \ref ResStatus of all \ref PoolItem is kept here, indexed by
+         * solvable id, so full pool status sweeps are linear passes over
+         * dense storage. Slot \c 0 is used by empty and stale \ref PoolItem
+         * (\see \ref itemId).
+         * Buddies (\ref PoolItem::buddy) are kept in a side table:
+         * \li \c ==0 no buddy
+         * \li \c >0 this uses the buddies status
+         * \li \c <0 this status is used by \c -buddy
+         */
+        //@{
+        /** The \ref PoolImpl behind \ref ResPool::instance. */
+        static PoolImpl & instance();
+
+        /** The table id of \a pi_r.
+         * \c 0 for an empty \ref PoolItem and a stale one, whose solvable
+         * was removed from the pool (and its id maybe reused).
+         */
+        SolvableIdType itemId( const PoolItem & pi_r ) const
+        {
+          SolvableIdType id = pi_r.id();
+          return ( id < _store.size() && _store[id].resolvable() == pi_r.resolvable() ) ? id : 0;
+        }
+
+        /** The detached \ref ResStatus of empty and stale \ref PoolItem.
+         * Slot \c 0; reset on each request, so changes are discarded.
+         */
+        ResStatus & detachedStatus() const
+        {
+          _status[0] = ResStatus();
+          return _status[0];
+        }
+
+        /** The items \ref ResStatus (or the one it shares with its buddy). */
+        ResStatus & itemStatus( SolvableIdType id_r ) const
+        {
+          if ( id_r >= _buddy.size() )
+            return _status[0];
+          sat::detail::IdType buddy = _buddy[id_r];
+          return _status[ buddy > 0 ? buddy : id_r ];
+        }
+
+        /** The items own \ref ResStatus, even if it has a buddy. */
+        ResStatus & itemOwnStatus( SolvableIdType id_r ) const
+        { return _status[ id_r < _status.size() ? id_r : 0 ]; }
+
+        /** The items saved \ref ResStatus (\see \ref saveState). */
+        ResStatus & itemSavedStatus( SolvableIdType id_r ) const
+        { return _savedStatus[ id_r < _savedStatus.size() ? id_r : 0 ]; }
+
+        /** The items buddy. */
+        sat::Solvable itemBuddy( SolvableIdType id_r ) const
+        {
+          sat::detail::IdType buddy = ( id_r < _buddy.size() ? _buddy[id_r] : sat::detail::noId );
+          return sat::Solvable( buddy < 0 ? -buddy : buddy );
+        }
 
-        void RestoreState( const ResKind & kind_r );
+        /** Whether \a status_r is the same as \a saved_r (ignoring solver changes). */
+        static bool sameStatus( const ResStatus & status_r, const ResStatus & saved_r )
+        {
+          if ( status_r == saved_r )
+            return true;
+          // some bits changed...
+          if ( status_r.getTransactValue() != saved_r.getTransactValue()
+               && ( ! status_r.isBySolver() // ignore solver state changes
+                    // removing a user lock also goes to bySolver
+                    || saved_r.getTransactValue() == ResStatus::LOCKED ) )
+            return false;
+          if ( status_r.isLicenceConfirmed() != saved_r.isLicenceConfirmed() )
+            return false;
+          return true;
+        }
         //@}
 
+      private:
+        /** Adjust the item tables to the pools capacity. */
+        void resizeItemTables( size_type size_r ) const;
+        /** Reset the item tables entries for \a id_r (dissolving any buddy relation). */
+        void clearItem( SolvableIdType id_r ) const;
+        /** Let \a pi_r share the status of \a buddy_r. */
+        void setBuddy( const PoolItem & pi_r, const sat::Solvable & buddy_r ) const;
+
         ///////////////////////////////////////////////////////////////////
         //
         ///////////////////////////////////////////////////////////////////
       public:
         ResPoolProxy proxy( ResPool self ) const
         {
-          checkSerial();
+          store(); // process pending pool changes
           if ( !_poolProxy )
           {
             _poolProxy.reset( new ResPoolProxy( self, *this ) );
+            _proxyChangedIdents.clear();
+          }
+          else if ( ! _proxyChangedIdents.empty() )
+          {
+            // rebuild only selectables whose ident gained or lost items
+            _poolProxy.reset( new ResPoolProxy( *_poolProxy, _proxyChangedIdents, *this ) );
+            _proxyChangedIdents.clear();
           }
           return *_poolProxy;
         }
@@ -222,22 +352,48 @@ namespace zypp
         const HardLockQueries & hardLockQueries() const
         { return _hardLockQueries; }
 
-        void reapplyHardLocks() const
+        /** Add the query result to the pool-sized \a locked_r (like \ref PoolQueryResult, ignoring exceptions). */
+        static void addHardLockQueryResult( sat::SolvableMap & locked_r, const PoolQuery & query_r )
+        {
+          try
+          {
+            locked_r.insert( query_r.begin(), query_r.end() );
+          }
+          catch ( const Exception & )
+          {}
+        }
+
+        void reapplyHardLocks( const std::vector<PoolItem> & newItems_r ) const
         {
           // It is assumed that reapplyHardLocks is called after new
           // items were added to the pool, but the _hardLockQueries
           // did not change since. Action is to be performed only on
           // those items that gained the bit in the UserLockQueryField.
-          MIL << "Re-apply " << _hardLockQueries.size() << " HardLockQueries" << endl;
-          PoolQueryResult locked;
+          // So the queries need to look into the new items repos only.
+          std::set<std::string> aliases;
+          for ( const PoolItem & pi : newItems_r )
+            aliases.insert( pi.repository().alias() );
+          MIL << "Re-apply " << _hardLockQueries.size() << " HardLockQueries in " << aliases.size() << " repos" << endl;
+          sat::SolvableMap locked;
           for_( it, _hardLockQueries.begin(), _hardLockQueries.end() )
           {
-            locked += *it;
+            const PoolQuery::StrContainer & repos( it->repos() );
+            if ( repos.empty() )
+            {
+              PoolQuery query( *it );	// the compiled query is shared
+              for ( const std::string & alias : aliases )
+                query.addRepo( alias );
+              addHardLockQueryResult( locked, query );
+            }
+            else if ( std::any_of( repos.begin(), repos.end(), [&aliases]( const std::string & alias_r ) { return aliases.count( alias_r ); } ) )
+            {
+              addHardLockQueryResult( locked, *it );
+            }
           }
           MIL << "HardLockQueries match " << locked.size() << " Solvables." << endl;
-          for_( it, begin(), end() )
+          for ( const PoolItem & pi : newItems_r )
           {
-            resstatus::UserLockQueryManip::reapplyLock( it->status(), locked.contains( *it ) );
+            resstatus::UserLockQueryManip::reapplyLock( itemStatus( pi.id() ), locked.contains( pi.satSolvable() ) );
           }
         }
 
@@ -246,15 +402,17 @@ namespace zypp
           MIL << "Apply " << newLocks_r.size() << " HardLockQueries" << endl;
           _hardLockQueries = newLocks_r;
           // now adjust the pool status
-          PoolQueryResult locked;
+          sat::SolvableMap locked;
           for_( it, _hardLockQueries.begin(), _hardLockQueries.end() )
           {
-            locked += *it;
+            addHardLockQueryResult( locked, *it );
           }
           MIL << "HardLockQueries match " << locked.size() << " Solvables." << endl;
-          for_( it, begin(), end() )
+          const ContainerT & mystore( store() );
+          for ( SolvableIdType i = 1; i < mystore.size(); ++i )
           {
-            resstatus::UserLockQueryManip::setLock( it->status(), locked.contains( *it ) );
+            if ( mystore[i] )
+              resstatus::UserLockQueryManip::setLock( itemStatus( i ), locked.contains( sat::Solvable( i ) ) );
           }
         }
 
@@ -267,17 +425,20 @@ namespace zypp
           typedef std::unordered_set<IdString> IdentSet;
           IdentSet addedLocks;
           IdentSet removedLocks;
-          for_( it, begin(), end() )
+          const ContainerT & mystore( store() );
+          for ( SolvableIdType i = 1; i < mystore.size(); ++i )
           {
-            switch ( resstatus::UserLockQueryManip::diffLock( it->status() ) )
+            if ( ! mystore[i] )
+              continue;
+            switch ( resstatus::UserLockQueryManip::diffLock( itemStatus( i ) ) )
             {
               case 0:  // unchanged
                 break;
               case 1:
-                addedLocks.insert( it->satSolvable().ident() );
+                addedLocks.insert( sat::Solvable( i ).ident() );
                 break;
               case -1:
-                removedLocks.insert( it->satSolvable().ident() );
+                removedLocks.insert( sat::Solvable( i ).ident() );
                break;
             }
           }
@@ -299,83 +460,16 @@ namespace zypp
        }
 
       public:
-        const ContainerT & store() const
-        {
-          checkSerial();
-          if ( _storeDirty )
-          {
-            sat::Pool pool( satpool() );
-            bool addedItems = false;
-	    bool reusedIDs = _watcherIDs.remember( pool.serialIDs() );
-            std::list<PoolItem> addedProducts;
-
-	    _store.resize( pool.capacity() );
-
-            if ( pool.capacity() )
-            {
-              for ( sat::detail::SolvableIdType i = pool.capacity()-1; i != 0; --i )
-              {
-                sat::Solvable s( i );
-                PoolItem & pi( _store[i] );
-                if ( ! s &&  pi )
-                {
-                  // the PoolItem got invalidated (e.g unloaded repo)
-                  pi = PoolItem();
-                }
-                else if ( reusedIDs || (s && ! pi) )
-                {
-                  // new PoolItem to add
-                  pi = PoolItem::makePoolItem( s ); // the only way to create a new one!
-                  // remember products for buddy processing (requires clean store)
-                  if ( s.isKind( ResKind::product ) )
-                    addedProducts.push_back( pi );
-                  if ( !addedItems )
-                    addedItems = true;
-                }
-              }
-            }
-            _storeDirty = false;
-
-            // Now, as the pool is adjusted, ....
-
-            // .... we check for product buddies.
-            if ( ! addedProducts.empty() )
-            {
-              for_( it, addedProducts.begin(), addedProducts.end() )
-              {
-                it->setBuddy( asKind<Product>(*it)->referencePackage() );
-              }
-            }
-
-            // .... we must reapply those query based hard locks.
-            if ( addedItems )
-            {
-              reapplyHardLocks();
-            }
-          }
-          return _store;
-        }
+        /** The \ref PoolItem store, indexed by solvable id.
+         * Maintained incrementally: after a pool change only the solvable
+         * id ranges of added, removed or changed repositories are visited.
+         */
+        const ContainerT & store() const;
 
-	const Id2ItemT & id2item () const
-	{
-	  checkSerial();
-	  if ( _id2itemDirty )
-	  {
-	    store();
-	    _id2item = Id2ItemT( size() );
-            for_( it, begin(), end() )
-            {
-              const sat::Solvable &s = (*it)->satSolvable();
-              sat::detail::IdType id = s.ident().id();
-              if ( s.isKind( ResKind::srcpackage ) )
-                id = -id;
-              _id2item.insert( std::make_pair( id, *it ) );
-            }
-            //INT << _id2item << endl;
-	    _id2itemDirty = false;
-          }
-	  return _id2item;
-	}
+        /** The ident index (srcpackages use the negative ident id).
+         * Also maintained incrementally once built.
+         */
+        const Id2ItemT & id2item() const;
 
         ///////////////////////////////////////////////////////////////////
         //
@@ -384,7 +478,7 @@ namespace zypp
         void checkSerial() const
         {
           if ( _watcher.remember( serial() ) )
-            invalidate();
+            _storeDirty = true;	// store() will figure out what changed
           satpool().prepare(); // always ajust dependencies.
         }
 
@@ -394,8 +488,28 @@ namespace zypp
 	  _id2itemDirty = true;
 	  _id2item.clear();
           _poolProxy.reset();
+          _proxyChangedIdents.clear();
         }
 
+        /** Update the \ref id2item index after \ref store dropped and/or added items. */
+        void updateId2item( bool removedItems_r, const std::vector<PoolItem> & addedItems_r ) const;
+
+        /** A repos solvable id range and priorities as seen by the last \ref store update. */
+        struct RepoRange
+        {
+          sat::detail::RepoIdType _repo;
+          SolvableIdType _begin;
+          SolvableIdType _end;
+          unsigned _size;
+          int _priority;
+          int _subpriority;
+
+          bool sameRange( const RepoRange & rhs ) const
+          { return _repo == rhs._repo && _begin == rhs._begin && _end == rhs._end && _size == rhs._size; }
+          bool samePriority( const RepoRange & rhs ) const
+          { return _priority == rhs._priority && _subpriority == rhs._subpriority; }
+        };
+
       private:
         /** Watch sat pools serial number. */
         SerialNumberWatcher                   _watcher;
@@ -406,8 +520,21 @@ namespace zypp
 	mutable Id2ItemT		      _id2item;
         mutable DefaultIntegral<bool,true>    _id2itemDirty;
 
+      private:
+        /** PoolItem status table; a deque as growing must not invalidate
+         * \c ResStatus& handed out by \ref PoolItem::status. */
+        mutable std::deque<ResStatus>         _status;
+        mutable std::deque<ResStatus>         _savedStatus;
+        /** Buddy side table (\see \ref itemStatus). */
+        mutable std::vector<sat::detail::IdType> _buddy;
+
+        /** Repo ranges seen by the last \ref store update (empty: full update needed). */
+        mutable std::vector<RepoRange>        _repoRanges;
+
       private:
         mutable shared_ptr<ResPoolProxy>      _poolProxy;
+        /** Idents (\ref id2item keys) whose items changed since \ref _poolProxy was built. */
+        mutable std::unordered_set<sat::detail::IdType> _proxyChangedIdents;
 
       private:
         /** Set of queries that define hardlocks. */
@@ -9,7 +9,27 @@
 /** \file	zypp/source/Applydeltarpm.cc
  *
 */
+extern "C"
+{
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+}
+#include <cerrno>
+#include <cstdio>
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "zypp/base/Logger.h"
 #include "zypp/base/String.h"
@@ -19,6 +39,10 @@
 #include "zypp/AutoDispose.h"
 #include "zypp/PathInfo.h"
 #include "zypp/TriBool.h"
+#include "zypp/Digest.h"
+#include "zypp/ZConfig.h"
+
+extern char ** environ;
 
 using std::endl;
 
@@ -32,7 +56,20 @@ namespace zypp
     namespace
     { /////////////////////////////////////////////////////////////////
 
-      const Pathname   applydeltarpm_prog( "/usr/bin/applydeltarpm" );
+      /** The program to run; the testsuite may use a fake one ($ZYPP_TESTSUITE_APPLYDELTARPM). */
+      const Pathname & applydeltarpm_prog()
+      {
+        static const Pathname _prog( [](){
+          const char * fake = getenv( "ZYPP_TESTSUITE_APPLYDELTARPM" );
+          if ( fake && *fake )
+          {
+            WAR << "ZYPP_TESTSUITE_APPLYDELTARPM: using " << fake << endl;
+            return Pathname( fake );
+          }
+          return Pathname( "/usr/bin/applydeltarpm" );
+        }() );
+        return _prog;
+      }
       const str::regex applydeltarpm_tick ( "([0-9]+) percent finished" );
 
       /******************************************************************
@@ -57,6 +94,351 @@ namespace zypp
         return( prog.close() == 0 );
       }
 
+      ///////////////////////////////////////////////////////////////////
+      // background reconstruction
+      ///////////////////////////////////////////////////////////////////
+
+      typedef std::chrono::steady_clock Clock;
+
+      inline double secondsSince( const Clock::time_point & start_r )
+      { return std::chrono::duration<double>( Clock::now() - start_r ).count(); }
+
+      /** A queued reconstruction. */
+      struct Job
+      {
+        Job( const ManagedFile & delta_r, const Pathname & new_r,
+             const CheckSum & checksum_r, const std::string & sequenceinfo_r )
+        : delta( delta_r ), target( new_r ), checksum( checksum_r ), sequenceinfo( sequenceinfo_r )
+        , enqueued( Clock::now() ), percent( 0 ), pid( 0 ), done( false ), ok( false )
+        {}
+
+        ManagedFile           delta;
+        Pathname              target;
+        CheckSum              checksum;
+        std::string           sequenceinfo;
+        Clock::time_point     enqueued;
+        std::atomic<unsigned> percent;
+        std::atomic<pid_t>    pid;		// the running applydeltarpm
+        bool                  done;		// guarded by Engine::_mutex
+        bool                  ok;
+        std::string           output;	// applydeltarpm messages, logged when collected
+        JobInfo               info;
+      };
+
+      /** Run applydeltarpm in a worker thread: must neither log nor throw.
+       * \a line_r is called for each line of output.
+       * \return Whether applydeltarpm succeeded.
+       */
+      template <class LineFnc>
+      bool spawnApplydeltarpm( const char *const argv_r[], std::atomic<pid_t> & pid_r, LineFnc line_r )
+      {
+        int pfd[2];
+        if ( ::pipe2( pfd, O_CLOEXEC ) == -1 )
+          return false;
+
+        // Descriptors of other threads (not yet O_CLOEXEC) must not leak into the child.
+        pid_t pid;
+#ifdef HAVE_POSIX_SPAWN_ADDCLOSEFROM
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init( &actions );
+        posix_spawn_file_actions_addopen( &actions, 0, "/dev/null", O_RDONLY, 0 );
+        posix_spawn_file_actions_adddup2( &actions, pfd[1], 1 );
+        posix_spawn_file_actions_adddup2( &actions, pfd[1], 2 );
+        posix_spawn_file_actions_addclosefrom_np( &actions, 3 );
+        int res = ::posix_spawn( &pid, argv_r[0], &actions, NULL, const_cast<char *const *>( argv_r ), environ );
+        posix_spawn_file_actions_destroy( &actions );
+#else
+        int res = 0;
+        pid = ::fork();
+        if ( pid == 0 )
+        {
+          // child: async-signal-safe calls only
+          int nullfd = ::open( "/dev/null", O_RDONLY );
+          if ( nullfd > 0 )
+          {
+            ::dup2( nullfd, 0 );
+            ::close( nullfd );
+          }
+          ::dup2( pfd[1], 1 );
+          ::dup2( pfd[1], 2 );
+          externalprogram::closeFdsAboveStderr();
+          ::execve( argv_r[0], const_cast<char *const *>( argv_r ), environ );
+          ::_exit( 127 );
+        }
+        else if ( pid == -1 )
+          res = errno;
+#endif
+        ::close( pfd[1] );
+        if ( res != 0 )
+        {
+          ::close( pfd[0] );
+          return false;
+        }
+        pid_r = pid;
+
+        FILE * out = ::fdopen( pfd[0], "r" );
+        if ( out )
+        {
+          char line[1024];
+          while ( ::fgets( line, sizeof(line), out ) )
+            line_r( line );
+          ::fclose( out );
+        }
+        else
+          ::close( pfd[0] );
+
+        int status = 0;
+        while ( ::waitpid( pid, &status, 0 ) == -1 && errno == EINTR )
+          ;
+        pid_r = 0;
+        return WIFEXITED( status ) && WEXITSTATUS( status ) == 0;
+      }
+
+      /** Feed the (growing) file \a fd_r into \a digest_r. */
+      inline void digestAppended( int fd_r, Digest & digest_r )
+      {
+        char buf[65536];
+        for ( ssize_t n = ::read( fd_r, buf, sizeof(buf) ); n > 0; n = ::read( fd_r, buf, sizeof(buf) ) )
+          digest_r.update( buf, n );
+      }
+
+      /** Re-create the rpm; runs in a worker thread. */
+      void runJob( Job & job_r )
+      {
+        Clock::time_point start( Clock::now() );
+        job_r.info.queued = std::chrono::duration<double>( start - job_r.enqueued ).count();
+        auto collect = [&job_r]( const char * line_r ) {
+          if ( job_r.output.size() < 4096 )
+            job_r.output += line_r;
+        };
+
+        if ( ! job_r.sequenceinfo.empty() )
+        {
+          const char *const argv[] = {
+            applydeltarpm_prog().c_str(),
+            "-c",
+            "-s", job_r.sequenceinfo.c_str(),
+            NULL
+          };
+          bool checked = spawnApplydeltarpm( argv, job_r.pid, collect );
+          job_r.info.check = secondsSince( start );
+          if ( ! checked )
+          {
+            job_r.info.checkFailed = true;
+            return;
+          }
+        }
+
+        // A stale file must not be mistaken for the output.
+        ::unlink( job_r.target.c_str() );
+
+        Digest digest;
+        bool verify = ! job_r.checksum.empty() && digest.create( job_r.checksum.type() );
+        int rfd = -1;
+        auto progress = [&]( const char * line_r ) {
+          unsigned percent;
+          if ( ::sscanf( line_r, "%u percent finished", &percent ) == 1 )
+            job_r.percent = percent;
+          else
+            collect( line_r );
+          if ( verify )
+          {
+            // applydeltarpm writes the rpm front to back; checksum what's there so far
+            if ( rfd == -1 )
+              rfd = ::open( job_r.target.c_str(), O_RDONLY | O_CLOEXEC );
+            if ( rfd != -1 )
+              digestAppended( rfd, digest );
+          }
+        };
+
+        Clock::time_point applyStart( Clock::now() );
+        const char *const argv[] = {
+          applydeltarpm_prog().c_str(),
+          "-p", "-p", // twice to get percent output one per line
+          job_r.delta->c_str(),
+          job_r.target.c_str(),
+          NULL
+        };
+        job_r.ok = spawnApplydeltarpm( argv, job_r.pid, progress );
+        job_r.info.apply = secondsSince( applyStart );
+
+        Clock::time_point verifyStart( Clock::now() );
+        if ( job_r.ok && verify )
+        {
+          if ( rfd == -1 )
+            rfd = ::open( job_r.target.c_str(), O_RDONLY | O_CLOEXEC );
+          if ( rfd == -1 )
+            job_r.ok = false;
+          else
+          {
+            digestAppended( rfd, digest );
+            job_r.ok = ( digest.digest() == job_r.checksum.checksum() );
+            if ( ! job_r.ok )
+            {
+              // in case parts were rewritten after we read them
+              Digest again;
+              again.create( job_r.checksum.type() );
+              if ( ::lseek( rfd, 0, SEEK_SET ) == 0 )
+              {
+                digestAppended( rfd, again );
+                job_r.ok = ( again.digest() == job_r.checksum.checksum() );
+              }
+              if ( ! job_r.ok )
+                collect( "checksum mismatch\n" );
+            }
+          }
+        }
+        if ( rfd != -1 )
+          ::close( rfd );
+        job_r.info.verify = secondsSince( verifyStart );
+
+        if ( ! job_r.ok )
+          ::unlink( job_r.target.c_str() );
+      }
+
+      ///////////////////////////////////////////////////////////////////
+      /// \class Engine
+      /// \brief The queue and the worker threads running the reconstructions.
+      ///////////////////////////////////////////////////////////////////
+      class Engine
+      {
+      public:
+        static Engine & instance()
+        {
+          static Engine _engine;
+          return _engine;
+        }
+
+        ~Engine()
+        {
+          {
+            std::lock_guard<std::mutex> lock( _mutex );
+            _stop = true;
+            _queue.clear();
+            for ( const auto & el : _jobs )
+            {
+              if ( el.second->pid )
+                ::kill( el.second->pid, SIGTERM );
+            }
+          }
+          _cond.notify_all();
+          for ( std::thread & thread : _threads )
+            thread.join();
+          // never collected: remove unfinished or failed output (a
+          // successfully built rpm is a valid cache entry); leave the delta
+          for ( const auto & el : _jobs )
+          {
+            el.second->delta.resetDispose();
+            if ( ! ( el.second->done && el.second->ok ) )
+              ::unlink( el.first.c_str() );
+          }
+        }
+
+        void enqueue( const std::shared_ptr<Job> & job_r )
+        {
+          unsigned max = ZConfig::instance().download_max_parallel_deltas();
+          if ( ! max )
+            max = std::max( 1U, std::thread::hardware_concurrency() );
+          {
+            std::lock_guard<std::mutex> lock( _mutex );
+            auto it = _jobs.find( job_r->target );
+            if ( it != _jobs.end() )
+            {
+              if ( ! it->second->done )
+              {
+                WAR << "Already building " << job_r->target << endl;
+                return;
+              }
+              WAR << "Drop uncollected build of " << job_r->target << endl;
+              _jobs.erase( it );
+            }
+            _jobs[job_r->target] = job_r;
+            _queue.push_back( job_r );
+            if ( _threads.size() < max && _queue.size() > _idle )
+              _threads.push_back( std::thread( &Engine::worker, this ) );
+          }
+          _cond.notify_one();
+        }
+
+        /** The delta of the (unfinished or uncollected) job building \a new_r. */
+        Pathname pendingDelta( const Pathname & new_r )
+        {
+          std::lock_guard<std::mutex> lock( _mutex );
+          auto it = _jobs.find( new_r );
+          return it == _jobs.end() ? Pathname() : it->second->delta.value();
+        }
+
+        /** Remove the job for \a new_r when it is done. */
+        std::shared_ptr<Job> collect( const Pathname & new_r, const Progress & report_r )
+        {
+          std::unique_lock<std::mutex> lock( _mutex );
+          auto it = _jobs.find( new_r );
+          if ( it == _jobs.end() )
+            return std::shared_ptr<Job>();
+          std::shared_ptr<Job> job( it->second );
+
+          unsigned reported = unsigned(-1);
+          while ( ! job->done )
+          {
+            _doneCond.wait_for( lock, std::chrono::milliseconds( 100 ) );
+            if ( report_r && job->percent != reported )
+            {
+              reported = job->percent;
+              lock.unlock();
+              report_r( reported );
+              lock.lock();
+            }
+          }
+          _jobs.erase( new_r );
+          return job;
+        }
+
+      private:
+        Engine()
+        : _stop( false ), _idle( 0 )
+        {
+          // set up the digests before going parallel
+          Digest digest;
+          digest.create( Digest::sha256() );
+          // resolve (and log) the program before the workers use it
+          applydeltarpm_prog();
+        }
+
+        void worker()
+        {
+          std::unique_lock<std::mutex> lock( _mutex );
+          while ( true )
+          {
+            ++_idle;
+            while ( ! _stop && _queue.empty() )
+              _cond.wait( lock );
+            --_idle;
+            if ( _stop )
+              return;
+
+            // _jobs keeps the job alive until it is collected, which is
+            // not before it is done. So it's never released in here.
+            Job * job = _queue.front().get();
+            _queue.pop_front();
+            lock.unlock();
+            runJob( *job );
+            lock.lock();
+            job->done = true;
+            _doneCond.notify_all();
+          }
+        }
+
+      private:
+        std::mutex _mutex;
+        std::condition_variable _cond;		// new job or stop
+        std::condition_variable _doneCond;	// a job is done
+        bool _stop;
+        unsigned _idle;
+        std::deque<std::shared_ptr<Job> > _queue;
+        std::map<Pathname, std::shared_ptr<Job> > _jobs;
+        std::vector<std::thread> _threads;
+      };
+
       /////////////////////////////////////////////////////////////////
     } // namespace
     ///////////////////////////////////////////////////////////////////
@@ -70,7 +452,7 @@ namespace zypp
     {
       // To track changes in availability of applydeltarpm.
       static TriBool _last = indeterminate;
-      PathInfo prog( applydeltarpm_prog );
+      PathInfo prog( applydeltarpm_prog() );
       bool have = prog.isX();
       if ( _last == have )
         ; // TriBool! 'else' is not '_last != have'
@@ -96,7 +478,7 @@ namespace zypp
         return false;
 
       const char *const argv[] = {
-        "/usr/bin/applydeltarpm",
+        applydeltarpm_prog().c_str(),
         ( quick_r ? "-C" : "-c" ),
         "-s", sequenceinfo_r.c_str(),
         NULL
@@ -116,7 +498,7 @@ namespace zypp
         return false;
 
       const char *const argv[] = {
-        "/usr/bin/applydeltarpm",
+        applydeltarpm_prog().c_str(),
         ( quick_r ? "-C" : "-c" ),
         delta_r.asString().c_str(),
         NULL
@@ -140,7 +522,7 @@ namespace zypp
         return false;
 
       const char *const argv[] = {
-        "/usr/bin/applydeltarpm",
+        applydeltarpm_prog().c_str(),
         "-p", "-p", // twice to get percent output one per line
         delta_r.asString().c_str(),
         new_r.asString().c_str(),
@@ -170,7 +552,7 @@ namespace zypp
         return false;
 
       const char *const argv[] = {
-        "/usr/bin/applydeltarpm",
+        applydeltarpm_prog().c_str(),
         "-p", "-p", // twice to get percent output one per line
         "-r", old_r.asString().c_str(),
         delta_r.asString().c_str(),
@@ -185,6 +567,49 @@ namespace zypp
       return true;
     }
 
+
+    void provideAsync( const ManagedFile & delta_r, const Pathname & new_r,
+                       const CheckSum & checksum_r, const std::string & sequenceinfo_r )
+    {
+      MIL << "Queue building " << new_r << " from " << delta_r << endl;
+      Engine::instance().enqueue( std::make_shared<Job>( delta_r, new_r, checksum_r, sequenceinfo_r ) );
+    }
+
+    Pathname pendingDelta( const Pathname & new_r )
+    { return Engine::instance().pendingDelta( new_r ); }
+
+    bool waitFor( const Pathname & new_r, const Progress & report_r, JobInfo * info_r )
+    {
+      std::shared_ptr<Job> job( Engine::instance().collect( new_r, report_r ) );
+      if ( ! job )
+      {
+        WAR << "Not building " << new_r << endl;
+        return false;
+      }
+      if ( ! job->output.empty() )
+        DBG << "Applydeltarpm : " << job->output;
+      if ( job->ok && ! PathInfo( new_r ).isFile() )
+      {
+        WAR << "Built " << new_r << " vanished" << endl;
+        job->ok = false;
+      }
+      if ( job->ok )
+        MIL << "Built " << new_r << " from " << job->delta << ": " << job->info << endl;
+      else
+        WAR << "Failed to build " << new_r << " from " << job->delta << ": " << job->info << endl;
+      if ( info_r )
+        *info_r = job->info;
+      return job->ok;
+    }
+
+    std::ostream & operator<<( std::ostream & str, const JobInfo & obj )
+    {
+      str << str::form( "queued %.2fs, ", obj.queued );
+      if ( obj.checkFailed )
+        return str << str::form( "check failed after %.2fs", obj.check );
+      return str << str::form( "check %.2fs, apply %.2fs, verify %.2fs", obj.check, obj.apply, obj.verify );
+    }
+
     /////////////////////////////////////////////////////////////////
   } // namespace applydeltarpm
   ///////////////////////////////////////////////////////////////////
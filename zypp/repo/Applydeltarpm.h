@@ -17,6 +17,8 @@
 
 #include "zypp/base/Function.h"
 #include "zypp/Pathname.h"
+#include "zypp/ManagedFile.h"
+#include "zypp/CheckSum.h"
 
 ///////////////////////////////////////////////////////////////////
 namespace zypp
@@ -74,6 +76,69 @@ namespace zypp
                   const Progress & report_r = Progress() );
     //@}
 
+    /** \name Re-create new rpms in the background.
+     *
+     * Reconstructions are queued and run by up to
+     * \ref ZConfig::download_max_parallel_deltas worker threads, so they
+     * overlap with each other and with downloading further packages. The
+     * new rpm is checksummed while applydeltarpm writes it, so a verified
+     * file is available as soon as the reconstruction is done.
+     *
+     * \code
+     *   provideAsync( delta, newrpm, checksum, sequenceinfo );
+     *   // ...download other packages...
+     *   JobInfo info;
+     *   if ( waitFor( newrpm, progress, &info ) )
+     *     ; // newrpm is there and matches checksum
+     * \endcode
+     */
+    //@{
+    /** What a reconstruction took (in seconds) and why it failed. */
+    struct JobInfo
+    {
+      JobInfo()
+      : checkFailed( false ), queued( 0 ), check( 0 ), apply( 0 ), verify( 0 )
+      {}
+      bool   checkFailed;	//!< the on-disk data does not match the sequence info
+      double queued;		//!< waiting for a free worker
+      double check;		//!< checking the on-disk data (<tt>applydeltarpm -c</tt>)
+      double apply;		//!< running applydeltarpm
+      double verify;		//!< completing the checksum once applydeltarpm is done
+    };
+
+    /** Queue re-creating \a new_r from \a delta_r and on-disk data.
+     * If \a sequenceinfo_r is not empty, the on-disk data are checked first.
+     * If \a checksum_r is not empty, the new rpm must match it. \a delta_r
+     * is kept until the job is collected by \ref waitFor. A finished but
+     * uncollected job for \a new_r is dropped; a running one is kept.
+     *
+     * Rpms still being re-created when the program exits are removed;
+     * finished ones are left in place as valid cache entries.
+     */
+    void provideAsync( const ManagedFile & delta_r, const Pathname & new_r,
+                       const CheckSum & checksum_r = CheckSum(),
+                       const std::string & sequenceinfo_r = std::string() );
+
+    /** The delta rpm of a queued reconstruction of \a new_r (empty if there is none).
+     * This includes finished reconstructions not yet collected by \ref waitFor;
+     * \a new_r must not be taken from the cache while they are pending.
+     */
+    Pathname pendingDelta( const Pathname & new_r );
+
+    /** Wait for the queued reconstruction of \a new_r, reporting its progress.
+     * On failure \a new_r is removed. If \a info_r is not \c NULL, it
+     * receives the timing of the job.
+     * \return Whether \a new_r was successfully re-created (\c false if
+     * there was no such job).
+     */
+    bool waitFor( const Pathname & new_r,
+                  const Progress & report_r = Progress(),
+                  JobInfo * info_r = 0 );
+
+    /** \relates JobInfo Stream output */
+    std::ostream & operator<<( std::ostream & str, const JobInfo & obj );
+    //@}
+
     /////////////////////////////////////////////////////////////////
   } // namespace applydeltarpm
   ///////////////////////////////////////////////////////////////////
@@ -0,0 +1,143 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/BlockReuseCandidates.cc
+ *
+*/
+#include <iostream>
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include "zypp/base/Logger.h"
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/PathInfo.h"
+#include "zypp/ResPool.h"
+#include "zypp/RepoInfo.h"
+#include "zypp/repo/BlockReuseCandidates.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      inline bool schemeIsLocalDir( const Url & url_r )
+      {
+        const std::string & s( url_r.getScheme() );
+        return s == "dir" || s == "file";
+      }
+
+      struct Candidate
+      {
+        Candidate( const Pathname & path_r, const Edition & edition_r, const Edition & target_r )
+        : path( path_r ), edition( edition_r )
+        , order( edition_r == target_r ? 0 : ( edition_r < target_r ? 1 : 2 ) )
+        {}
+
+        /** same build, older builds newest first, newer builds oldest first */
+        bool operator<( const Candidate & rhs ) const
+        {
+          if ( order != rhs.order )
+            return order < rhs.order;
+          return order == 2 ? edition < rhs.edition : rhs.edition < edition;
+        }
+
+        Pathname path;
+        Edition  edition;
+        int      order;
+      };
+
+      /** Collect the candidates; skips \a self_r, empty and already seen files. */
+      struct Collector
+      {
+        Collector( const Pathname & self_r, const Edition & target_r )
+        : _target( target_r )
+        { _seen.insert( self_r ); }
+
+        void add( const Pathname & path_r, const Edition & edition_r )
+        {
+          if ( path_r.empty() || ! _seen.insert( path_r ).second )
+            return;
+          PathInfo pi( path_r );
+          if ( ! pi.isFile() || ! pi.size() )
+            return;
+          _candidates.push_back( Candidate( path_r, edition_r, _target ) );
+        }
+
+        Edition _target;
+        std::set<Pathname> _seen;
+        std::vector<Candidate> _candidates;
+      };
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    std::list<Pathname> blockReuseCandidates( const Package::constPtr & package_r, unsigned limit_r )
+    {
+      std::list<Pathname> ret;
+      if ( ! package_r || ! limit_r )
+        return ret;
+
+      OnMediaLocation loc( package_r->location() );
+      Pathname self( package_r->repoInfo().packagesPath() / loc.filename() );
+      Collector collector( self, package_r->edition() );
+
+      // other builds known to the pool: in the package cache of their repo or a local repo
+      for ( const PoolItem & pi : ResPool::instance().byIdent( package_r->satSolvable() ) )
+      {
+        sat::Solvable slv( pi.satSolvable() );
+        if ( slv.isSystem() || slv == package_r->satSolvable() || slv.arch() != package_r->arch() )
+          continue;
+        OnMediaLocation sloc( slv.lookupLocation() );
+        if ( sloc.filename().empty() )
+          continue;
+        RepoInfo info( slv.repoInfo() );
+        collector.add( info.packagesPath() / sloc.filename(), slv.edition() );
+        if ( ! info.baseUrlsEmpty() && schemeIsLocalDir( info.url() ) )
+          collector.add( info.url().getPathName() / sloc.filename(), slv.edition() );
+      }
+
+      // builds the repo no longer offers, kept in the package cache: <name>-<version>-<release>.<arch>.rpm
+      std::string prefix( package_r->name() + "-" );
+      std::string suffix( "." + package_r->arch().asString() + ".rpm" );
+      std::list<std::string> entries;
+      filesystem::readdir( entries, self.dirname(), false );
+      for ( const std::string & entry : entries )
+      {
+        if ( entry.size() <= prefix.size() + suffix.size()
+             || ! str::hasPrefix( entry, prefix )
+             || ! str::hasSuffix( entry, suffix ) )
+          continue;
+        std::string evr( entry, prefix.size(), entry.size() - prefix.size() - suffix.size() );
+        if ( std::count( evr.begin(), evr.end(), '-' ) != 1 )
+          continue;	// e.g. <name>-devel-<version>-<release>
+        collector.add( self.dirname() / entry, Edition( evr ) );
+      }
+
+      std::vector<Candidate> & candidates( collector._candidates );
+      std::stable_sort( candidates.begin(), candidates.end() );
+      for ( const Candidate & candidate : candidates )
+      {
+        if ( ret.size() >= limit_r )
+          break;
+        ret.push_back( candidate.path );
+      }
+      dumpRange( DBG << package_r << ": " << candidates.size() << " block reuse candidates, using ", ret.begin(), ret.end() ) << endl;
+      return ret;
+    }
+
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,47 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/BlockReuseCandidates.h
+ *
+*/
+#ifndef ZYPP_REPO_BLOCKREUSECANDIDATES_H
+#define ZYPP_REPO_BLOCKREUSECANDIDATES_H
+
+#include <list>
+
+#include "zypp/Pathname.h"
+#include "zypp/Package.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  {
+    /** Local files likely to share blocks with the rpm of \a package_r.
+     *
+     * When a package is downloaded via metalink, \ref media::MediaMultiCurl
+     * takes all blocks it finds in a local base file instead of downloading
+     * them (see \ref media::MediaBlockList::reuseBlocks). A different build
+     * of the same package often shares most of them, without the need for
+     * deltarpm metadata.
+     *
+     * Candidates are the cached or local repo rpms of the other pool items
+     * with the same name and arch, and older builds left in the package
+     * cache. The files are not verified, they are just a source of blocks.
+     *
+     * At most \a limit_r files are returned, best first: The same build from
+     * a different repo, then older builds (newest first), then newer ones.
+     */
+    std::list<Pathname> blockReuseCandidates( const Package::constPtr & package_r, unsigned limit_r = 3 );
+
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_REPO_BLOCKREUSECANDIDATES_H
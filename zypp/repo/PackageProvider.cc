@@ -20,6 +20,8 @@
 #include "zypp/repo/PackageProvider.h"
 #include "zypp/repo/Applydeltarpm.h"
 #include "zypp/repo/PackageDelta.h"
+#include "zypp/repo/BlockReuseCandidates.h"
+#include "zypp/media/MediaAccess.h"
 
 #include "zypp/TmpPath.h"
 #include "zypp/ZConfig.h"
@@ -112,18 +114,27 @@ namespace zypp
        */
       virtual ManagedFile providePackage() const;
 
-      /** Provide the package if it is cached. */
+      /** Provide the package if it is cached (and not being built). */
       virtual ManagedFile providePackageFromCache() const
       {
+	if ( isBuilding() )
+	  return ManagedFile();
 	ManagedFile ret( doProvidePackageFromCache() );
 	if ( ! ( ret->empty() ||  _package->repoInfo().keepPackages() ) )
 	  ret.setDispose( filesystem::unlink );
 	return ret;
       }
 
-      /** Whether the package is cached. */
+      /** Whether the package is cached (or being built, so it will be). */
       virtual bool isCached() const
-      { return ! doProvidePackageFromCache()->empty(); }
+      { return isBuilding() || ! doProvidePackageFromCache()->empty(); }
+
+      /** Whether the final rpm is being built in the background.
+       * It must then be collected by \ref doProvidePackage, even if the
+       * file is already there.
+       */
+      virtual bool isBuilding() const
+      { return false; }
 
     protected:
       typedef PackageProviderImpl<TPackage>	Base;
@@ -264,6 +275,7 @@ namespace zypp
       RepoInfo info = _package->repoInfo();
 
       // Check toplevel cache
+      if ( ! isBuilding() )
       {
 	RepoManagerOptions topCache;
 	if ( info.packagesPath().dirname() != topCache.repoPackagesCachePath )	// not using toplevel cache
@@ -435,6 +447,9 @@ namespace zypp
       , _deltas( deltas_r )
       {}
 
+      virtual bool isBuilding() const
+      { return ! applydeltarpm::pendingDelta( _package->repoInfo().packagesPath() / _package->location().filename() ).empty(); }
+
     protected:
       virtual ManagedFile doProvidePackage() const;
 
@@ -443,6 +458,14 @@ namespace zypp
 
       ManagedFile tryDelta( const DeltaRpm & delta_r ) const;
 
+      /** Collect the package if it is already being built from a delta rpm (see \ref applydeltarpm::provideAsync).
+       * \a tried_r tells whether there was such a build.
+       */
+      ManagedFile collectDelta( bool & tried_r ) const;
+
+      /** Wait for building \a destination_r from \a delta_r to complete, reporting the delta apply. */
+      ManagedFile waitForDelta( const Pathname & delta_r, const Pathname & destination_r ) const;
+
       bool progressDeltaDownload( int value ) const
       { return report()->progressDeltaDownload( value ); }
 
@@ -467,8 +490,15 @@ namespace zypp
       else
         url = * info.baseUrlsBegin();
 
-      // check whether to process patch/delta rpms
-      if ( ZConfig::instance().download_use_deltarpm()
+      // maybe the package is already being built from a delta rpm
+      bool tried = false;
+      ManagedFile built( collectDelta( tried ) );
+      if ( ! built->empty() )
+        return built;
+
+      // check whether to process patch/delta rpms (a failed build is not retried, the on-disk data don't fit)
+      if ( ! tried
+        && ZConfig::instance().download_use_deltarpm()
 	&& ( url.schemeIsDownloading() || ZConfig::instance().download_use_deltarpm_always() ) )
       {
 	std::list<DeltaRpm> deltaRpms;
@@ -487,6 +517,19 @@ namespace zypp
       }
 
       // no patch/delta -> provide full package
+      // A metalink download may take most blocks from another build we already have.
+      OnMediaLocation loc = _package->location();
+      if ( ! loc.checksum().empty() && media::MediaAccess::usesMultiCurl( url ) )
+      {
+	std::list<Pathname> reuse( blockReuseCandidates( _package, 1 ) );
+	if ( ! reuse.empty() )
+	{
+	  DBG << "reuse blocks from " << reuse.front() << endl;
+	  ProvideFilePolicy policy;
+	  policy.progressCB( bind( &RpmPackageProvider::progressPackageDownload, this, _1 ) );
+	  return _access.provideFile( _package->repoInfo(), loc, policy, reuse.front() );
+	}
+      }
       return Base::doProvidePackage();
     }
 
@@ -515,25 +558,38 @@ namespace zypp
         }
       report()->finishDeltaDownload();
 
-      report()->startDeltaApply( delta );
-      if ( ! applydeltarpm::check( delta_r.baseversion().sequenceinfo() ) )
-        {
-          report()->problemDeltaApply( _("applydeltarpm check failed.") );
-          return ManagedFile();
-        }
-
       // build the package and put it into the cache
       Pathname destination( _package->repoInfo().packagesPath() / _package->location().filename() );
+      applydeltarpm::provideAsync( delta, destination, _package->location().checksum(),
+                                   delta_r.baseversion().sequenceinfo() );
+      return waitForDelta( delta, destination );
+    }
+
+    ManagedFile RpmPackageProvider::collectDelta( bool & tried_r ) const
+    {
+      Pathname destination( _package->repoInfo().packagesPath() / _package->location().filename() );
+      Pathname delta( applydeltarpm::pendingDelta( destination ) );
+      tried_r = ! delta.empty();
+      if ( ! tried_r )
+        return ManagedFile();
+      DBG << "collectDelta " << delta << endl;
+      return waitForDelta( delta, destination );
+    }
 
-      if ( ! applydeltarpm::provide( delta, destination,
-                                     bind( &RpmPackageProvider::progressDeltaApply, this, _1 ) ) )
+    ManagedFile RpmPackageProvider::waitForDelta( const Pathname & delta_r, const Pathname & destination_r ) const
+    {
+      report()->startDeltaApply( delta_r );
+      applydeltarpm::JobInfo info;
+      if ( ! applydeltarpm::waitFor( destination_r,
+                                     bind( &RpmPackageProvider::progressDeltaApply, this, _1 ),
+                                     &info ) )
         {
-          report()->problemDeltaApply( _("applydeltarpm failed.") );
+          report()->problemDeltaApply( info.checkFailed ? _("applydeltarpm check failed.") : _("applydeltarpm failed.") );
           return ManagedFile();
         }
       report()->finishDeltaApply();
 
-      return ManagedFile( destination, filesystem::unlink );
+      return ManagedFile( destination_r, filesystem::unlink );
     }
 
     ///////////////////////////////////////////////////////////////////
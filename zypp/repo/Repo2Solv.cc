@@ -0,0 +1,365 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/Repo2Solv.cc
+ *
+*/
+extern "C"
+{
+#include <solv/solvversion.h>
+#include <solv/pool.h>
+#include <solv/repo.h>
+#include <solv/repo_write.h>
+#include <solv/solv_xfopen.h>
+#include <solv/repo_repomdxml.h>
+#include <solv/repo_rpmmd.h>
+#include <solv/repo_updateinfoxml.h>
+#include <solv/repo_deltainfoxml.h>
+#ifdef LIBSOLVEXT_FEATURE_SUSEREPO
+#include <solv/repo_susetags.h>
+#include <solv/repo_content.h>
+#endif
+#ifdef LIBSOLVEXT_FEATURE_APPDATA
+#include <solv/repo_appdata.h>
+#endif
+#ifdef __has_include
+#if __has_include(<solv/repo_autopattern.h>)
+#include <solv/repo_autopattern.h>
+#define ZYPP_HAVE_REPO_AUTOPATTERN 1
+#endif
+#endif
+}
+#include <unistd.h>
+#include <dirent.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <list>
+
+#include "zypp/base/String.h"
+#include "zypp/AutoDispose.h"
+#include "zypp/sat/detail/PoolMember.h"
+
+#include "zypp/repo/Repo2Solv.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      typedef AutoDispose<sat::detail::CPool*> AutoPool;
+      typedef AutoDispose<FILE*> AutoFILE;
+
+      /** Open a (maybe compressed) metadata file for reading. */
+      inline AutoFILE xfopen( const Pathname & file_r )
+      {
+        FILE * fp = ::solv_xfopen( file_r.c_str(), "r" );
+        return fp ? AutoFILE( fp, ::fclose ) : AutoFILE();
+      }
+
+      /** Location of the \a type_r file mentioned in the repomd.xml already added to \a repo_r. */
+      std::string repomdLocation( sat::detail::CRepo * repo_r, const char * type_r )
+      {
+        std::string ret;
+        ::Dataiterator di;
+        ::dataiterator_init( &di, repo_r->pool, repo_r, SOLVID_META, REPOSITORY_REPOMD_TYPE, type_r, SEARCH_STRING );
+        ::dataiterator_prepend_keyname( &di, REPOSITORY_REPOMD );
+        if ( ::dataiterator_step( &di ) )
+        {
+          ::dataiterator_setpos_parent( &di );
+          const char * loc = ::pool_lookup_str( repo_r->pool, SOLVID_POS, REPOSITORY_REPOMD_LOCATION );
+          if ( loc )
+            ret = loc;
+        }
+        ::dataiterator_free( &di );
+        return ret;
+      }
+
+      /** Add the repomd.xml mentioned \a type_r file using \a add_r (optional files may be missing). */
+      template <class TAdd>
+      bool addRepomdFile( sat::detail::CRepo * repo_r, const Pathname & metadata_r, const char * type_r, bool required_r, TAdd add_r, std::string & errdetail_r )
+      {
+        std::string loc( repomdLocation( repo_r, type_r ) );
+        if ( loc.empty() )
+        {
+          if ( required_r )
+            errdetail_r = str::form( "repomd.xml: no '%s' data", type_r );
+          return ! required_r;
+        }
+
+        AutoFILE fp( xfopen( metadata_r / loc ) );
+        if ( ! *fp )
+        {
+          if ( required_r )
+            errdetail_r = str::form( "Can't open %s", (metadata_r / loc).c_str() );
+          return ! required_r;
+        }
+
+        if ( add_r( repo_r, *fp ) != 0 )
+        {
+          errdetail_r = str::form( "%s: %s", loc.c_str(), ::pool_errstr( repo_r->pool ) );
+          return false;
+        }
+        return true;
+      }
+
+      /** Same sequence as repo2solv: repomd, primary, susedata, patterns, product, updateinfo, deltainfo, appdata. */
+      bool addRpmmd( sat::detail::CRepo * repo_r, const Pathname & metadata_r, std::string & errdetail_r )
+      {
+        {
+          AutoFILE fp( xfopen( metadata_r / "repodata/repomd.xml" ) );
+          if ( ! *fp )
+          {
+            errdetail_r = str::form( "Can't open %s", (metadata_r / "repodata/repomd.xml").c_str() );
+            return false;
+          }
+          if ( ::repo_add_repomdxml( repo_r, fp, 0 ) != 0 )
+          {
+            errdetail_r = str::form( "repomd.xml: %s", ::pool_errstr( repo_r->pool ) );
+            return false;
+          }
+        }
+
+        auto rpmmd = []( sat::detail::CRepo * repo, FILE * fp ) { return ::repo_add_rpmmd( repo, fp, 0, 0 ); };
+        auto rpmmdExtend = []( sat::detail::CRepo * repo, FILE * fp ) { return ::repo_add_rpmmd( repo, fp, 0, REPO_EXTEND_SOLVABLES ); };
+        auto updateinfo = []( sat::detail::CRepo * repo, FILE * fp ) { return ::repo_add_updateinfoxml( repo, fp, 0 ); };
+        auto deltainfo = []( sat::detail::CRepo * repo, FILE * fp ) { return ::repo_add_deltainfoxml( repo, fp, 0 ); };
+
+        if ( ! ( addRepomdFile( repo_r, metadata_r, "primary",	true,  rpmmd, errdetail_r )
+              && addRepomdFile( repo_r, metadata_r, "susedata",	false, rpmmdExtend, errdetail_r )
+              && addRepomdFile( repo_r, metadata_r, "patterns",	false, rpmmd, errdetail_r )
+              && addRepomdFile( repo_r, metadata_r, "product",	false, rpmmd, errdetail_r )
+              && addRepomdFile( repo_r, metadata_r, "updateinfo",	false, updateinfo, errdetail_r ) ) )
+          return false;
+
+        // either one, prefer deltainfo
+        if ( ! repomdLocation( repo_r, "deltainfo" ).empty() )
+        {
+          if ( ! addRepomdFile( repo_r, metadata_r, "deltainfo", false, deltainfo, errdetail_r ) )
+            return false;
+        }
+        else if ( ! addRepomdFile( repo_r, metadata_r, "prestodelta", false, deltainfo, errdetail_r ) )
+          return false;
+
+#ifdef LIBSOLVEXT_FEATURE_APPDATA
+        auto appdata = []( sat::detail::CRepo * repo, FILE * fp ) { return ::repo_add_appdata( repo, fp, 0 ); };
+        if ( ! addRepomdFile( repo_r, metadata_r, "appdata", false, appdata, errdetail_r ) )
+          return false;
+#endif
+        return true;
+      }
+
+#ifdef LIBSOLVEXT_FEATURE_SUSEREPO
+      /** Strip a compression suffix from \a name_r. */
+      inline std::string uncompressedName( std::string name_r )
+      {
+        for ( const char * suffix : { ".gz", ".bz2", ".xz", ".lzma", ".zst" } )
+        {
+          if ( str::hasSuffix( name_r, suffix ) )
+            return str::stripSuffix( name_r, suffix );
+        }
+        return name_r;
+      }
+
+      /** Same as susetags2solv: content file, then the descrdir files; 'packages' first. */
+      bool addSusetags( sat::detail::CRepo * repo_r, const Pathname & metadata_r, std::string & errdetail_r )
+      {
+        Pathname descrdir( "suse/setup/descr" );
+        ::Id defvendor = 0;
+        {
+          AutoFILE fp( xfopen( metadata_r / "content" ) );
+          if ( ! *fp )
+          {
+            errdetail_r = str::form( "Can't open %s", (metadata_r / "content").c_str() );
+            return false;
+          }
+          if ( ::repo_add_content( repo_r, fp, REPO_REUSE_REPODATA ) != 0 )
+          {
+            errdetail_r = str::form( "content: %s", ::pool_errstr( repo_r->pool ) );
+            return false;
+          }
+          defvendor = ::repo_lookup_id( repo_r, SOLVID_META, SUSETAGS_DEFAULTVENDOR );
+          const char * dd = ::repo_lookup_str( repo_r, SOLVID_META, SUSETAGS_DESCRDIR );
+          if ( dd && *dd )
+            descrdir = dd;
+        }
+
+        std::string packages;
+        std::list<std::string> extensions;	// packages.DU, packages.<lang>, ...
+        std::list<std::string> patterns;	// *.pat
+        {
+          AutoDispose<DIR*> dir( ::opendir( (metadata_r / descrdir).c_str() ) );
+          if ( ! *dir )
+          {
+            errdetail_r = str::form( "Can't read %s", (metadata_r / descrdir).c_str() );
+            return false;
+          }
+          dir.setDispose( ::closedir );
+          while ( struct dirent * entry = ::readdir( dir ) )
+          {
+            std::string name( entry->d_name );
+            std::string plain( uncompressedName( name ) );
+            if ( plain == "packages" )
+              packages = name;
+            else if ( str::hasPrefix( plain, "packages." ) )
+              extensions.push_back( name );
+            else if ( str::hasSuffix( plain, ".pat" ) )
+              patterns.push_back( name );
+          }
+        }
+        if ( packages.empty() )
+        {
+          errdetail_r = str::form( "No packages file in %s", (metadata_r / descrdir).c_str() );
+          return false;
+        }
+        extensions.sort();
+        patterns.sort();
+
+        auto add = [&]( const std::string & name_r, const char * language_r, int flags_r ) -> bool
+        {
+          AutoFILE fp( xfopen( metadata_r / descrdir / name_r ) );
+          if ( ! *fp )
+          {
+            errdetail_r = str::form( "Can't open %s", (metadata_r / descrdir / name_r).c_str() );
+            return false;
+          }
+          if ( ::repo_add_susetags( repo_r, fp, defvendor, language_r, flags_r ) != 0 )
+          {
+            errdetail_r = str::form( "%s: %s", name_r.c_str(), ::pool_errstr( repo_r->pool ) );
+            return false;
+          }
+          return true;
+        };
+
+        static const int addflags = REPO_NO_INTERNALIZE | REPO_REUSE_REPODATA;
+        if ( ! add( packages, 0, addflags | SUSETAGS_RECORD_SHARES ) )
+          return false;
+        for ( const std::string & name : extensions )
+        {
+          std::string ext( uncompressedName( name ).substr( 9 ) );	// strip "packages."
+          const char * language = ( ext == "DU" || ext == "FL" ) ? 0 : ext.c_str();
+          if ( ! add( name, language, addflags | REPO_EXTEND_SOLVABLES ) )
+            return false;
+        }
+        for ( const std::string & name : patterns )
+        {
+          if ( ! add( name, 0, addflags ) )
+            return false;
+        }
+        ::repo_internalize( repo_r );
+        return true;
+      }
+#endif // LIBSOLVEXT_FEATURE_SUSEREPO
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    bool haveAutopattern()
+    {
+#ifdef ZYPP_HAVE_REPO_AUTOPATTERN
+      return true;
+#else
+      return false;
+#endif
+    }
+
+    bool addAutopattern( sat::detail::CRepo * repo_r )
+    {
+#ifdef ZYPP_HAVE_REPO_AUTOPATTERN
+      ::repo_add_autopattern( repo_r, 0 );
+      return true;
+#else
+      return false;
+#endif
+    }
+
+    bool writeSolv( sat::detail::CRepo * repo_r, const Pathname & solvfile_r, std::string & errdetail_r, bool sync_r )
+    {
+      AutoFILE fp( ::fopen( solvfile_r.c_str(), "we" ) );
+      if ( ! *fp )
+      {
+        errdetail_r = str::form( "Can't open %s for writing.", solvfile_r.c_str() );
+        return false;
+      }
+      int ret = ::repo_write( repo_r, fp );
+      ret |= ::fflush( fp );
+      if ( sync_r )
+        ret |= ::fsync( ::fileno( fp ) );
+      ret |= ::fclose( fp );
+      fp.resetDispose();
+      if ( ret != 0 )
+      {
+        errdetail_r = str::form( "Failed to write %s.", solvfile_r.c_str() );
+        return false;
+      }
+      return true;
+    }
+
+    bool repo2solvSupports( const RepoType & type_r )
+    {
+#ifdef ZYPP_HAVE_REPO_AUTOPATTERN
+      switch ( type_r.toEnum() )
+      {
+        case RepoType::RPMMD_e:
+          return true;
+        case RepoType::YAST2_e:
+#ifdef LIBSOLVEXT_FEATURE_SUSEREPO
+          return true;
+#else
+          return false;
+#endif
+        default:
+          break;
+      }
+#endif
+      return false;
+    }
+
+    bool repo2solv( const RepoType & type_r, const Pathname & metadata_r, const Pathname & solvfile_r, std::string & errdetail_r )
+    {
+#ifdef ZYPP_HAVE_REPO_AUTOPATTERN
+      if ( ! repo2solvSupports( type_r ) )
+      {
+        errdetail_r = str::form( "Unsupported repository type '%s'", type_r.asString().c_str() );
+        return false;
+      }
+
+      AutoPool pool( ::pool_create(), ::pool_free );
+      sat::detail::CRepo * repo = ::repo_create( pool, "repo2solv" );
+
+      bool ok = false;
+      if ( type_r == RepoType::RPMMD )
+        ok = addRpmmd( repo, metadata_r, errdetail_r );
+#ifdef LIBSOLVEXT_FEATURE_SUSEREPO
+      else
+        ok = addSusetags( repo, metadata_r, errdetail_r );
+#endif
+      if ( ! ok )
+        return false;
+
+      addAutopattern( repo );	// like 'repo2solv -X'
+
+      if ( ! writeSolv( repo, solvfile_r, errdetail_r ) )
+      {
+        ::unlink( solvfile_r.c_str() );
+        return false;
+      }
+      return true;
+#else
+      errdetail_r = "libsolv lacks autopattern support";
+      return false;
+#endif
+    }
+
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
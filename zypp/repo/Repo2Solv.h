@@ -0,0 +1,66 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/repo/Repo2Solv.h
+ *
+*/
+#ifndef ZYPP_REPO_REPO2SOLV_H
+#define ZYPP_REPO_REPO2SOLV_H
+
+#include <string>
+
+#include "zypp/Pathname.h"
+#include "zypp/repo/RepoType.h"
+#include "zypp/sat/detail/PoolMember.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace repo
+  {
+    /** Whether \ref repo2solv is able to convert metadata of type \a type_r. */
+    bool repo2solvSupports( const RepoType & type_r );
+
+    /** In-process replacement for <tt>repo2solv -X</tt>.
+     *
+     * Converts the raw rpm-md or susetags metadata below \a metadata_r into the
+     * solv file \a solvfile_r, using a private libsolv pool. Compressed metadata
+     * files are read directly, without unpacking them first.
+     *
+     * As it neither logs nor throws, it may be called from several threads
+     * at once; each call uses its own pool.
+     *
+     * \return \c false and some \a errdetail_r if the solv file could not be
+     * built. A partially written \a solvfile_r is removed.
+     */
+    bool repo2solv( const RepoType & type_r, const Pathname & metadata_r, const Pathname & solvfile_r, std::string & errdetail_r );
+
+    /** \name Building blocks shared by \ref repo2solv and the in-process rpmdb2solv.
+     * They neither log nor throw.
+     */
+    //@{
+    /** Whether libsolv is able to generate patterns/products/... from packages (<tt>-X</tt>). */
+    bool haveAutopattern();
+
+    /** Generate patterns/products/... from the packages in \a repo_r (<tt>-X</tt>).
+     * \return \c false if not supported (see \ref haveAutopattern).
+     */
+    bool addAutopattern( sat::detail::CRepo * repo_r );
+
+    /** Write \a repo_r to \a solvfile_r; if \a sync_r, make sure it is on disk.
+     * \return \c false and some \a errdetail_r if it could not be written.
+     */
+    bool writeSolv( sat::detail::CRepo * repo_r, const Pathname & solvfile_r, std::string & errdetail_r, bool sync_r = false );
+    //@}
+
+  } // namespace repo
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_REPO_REPO2SOLV_H
@@ -248,6 +248,12 @@ namespace zypp
     ManagedFile RepoMediaAccess::provideFile( RepoInfo repo_r,
                                               const OnMediaLocation & loc_r,
                                               const ProvideFilePolicy & policy_r )
+    { return provideFile( repo_r, loc_r, policy_r, Pathname() ); }
+
+    ManagedFile RepoMediaAccess::provideFile( RepoInfo repo_r,
+                                              const OnMediaLocation & loc_r,
+                                              const ProvideFilePolicy & policy_r,
+                                              const Pathname & deltafile_r )
     {
       MIL << loc_r << endl;
       // Arrange DownloadFileReportHack to recieve the source::DownloadFileReport
@@ -305,7 +311,10 @@ namespace zypp
           MIL << "Providing file of repo '" << repo_r.alias() << "' from " << url << endl;
           shared_ptr<MediaSetAccess> access = _impl->mediaAccessForUrl( url, repo_r );
 
-	  fetcher.enqueue( loc_r );
+	  if ( deltafile_r.empty() )
+	    fetcher.enqueue( loc_r );
+	  else
+	    fetcher.enqueueDigested( loc_r, FileChecker(), deltafile_r );
 	  fetcher.start( destinationDir, *access );
 
 	  // reached if no exception has been thrown, so this is the correct file
@@ -343,6 +352,24 @@ namespace zypp
       return ManagedFile(); // not reached
     }
 
+    void RepoMediaAccess::prefetchFiles( RepoInfo repo_r, const std::list<OnMediaLocation> & locs_r )
+    {
+      if ( repo_r.baseUrlsEmpty() || locs_r.empty() )
+        return;
+
+      // provideFile starts with the first url, so this is where we prefetch.
+      try
+      {
+        shared_ptr<MediaSetAccess> access = _impl->mediaAccessForUrl( *repo_r.baseUrlsBegin(), repo_r );
+        access->prefetchFiles( locs_r );
+      }
+      catch ( const Exception & excpt )
+      {
+        ZYPP_CAUGHT( excpt );
+        WAR << "Failed to prefetch files of repo '" << repo_r.alias() << "'" << endl;
+      }
+    }
+
     /////////////////////////////////////////////////////////////////
   } // namespace repo
   ///////////////////////////////////////////////////////////////////
@@ -13,6 +13,7 @@
 #define ZYPP_REPO_REPOPROVIDEFILE_H
 
 #include <iosfwd>
+#include <list>
 
 #include "zypp/base/PtrTypes.h"
 #include "zypp/base/Function.h"
@@ -77,10 +78,29 @@ namespace zypp
                                const OnMediaLocation & loc_r,
                                const ProvideFilePolicy & policy_r );
 
+      /** \overload Passing a local \a deltafile_r the media may take
+       * matching blocks from rather than downloading them (metalink).
+       * The file must come with a checksum to verify the result.
+       */
+      ManagedFile provideFile( RepoInfo repo_r,
+                               const OnMediaLocation & loc_r,
+                               const ProvideFilePolicy & policy_r,
+                               const Pathname & deltafile_r );
+
       /** \overload Using the current default \ref ProvideFilePolicy. */
       ManagedFile provideFile( RepoInfo repo_r, const OnMediaLocation & loc_r )
       { return provideFile( repo_r, loc_r, defaultPolicy() ); }
 
+      /** Hint that the files described by \a locs_r will be requested
+       * from the Repository soon.
+       *
+       * The media may download them in advance (concurrently), so the
+       * following \ref provideFile calls are served locally. All checksum
+       * verification and reporting still happens in \ref provideFile.
+       * Errors are not propagated.
+       */
+      void prefetchFiles( RepoInfo repo_r, const std::list<OnMediaLocation> & locs_r );
+
     public:
       /** Set a new default \ref ProvideFilePolicy. */
       void setDefaultPolicy( const ProvideFilePolicy & policy_r );
@@ -12,6 +12,7 @@
 #include "zypp/base/LogTools.h"
 #include "zypp/base/Function.h"
 #include "zypp/ZConfig.h"
+#include "zypp/PathInfo.h"
 
 #include "zypp/parser/yum/RepomdFileReader.h"
 #include "zypp/parser/yum/PatchesFileReader.h"
@@ -37,7 +38,14 @@ Downloader::Downloader( const RepoInfo &repoinfo , const Pathname &delta_dir)
 
 RepoStatus Downloader::status( MediaSetAccess &media )
 {
-  return RepoStatus( media.provideFile( repoInfo().path() / "/repodata/repomd.xml" ) )
+  Pathname masterIndex;
+  return status( media, masterIndex );
+}
+
+RepoStatus Downloader::status( MediaSetAccess &media, Pathname & masterIndex_r )
+{
+  masterIndex_r = media.provideFile( repoInfo().path() / "/repodata/repomd.xml" );
+  return RepoStatus( masterIndex_r )
       && RepoStatus( media.provideOptionalFile( "/media.1/media" ) );
 }
 
@@ -150,6 +158,41 @@ namespace
 } // namespace
 ///////////////////////////////////////////////////////////////////
 
+void Downloader::prefetch( MediaSetAccess & media, const Pathname & masterIndex_r )
+{
+  Pathname masterIndex( repoInfo().path() / "/repodata/repomd.xml" );
+  std::list<OnMediaLocation> files;
+  files.push_back( OnMediaLocation( "/media.1/media", 1 ) );
+  files.push_back( OnMediaLocation( masterIndex, 1 ) );
+  files.push_back( OnMediaLocation( masterIndex.extend( ".asc" ), 1 ) );
+  files.push_back( OnMediaLocation( masterIndex.extend( ".key" ), 1 ) );
+
+  // the files download will enqueue; unchanged ones are copied from the raw cache
+  RepomdFileReaderCallback2 pimpl( [&]( const OnMediaLocation & loc_r, const ResourceType & dtype_r ) -> bool {
+    OnMediaLocation loc( loc_with_path_prefix( loc_r, repoInfo().path() ) );
+    const CheckSum & checksum( loc.checksum() );
+    Pathname cached( _delta_dir / loc.filename() );
+    if ( ! checksum.empty() && PathInfo( cached ).isFile()
+         && checksum == CheckSum( checksum.type(), filesystem::checksum( cached, checksum.type() ) ) )
+      return true;
+    files.push_back( loc );
+    return true;
+  } );
+
+  try
+  {
+    RepomdFileReader( masterIndex_r,
+		      RepomdFileReader::ProcessResource2( bind(&RepomdFileReaderCallback2::repomd_Callback2, &pimpl, _1, _2, _3) ) );
+  }
+  catch ( const Exception & excpt )
+  {
+    // download will complain
+    ZYPP_CAUGHT( excpt );
+  }
+  MIL << "Prefetch " << files.size() << " files for " << repoInfo().alias() << endl;
+  media.prefetchFiles( files );
+}
+
 bool Downloader::repomd_Callback( const OnMediaLocation & loc_r, const ResourceType & dtype_r )
 {
   // NOTE: Filtering of unwanted files is done in RepomdFileReaderCallback2!
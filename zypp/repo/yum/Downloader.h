@@ -67,6 +67,22 @@ namespace zypp
          * \short Status of the remote repository
          */
         RepoStatus status( MediaSetAccess &media );
+
+        /**
+         * \short Status of the remote repository
+         * Also returns the provided master index (repomd.xml) in \a masterIndex_r.
+         */
+        RepoStatus status( MediaSetAccess &media, Pathname & masterIndex_r );
+
+        /**
+         * \short Prefetch the files \ref download will retrieve
+         *
+         * Hands the files listed in the remote master index \a masterIndex_r
+         * (as provided by \ref status) to \ref MediaSetAccess::prefetchFiles,
+         * together with the master index, its signature and key. Files still
+         * unchanged in the old raw cache (the \c delta_dir) are omitted.
+         */
+        void prefetch( MediaSetAccess &media, const Pathname & masterIndex_r );
         
        protected:
         bool repomd_Callback( const OnMediaLocation &loc, const ResourceType &dtype );
@@ -14,6 +14,9 @@ extern "C"
 }
 #include <iostream>
 #include <exception>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
 #include "zypp/base/LogTools.h"
 #include "zypp/base/String.h"
 
@@ -103,6 +106,91 @@ namespace zypp
       return MAPTST( _pimpl, idx_r );
     }
 
+    Map::size_type Map::count() const
+    {
+      size_type ret = 0;
+      const unsigned char * byte = _pimpl->map;
+      const unsigned char * end  = byte + _pimpl->size;
+      for ( ; byte + sizeof(uint64_t) <= end; byte += sizeof(uint64_t) )
+      {
+	uint64_t word;
+	::memcpy( &word, byte, sizeof(word) );
+	ret += __builtin_popcountll( word );
+      }
+      for ( ; byte < end; ++byte )
+	ret += __builtin_popcount( *byte );
+      return ret;
+    }
+
+    Map::size_type Map::findNext( size_type idx_r ) const
+    {
+      size_type bytes = _pimpl->size;
+      size_type byte  = idx_r >> 3;
+      if ( byte >= bytes )
+	return size();
+
+      // rest of the 1st byte
+      unsigned val = _pimpl->map[byte] >> ( idx_r & 7 );
+      if ( val )
+	return idx_r + __builtin_ctz( val );
+
+      // skip zero words, then zero bytes
+      for ( ++byte; byte + sizeof(uint64_t) <= bytes; byte += sizeof(uint64_t) )
+      {
+	uint64_t word;
+	::memcpy( &word, _pimpl->map + byte, sizeof(word) );
+	if ( word )
+	  break;
+      }
+      for ( ; byte < bytes; ++byte )
+      {
+	if ( _pimpl->map[byte] )
+	  return ( byte << 3 ) + __builtin_ctz( _pimpl->map[byte] );
+      }
+      return size();
+    }
+
+    Map & Map::operator|=( const Map & rhs )
+    {
+      const detail::CMap * r = rhs;
+      if ( r->size )
+      {
+	grow( size_type(r->size) << 3 );
+	detail::CMap * l = _pimpl.get();
+	for ( int i = 0; i < r->size; ++i )
+	  l->map[i] |= r->map[i];
+      }
+      return *this;
+    }
+
+    Map & Map::operator&=( const Map & rhs )
+    {
+      if ( _pimpl->size )
+      {
+	const detail::CMap * r = rhs;
+	detail::CMap * l = _pimpl.get();
+	int common = std::min( l->size, r->size );
+	for ( int i = 0; i < common; ++i )
+	  l->map[i] &= r->map[i];
+	if ( l->size > common )
+	  ::memset( l->map + common, 0, l->size - common );
+      }
+      return *this;
+    }
+
+    Map & Map::operator-=( const Map & rhs )
+    {
+      const detail::CMap * r = rhs;
+      if ( _pimpl->size && r->size )
+      {
+	detail::CMap * l = _pimpl.get();
+	int common = std::min( l->size, r->size );
+	for ( int i = 0; i < common; ++i )
+	  l->map[i] &= ~r->map[i];
+      }
+      return *this;
+    }
+
     std::string Map::asString( const char on_r, const char off_r ) const
     {
       if ( empty() )
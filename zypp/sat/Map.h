@@ -100,6 +100,24 @@ namespace zypp
       bool operator[]( size_type idx_r ) const
       { return test( idx_r ); }
 
+      /** Number of bits set. */
+      size_type count() const;
+
+      /** Index of the first bit set at or after \c idx_r, or \ref size if there is none.
+       * Zero bits are skipped word-wise, so iterating a sparse Map is cheap.
+       */
+      size_type findNext( size_type idx_r ) const;
+
+    public:
+      /** Set all bits set in \c rhs (union). The Map grows if \c rhs is larger. */
+      Map & operator|=( const Map & rhs );
+
+      /** Clear all bits not set in \c rhs (intersection). */
+      Map & operator&=( const Map & rhs );
+
+      /** Clear all bits set in \c rhs (difference). */
+      Map & operator-=( const Map & rhs );
+
     public:
       /** String representation */
       std::string asString( const char on_r = '1', const char off_r = '0' ) const;
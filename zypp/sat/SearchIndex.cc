@@ -0,0 +1,580 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/sat/SearchIndex.cc
+ */
+extern "C"
+{
+#include <solv/pool.h>
+#include <solv/repo.h>
+#include <solv/repo_solv.h>
+#include <solv/repodata.h>
+#include <solv/solvable.h>
+}
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/AutoDispose.h"
+#include "zypp/PathInfo.h"
+
+#include "zypp/sat/SearchIndex.h"
+
+#undef ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "searchidx"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace sat
+  {
+    ///////////////////////////////////////////////////////////////////
+    namespace
+    {
+      // File layout (integers are 32bit little endian):
+      //   MAGIC VERSION tag
+      //   #solvables [solvable hash]...
+      //   #attrs [attrname #trigrams [trigram count offset]... #bytes postings]...
+      // Strings are stored as length + bytes. The postings of a trigram are the
+      // ascending positions of the solvables in the solv file, delta encoded as
+      // 7bit varints.
+      const char     MAGIC[] = "ZYPPSRCH";
+      const uint32_t VERSION = 1;
+
+      inline void putU32( std::string & out_r, uint32_t val_r )
+      {
+        for ( unsigned i = 0; i < 4; ++i, val_r >>= 8 )
+          out_r += char( val_r & 0xff );
+      }
+
+      inline void putStr( std::string & out_r, const std::string & val_r )
+      {
+        putU32( out_r, val_r.size() );
+        out_r += val_r;
+      }
+
+      inline void putVarint( std::string & out_r, uint32_t val_r )
+      {
+        for ( ; val_r >= 0x80; val_r >>= 7 )
+          out_r += char( ( val_r & 0x7f ) | 0x80 );
+        out_r += char( val_r );
+      }
+
+      /** Sequential reader; any read beyond the end sets \ref _bad. */
+      struct Reader
+      {
+        Reader( const std::string & data_r )
+        : _data( data_r ), _pos( 0 ), _bad( false )
+        {}
+
+        bool check( size_t len_r )
+        {
+          if ( ! _bad && _data.size() - _pos < len_r )
+            _bad = true;
+          return ! _bad;
+        }
+
+        uint32_t u32()
+        {
+          uint32_t ret = 0;
+          if ( check( 4 ) )
+          {
+            for ( unsigned i = 0; i < 4; ++i )
+              ret |= uint32_t( (unsigned char)_data[_pos+i] ) << ( 8 * i );
+            _pos += 4;
+          }
+          return ret;
+        }
+
+        std::string str()
+        {
+          uint32_t len = u32();
+          if ( ! check( len ) )
+            return std::string();
+          std::string ret( _data, _pos, len );
+          _pos += len;
+          return ret;
+        }
+
+        const std::string & _data;
+        size_t _pos;
+        bool _bad;
+      };
+
+      /** FNV-1a over name, evr and arch; identifies a solvable in the solv file and the pool. */
+      uint32_t solvableHash( const char * name_r, const char * evr_r, const char * arch_r )
+      {
+        uint32_t ret = 2166136261U;
+        for ( const char * str : { name_r, evr_r, arch_r } )
+        {
+          for ( const char * ch = str; ch && *ch; ++ch )
+            ret = ( ret ^ (unsigned char)*ch ) * 16777619U;
+          ret = ( ret ^ 0xff ) * 16777619U;
+        }
+        return ret;
+      }
+
+      inline unsigned char lower( char ch_r )
+      { return( ch_r >= 'A' && ch_r <= 'Z' ? ch_r - 'A' + 'a' : (unsigned char)ch_r ); }
+
+      /** Append the trigrams of \a str_r to \a tris_r. */
+      void addTrigrams( std::vector<uint32_t> & tris_r, const char * str_r, size_t len_r )
+      {
+        if ( len_r < 3 )
+          return;
+        uint32_t tri = ( lower( str_r[0] ) << 8 ) | lower( str_r[1] );
+        for ( size_t i = 2; i < len_r; ++i )
+        {
+          tri = ( ( tri << 8 ) | lower( str_r[i] ) ) & 0xffffff;
+          tris_r.push_back( tri );
+        }
+      }
+
+      /** The literal parts of the search string every match must contain. */
+      std::vector<std::string> literals( const StrMatcher & matcher_r )
+      {
+        std::vector<std::string> ret;
+        const std::string & search( matcher_r.searchstring() );
+
+        switch ( matcher_r.flags().mode() )
+        {
+          case Match::STRING:
+          case Match::STRINGSTART:
+          case Match::STRINGEND:
+          case Match::SUBSTRING:
+            ret.push_back( search );
+            break;
+
+          case Match::GLOB:
+          {
+            std::string lit;
+            for ( size_t i = 0; i < search.size(); ++i )
+            {
+              char ch = search[i];
+              if ( ch == '*' || ch == '?' || ch == '[' )
+              {
+                if ( ! lit.empty() )
+                  ret.push_back( std::move(lit) );
+                lit.clear();
+                if ( ch == '[' )	// skip the bracket expression
+                {
+                  ++i;
+                  if ( i < search.size() && ( search[i] == '!' || search[i] == '^' ) )
+                    ++i;
+                  if ( i < search.size() && search[i] == ']' )
+                    ++i;
+                  while ( i < search.size() && search[i] != ']' )
+                    ++i;
+                }
+              }
+              else if ( ch == '\\' && i + 1 < search.size() )
+                lit += search[++i];
+              else
+                lit += ch;
+            }
+            if ( ! lit.empty() )
+              ret.push_back( std::move(lit) );
+          }
+          break;
+
+          default:	// no literals we could rely on
+            break;
+        }
+        return ret;
+      }
+
+      /** The solvable key names indexed. */
+      const std::vector<detail::IdType> & indexedKeys()
+      {
+        static const std::vector<detail::IdType> _keys = {
+          SOLVABLE_NAME, SOLVABLE_SUMMARY, SOLVABLE_DESCRIPTION, SOLVABLE_FILELIST
+        };
+        return _keys;
+      }
+
+      ///////////////////////////////////////////////////////////////////
+      /// \class RepoIndex
+      /// \brief An index attached to a repo (immutable once attached).
+      ///////////////////////////////////////////////////////////////////
+      struct RepoIndex
+      {
+        struct Entry
+        {
+          uint32_t _trigram;
+          uint32_t _count;
+          uint32_t _offset;
+          bool operator<( uint32_t trigram_r ) const
+          { return _trigram < trigram_r; }
+        };
+
+        struct AttrIndex
+        {
+          SolvAttr           _attr;
+          std::vector<Entry> _table;
+          std::string        _postings;
+
+          /** Decode the postings of \a entry_r. */
+          std::vector<uint32_t> postings( const Entry & entry_r ) const
+          {
+            std::vector<uint32_t> ret;
+            ret.reserve( entry_r._count );
+            const unsigned char * data = (const unsigned char *)_postings.data() + entry_r._offset;
+            const unsigned char * end  = (const unsigned char *)_postings.data() + _postings.size();
+            uint32_t pos = 0;
+            for ( uint32_t n = 0; n < entry_r._count && data < end; ++n )
+            {
+              uint32_t delta = 0;
+              for ( unsigned shift = 0; data < end; shift += 7 )
+              {
+                delta |= uint32_t( *data & 0x7f ) << shift;
+                if ( ! ( *data++ & 0x80 ) )
+                  break;
+              }
+              pos += delta;
+              ret.push_back( pos );
+            }
+            return ret;
+          }
+        };
+
+        std::string _alias;
+        Repository::size_type _size;
+        std::vector<detail::SolvableIdType> _pos2id;	// position in the solv file to solvable id (0 if removed)
+        std::vector<AttrIndex> _attrs;
+
+        /** Guard against solvables added to or removed from the repo meanwhile.
+         * (A repo erased from the pool is detached, see \ref Repository::eraseFromPool.)
+         */
+        bool valid( Repository repo_r ) const
+        { return repo_r.alias() == _alias && repo_r.solvablesSize() == _size; }
+
+        const AttrIndex * attr( SolvAttr attr_r ) const
+        {
+          for ( const AttrIndex & attr : _attrs )
+            if ( attr._attr == attr_r )
+              return &attr;
+          return nullptr;
+        }
+      };
+
+      typedef std::map<Repository,shared_ptr<const RepoIndex>> Registry;
+
+      std::mutex & registryMutex()
+      {
+        static std::mutex _mutex;
+        return _mutex;
+      }
+
+      Registry & registry()
+      {
+        static Registry _registry;
+        return _registry;
+      }
+
+    } // namespace
+    ///////////////////////////////////////////////////////////////////
+
+    bool SearchIndex::build( const Pathname & solvfile_r, const RepoStatus & status_r )
+    {
+      Pathname idxfile( indexFile( solvfile_r ) );
+      filesystem::unlink( idxfile );
+
+      AutoDispose<FILE*> solv( ::fopen( solvfile_r.c_str(), "re" ), ::fclose );
+      if ( solv == NULL )
+      {
+        solv.resetDispose();
+        ERR << "Can't open solv-file: " << solvfile_r << endl;
+        return false;
+      }
+
+      AutoDispose<detail::CPool*> pool( ::pool_create(), ::pool_free );
+      detail::CRepo * repo = ::repo_create( pool, "" );
+      if ( ::repo_add_solv( repo, solv, 0 ) != 0 )
+      {
+        ERR << "Can't read solv-file: " << ::pool_errstr( pool ) << endl;
+        return false;
+      }
+
+      const std::vector<detail::IdType> & keys( indexedKeys() );
+      std::vector<std::unordered_map<uint32_t,std::vector<uint32_t>>> postings( keys.size() );
+      std::vector<uint32_t> hashes;
+      std::vector<uint32_t> tris;
+
+      detail::IdType p = 0;
+      detail::CSolvable * s = nullptr;
+      FOR_REPO_SOLVABLES( repo, p, s )
+      {
+        uint32_t pos = hashes.size();
+        hashes.push_back( solvableHash( ::pool_id2str( pool, s->name ), ::pool_id2str( pool, s->evr ), ::pool_id2str( pool, s->arch ) ) );
+
+        for ( unsigned k = 0; k < keys.size(); ++k )
+        {
+          tris.clear();
+          if ( keys[k] == SOLVABLE_NAME )
+          {
+            const char * name = ::pool_id2str( pool, s->name );
+            addTrigrams( tris, name, ::strlen( name ) );
+          }
+          else
+          {
+            ::Dataiterator di;
+            ::dataiterator_init( &di, pool, repo, p, keys[k], 0, 0 );
+            while ( ::dataiterator_step( &di ) )
+            {
+              const char * str = di.kv.str;
+              if ( di.key->type == REPOKEY_TYPE_DIRSTRARRAY )
+                str = ::repodata_dir2str( di.data, di.kv.id, di.kv.str );	// full path
+              if ( str )
+                addTrigrams( tris, str, ::strlen( str ) );
+            }
+            ::dataiterator_free( &di );
+          }
+          std::sort( tris.begin(), tris.end() );
+          tris.erase( std::unique( tris.begin(), tris.end() ), tris.end() );
+          for ( uint32_t tri : tris )
+            postings[k][tri].push_back( pos );
+        }
+      }
+
+      std::string out( MAGIC );
+      putU32( out, VERSION );
+      putStr( out, str::Str() << status_r );
+      putU32( out, hashes.size() );
+      for ( uint32_t hash : hashes )
+        putU32( out, hash );
+
+      putU32( out, keys.size() );
+      for ( unsigned k = 0; k < keys.size(); ++k )
+      {
+        std::vector<uint32_t> trigrams;
+        trigrams.reserve( postings[k].size() );
+        for ( const auto & entry : postings[k] )
+          trigrams.push_back( entry.first );
+        std::sort( trigrams.begin(), trigrams.end() );
+
+        std::string blob;
+        putStr( out, ::pool_id2str( pool, keys[k] ) );
+        putU32( out, trigrams.size() );
+        for ( uint32_t tri : trigrams )
+        {
+          const std::vector<uint32_t> & list( postings[k][tri] );
+          putU32( out, tri );
+          putU32( out, list.size() );
+          putU32( out, blob.size() );
+          uint32_t last = 0;
+          for ( uint32_t pos : list )
+          {
+            putVarint( blob, pos - last );
+            last = pos;
+          }
+        }
+        putStr( out, blob );
+        postings[k].clear();
+      }
+
+      Pathname tmpfile( idxfile.extend( ".new" ) );
+      {
+        std::ofstream file( tmpfile.c_str(), std::ios::binary | std::ios::trunc );
+        file.write( out.data(), out.size() );
+        if ( ! file.flush() )
+        {
+          ERR << "Can't write " << tmpfile << endl;
+          filesystem::unlink( tmpfile );
+          return false;
+        }
+      }
+      if ( filesystem::rename( tmpfile, idxfile ) != 0 )
+      {
+        filesystem::unlink( tmpfile );
+        return false;
+      }
+      MIL << "Built " << idxfile << " (" << hashes.size() << " solvables, " << out.size() << " bytes)" << endl;
+      return true;
+    }
+
+    bool SearchIndex::attach( Repository repo_r, const Pathname & solvfile_r, const RepoStatus & status_r )
+    {
+      detach( repo_r );
+
+      Pathname idxfile( indexFile( solvfile_r ) );
+      if ( ! repo_r || ! PathInfo( idxfile ).isFile() )
+        return false;
+
+      std::string data;
+      {
+        std::ifstream file( idxfile.c_str(), std::ios::binary );
+        data.assign( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+      }
+
+      Reader in( data );
+      if ( ! in.check( sizeof(MAGIC)-1 ) || data.compare( 0, sizeof(MAGIC)-1, MAGIC ) != 0 )
+      {
+        WAR << "Not a search index: " << idxfile << endl;
+        return false;
+      }
+      in._pos += sizeof(MAGIC)-1;
+      if ( in.u32() != VERSION || in.str() != std::string( str::Str() << status_r ) )
+      {
+        MIL << "Outdated search index: " << idxfile << endl;
+        return false;
+      }
+
+      shared_ptr<RepoIndex> idx( new RepoIndex );
+      idx->_alias = repo_r.alias();
+      idx->_size = repo_r.solvablesSize();
+
+      // Map the solvables in the file to the ones in the pool. Solvables of
+      // incompatible architectures may have been removed when loading the repo.
+      uint32_t nsolv = in.u32();
+      if ( ! in.check( size_t(nsolv) * 4 ) )
+      {
+        WAR << "Corrupt search index: " << idxfile << endl;
+        return false;
+      }
+      std::vector<uint32_t> hashes( nsolv );
+      for ( uint32_t & hash : hashes )
+        hash = in.u32();
+
+      idx->_pos2id.assign( nsolv, detail::noSolvableId );
+      uint32_t pos = 0;
+      for ( const Solvable & solv : repo_r.solvables() )
+      {
+        const detail::CSolvable * s( solv.get() );
+        uint32_t hash = solvableHash( IdString( s->name ).c_str(), IdString( s->evr ).c_str(), IdString( s->arch ).c_str() );
+        while ( pos < nsolv && hashes[pos] != hash )
+          ++pos;
+        if ( pos == nsolv )
+        {
+          WAR << "Search index does not match the repo content: " << idxfile << endl;
+          return false;
+        }
+        idx->_pos2id[pos++] = solv.id();
+      }
+
+      for ( uint32_t nattr = in.u32(); nattr && ! in._bad; --nattr )
+      {
+        RepoIndex::AttrIndex attr;
+        attr._attr = SolvAttr( in.str() );
+        uint32_t ntri = in.u32();
+        if ( ! in.check( size_t(ntri) * 12 ) )
+          break;
+        attr._table.resize( ntri );
+        for ( RepoIndex::Entry & entry : attr._table )
+        {
+          entry._trigram = in.u32();
+          entry._count   = in.u32();
+          entry._offset  = in.u32();
+        }
+        attr._postings = in.str();
+        idx->_attrs.push_back( std::move(attr) );
+      }
+      if ( in._bad )
+      {
+        WAR << "Corrupt search index: " << idxfile << endl;
+        return false;
+      }
+
+      MIL << "Attached search index to " << repo_r.alias() << endl;
+      std::lock_guard<std::mutex> lock( registryMutex() );
+      registry()[repo_r] = idx;
+      return true;
+    }
+
+    void SearchIndex::detach( Repository repo_r )
+    {
+      std::lock_guard<std::mutex> lock( registryMutex() );
+      registry().erase( repo_r );
+    }
+
+    bool SearchIndex::indexed( SolvAttr attr_r )
+    {
+      return( attr_r == SolvAttr::name || attr_r == SolvAttr::summary
+           || attr_r == SolvAttr::description || attr_r == SolvAttr::filelist );
+    }
+
+    bool SearchIndex::available()
+    {
+      std::lock_guard<std::mutex> lock( registryMutex() );
+      return ! registry().empty();
+    }
+
+    bool SearchIndex::candidates( Repository repo_r, SolvAttr attr_r, const StrMatcher & matcher_r, std::vector<Solvable> & result_r )
+    {
+      if ( ! indexed( attr_r ) || ! matcher_r )
+        return false;
+
+      std::vector<uint32_t> tris;
+      for ( const std::string & lit : literals( matcher_r ) )
+        addTrigrams( tris, lit.c_str(), lit.size() );
+      if ( tris.empty() )
+        return false;
+      std::sort( tris.begin(), tris.end() );
+      tris.erase( std::unique( tris.begin(), tris.end() ), tris.end() );
+
+      shared_ptr<const RepoIndex> idx;
+      {
+        std::lock_guard<std::mutex> lock( registryMutex() );
+        Registry::iterator it( registry().find( repo_r ) );
+        if ( it == registry().end() )
+          return false;
+        if ( ! it->second->valid( repo_r ) )
+        {
+          registry().erase( it );	// repo content changed
+          return false;
+        }
+        idx = it->second;
+      }
+
+      const RepoIndex::AttrIndex * attr( idx->attr( attr_r ) );
+      if ( ! attr )
+        return false;
+
+      result_r.clear();
+      std::vector<const RepoIndex::Entry *> entries;
+      for ( uint32_t tri : tris )
+      {
+        auto it( std::lower_bound( attr->_table.begin(), attr->_table.end(), tri ) );
+        if ( it == attr->_table.end() || it->_trigram != tri )
+          return true;	// no solvable contains it
+        entries.push_back( &*it );
+      }
+      // intersect, starting with the rarest trigram
+      std::sort( entries.begin(), entries.end(), []( const RepoIndex::Entry * lhs, const RepoIndex::Entry * rhs ) {
+        return lhs->_count < rhs->_count;
+      } );
+      std::vector<uint32_t> positions( attr->postings( *entries.front() ) );
+      for ( unsigned i = 1; i < entries.size() && ! positions.empty(); ++i )
+      {
+        std::vector<uint32_t> next( attr->postings( *entries[i] ) );
+        std::vector<uint32_t> common;
+        std::set_intersection( positions.begin(), positions.end(), next.begin(), next.end(), std::back_inserter( common ) );
+        positions.swap( common );
+      }
+
+      for ( uint32_t pos : positions )
+      {
+        if ( pos < idx->_pos2id.size() && idx->_pos2id[pos] != detail::noSolvableId )
+          result_r.push_back( Solvable( idx->_pos2id[pos] ) );
+      }
+      return true;
+    }
+
+  } // namespace sat
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
@@ -0,0 +1,93 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/sat/SearchIndex.h
+ */
+#ifndef ZYPP_SAT_SEARCHINDEX_H
+#define ZYPP_SAT_SEARCHINDEX_H
+
+#include <iosfwd>
+#include <vector>
+
+#include "zypp/Pathname.h"
+#include "zypp/RepoStatus.h"
+#include "zypp/Repository.h"
+#include "zypp/sat/Solvable.h"
+#include "zypp/sat/SolvAttr.h"
+#include "zypp/base/StrMatcher.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace sat
+  {
+    ///////////////////////////////////////////////////////////////////
+    /// \class SearchIndex
+    /// \brief Optional per repository trigram index for string searches.
+    ///
+    /// If \ref ZConfig::repo_search_index is enabled, \ref RepoManager builds the
+    /// index alongside the repos solv file (<tt>solv.search</tt>). For each indexed
+    /// attribute (\c name, \c summary, \c description and \c filelist) it maps the
+    /// (ASCII lowercased) trigrams found in the attribute strings to the solvables
+    /// containing them.
+    ///
+    /// \ref PoolQuery uses an attached index for \c STRING, \c SUBSTRING and \c GLOB
+    /// searches on a single indexed attribute. Rather than scanning all attribute
+    /// strings of a repo, just the candidate solvables returned by the index are
+    /// matched.
+    ///
+    /// The index is tagged with the \ref RepoStatus of the metadata it was built
+    /// from, and is only attached if the tag matches the current cache cookie.
+    ///////////////////////////////////////////////////////////////////
+    class SearchIndex
+    {
+    public:
+      /** The index file built for \a solvfile_r. */
+      static Pathname indexFile( const Pathname & solvfile_r )
+      { return solvfile_r.extend( ".search" ); }
+
+      /** Build the index for \a solvfile_r, tagged with \a status_r.
+       * \return \c false if the index could not be built (any old index is removed).
+       */
+      static bool build( const Pathname & solvfile_r, const RepoStatus & status_r );
+
+      /** Use the index built for \a solvfile_r for \a repo_r (just loaded from \a solvfile_r).
+       * \return \c false if there is no index or it is not tagged with \a status_r.
+       */
+      static bool attach( Repository repo_r, const Pathname & solvfile_r, const RepoStatus & status_r );
+
+      /** Forget the index attached to \a repo_r (if any).
+       * Called when the repo is erased from the pool, as libsolv may reuse it.
+       */
+      static void detach( Repository repo_r );
+
+      /** Whether \a attr_r is an indexed attribute. */
+      static bool indexed( SolvAttr attr_r );
+
+      /** Whether an index is attached to any repo. */
+      static bool available();
+
+      /** The solvables of \a repo_r which may match \a matcher_r in \a attr_r, in id order.
+       *
+       * The candidates are a superset of the actual matches. They still have to be
+       * matched against \a matcher_r.
+       *
+       * \return \c false if the index can't narrow the search: no valid index attached,
+       * unsupported match mode or less than 3 literal characters in the search string.
+       *
+       * \note Thread safe.
+       */
+      static bool candidates( Repository repo_r, SolvAttr attr_r, const StrMatcher & matcher_r, std::vector<Solvable> & result_r );
+    };
+
+  } // namespace sat
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_SAT_SEARCHINDEX_H
@@ -0,0 +1,63 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/sat/SolvableMap.cc
+ *
+*/
+#include <iostream>
+#include <algorithm>
+#include "zypp/base/LogTools.h"
+
+#include "zypp/sat/SolvableMap.h"
+#include "zypp/sat/Pool.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////
+  namespace sat
+  { /////////////////////////////////////////////////////////////////
+
+    bool SolvableMap::insertId( detail::SolvableIdType id_r )
+    {
+      if ( id_r == detail::noSolvableId )
+	return false;
+      if ( id_r >= _map.size() )
+	_map.grow( std::max( size_type(id_r) + 1, size_type(Pool::instance().capacity()) ) ); // grow once per pool size
+      else if ( _map.test( id_r ) )
+	return false;
+      _map.set( id_r );
+      return true;
+    }
+
+    bool SolvableMap::eraseId( detail::SolvableIdType id_r )
+    {
+      if ( ! containsId( id_r ) )
+	return false;
+      _map.clear( id_r );
+      return true;
+    }
+
+    /******************************************************************
+    **
+    **	FUNCTION NAME : operator<<
+    **	FUNCTION TYPE : std::ostream &
+    */
+    std::ostream & operator<<( std::ostream & str, const SolvableMap & obj )
+    {
+      return dumpRange( str, obj.begin(), obj.end() );
+    }
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace sat
+  ///////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
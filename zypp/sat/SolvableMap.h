@@ -0,0 +1,202 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file	zypp/sat/SolvableMap.h
+ *
+*/
+#ifndef ZYPP_SAT_SOLVABLEMAP_H
+#define ZYPP_SAT_SOLVABLEMAP_H
+
+#include <iosfwd>
+
+#include "zypp/base/Iterator.h"
+#include "zypp/sat/Map.h"
+#include "zypp/sat/Solvable.h"
+#include "zypp/sat/SolvIterMixin.h"
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{ /////////////////////////////////////////////////////////////////
+  ///////////////////////////////////////////////////////////////////
+  namespace sat
+  { /////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    namespace detail
+    {
+      /** Iterate the \ref Solvable ids set in a \ref Map (in id order). */
+      class SolvableMapIterator : public boost::iterator_facade<
+          SolvableMapIterator                // Derived
+          , const Solvable                   // Value
+          , boost::forward_traversal_tag     // CategoryOrTraversal
+          , const Solvable                   // Reference
+          >
+      {
+        public:
+          SolvableMapIterator()
+          : _map( nullptr ), _idx( 0 )
+          {}
+
+          SolvableMapIterator( const Map & map_r, Map::size_type idx_r )
+          : _map( &map_r ), _idx( map_r.findNext( idx_r ) )
+          {}
+
+        private:
+          friend class boost::iterator_core_access;
+
+          Solvable dereference() const
+          { return Solvable( _idx ); }
+
+          void increment()
+          { _idx = _map->findNext( _idx + 1 ); }
+
+          bool equal( const SolvableMapIterator & rhs ) const
+          { return _idx == rhs._idx; }
+
+        private:
+          const Map * _map;
+          Map::size_type _idx;
+      };
+    } // namespace detail
+    ///////////////////////////////////////////////////////////////////
+
+    ///////////////////////////////////////////////////////////////////
+    //
+    //	CLASS NAME : SolvableMap
+    //
+    /** Solvable set based on a \ref Map (one bit per solvable id).
+     *
+     * Unlike \ref SolvableSet, insert, lookup and the set operations do not
+     * hash, and the \ref Solvable are iterated in id order. Use it for sets
+     * which may hold a considerable part of the pool (e.g. query based locks).
+     *
+     * \note Iterators refer to the Map; don't modify the set while iterating.
+     */
+    class SolvableMap : public SolvIterMixin<SolvableMap,detail::SolvableMapIterator>
+    {
+      friend std::ostream & operator<<( std::ostream & str, const SolvableMap & obj );
+
+      public:
+        typedef Map::size_type                    size_type;
+        typedef Solvable_iterator                 const_iterator; // from SolvIterMixin
+
+      public:
+        /** Default ctor */
+        SolvableMap()
+        {}
+
+        /** Ctor building a set from a range. */
+        template<class TInputIterator>
+        SolvableMap( TInputIterator begin_r, TInputIterator end_r )
+        { insert( begin_r, end_r ); }
+
+      public:
+        /** Whether the set is epmty. */
+        bool empty() const
+        { return _map.findNext( 0 ) == _map.size(); }
+
+        /** Size of the set. */
+        size_type size() const
+        { return _map.count(); }
+
+	/** */
+	template<class TSolv>
+	bool contains( const TSolv & solv_r ) const
+	{ return containsId( asSolvable()( solv_r ).id() ); }
+
+        /** Iterator pointing to the first \ref Solvable. */
+        const_iterator begin() const
+        { return const_iterator( _map, 0 ); }
+
+        /** Iterator pointing behind the last \ref Solvable. */
+        const_iterator end() const
+        { return const_iterator( _map, _map.size() ); }
+
+      public:
+	/** Clear the container */
+	void clear()
+	{ _map.clearAll(); }
+
+	/** Insert a Solvable.
+	 * \return \c true if it was actually inserted, or \c false if already present.
+	 */
+	template<class TSolv>
+	bool insert( const TSolv & solv_r )
+	{ return insertId( asSolvable()( solv_r ).id() ); }
+
+	/** Insert a range of Solvables. */
+	template<class TIterator>
+	void insert( TIterator begin_r, TIterator end_r )
+	{ for_( it, begin_r, end_r ) insert( *it ); }
+
+	/** Remove a Solvable.
+	 * \return \c true if it was actually removed, or \c false if not present.
+	 */
+	template<class TSolv>
+	bool erase( const TSolv & solv_r )
+	{ return eraseId( asSolvable()( solv_r ).id() ); }
+
+      public:
+	/** Union */
+	SolvableMap & operator|=( const SolvableMap & rhs )
+	{ _map |= rhs._map; return *this; }
+
+	/** Intersection */
+	SolvableMap & operator&=( const SolvableMap & rhs )
+	{ _map &= rhs._map; return *this; }
+
+	/** Difference */
+	SolvableMap & operator-=( const SolvableMap & rhs )
+	{ _map -= rhs._map; return *this; }
+
+      public:
+        /** The bitmap. */
+        const Map & get() const
+        { return _map; }
+
+      private:
+	bool containsId( detail::SolvableIdType id_r ) const
+	{ return( id_r < _map.size() && _map.test( id_r ) ); }
+
+	bool insertId( detail::SolvableIdType id_r );
+
+	bool eraseId( detail::SolvableIdType id_r );
+
+      private:
+        Map _map;
+    };
+    ///////////////////////////////////////////////////////////////////
+
+    /** \relates SolvableMap Stream output */
+    std::ostream & operator<<( std::ostream & str, const SolvableMap & obj );
+
+    /** \relates SolvableMap */
+    inline bool operator==( const SolvableMap & lhs, const SolvableMap & rhs )
+    {
+      // Maps may differ in size but still hold the same bits.
+      SolvableMap::const_iterator l( lhs.begin() );
+      SolvableMap::const_iterator r( rhs.begin() );
+      for ( ; l != lhs.end() && r != rhs.end(); ++l, ++r )
+      {
+	if ( *l != *r )
+	  return false;
+      }
+      return( l == lhs.end() && r == rhs.end() );
+    }
+
+    /** \relates SolvableMap */
+    inline bool operator!=( const SolvableMap & lhs, const SolvableMap & rhs )
+    { return !( lhs == rhs ); }
+
+    /////////////////////////////////////////////////////////////////
+  } // namespace sat
+  ///////////////////////////////////////////////////////////////////
+  /////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
+#endif // ZYPP_SAT_SOLVABLEMAP_H
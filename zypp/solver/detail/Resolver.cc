@@ -174,6 +174,9 @@ void Resolver::doUpdate()
 PoolItemList Resolver::problematicUpdateItems() const
 { return _satResolver->problematicUpdateItems(); }
 
+const SolverStatistics & Resolver::statistics() const
+{ return _satResolver->statistics(); }
+
 void Resolver::addExtraRequire( const Capability & capability )
 { _extra_requires.insert (capability); }
 
@@ -165,6 +165,7 @@ class Resolver : private base::NonCopyable
 
     bool doUpgrade();
     PoolItemList problematicUpdateItems() const;
+    const SolverStatistics & statistics() const;
 
     /** \name Solver flags */
     //@{
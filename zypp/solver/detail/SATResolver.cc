@@ -28,6 +28,9 @@ extern "C"
 #include <solv/bitmap.h>
 #include <solv/queue.h>
 }
+#include <chrono>
+#include <unordered_map>
+#include <unordered_set>
 
 #define ZYPP_USE_RESOLVER_INTERNALS
 
@@ -245,6 +248,14 @@ SATSolutionToPool (PoolItem item, const ResStatus & status, const ResStatus::Tra
     return;
 }
 
+std::ostream & operator<<( std::ostream & str, const SolverStatistics & obj )
+{
+  return str << "SolverStatistics(solve " << obj.solveMs << "ms, apply " << obj.applyMs << "ms"
+             << ", install " << obj.toInstall << ", remove " << obj.toRemove
+             << " (" << obj.updated << " updated, " << obj.obsoleted << " obsoleted)"
+             << ", problems " << obj.problems << ")";
+}
+
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
 // resolvePool
@@ -324,31 +335,47 @@ private:
 //----------------------------------------------------------------------------
 
 
-class CheckIfUpdate : public resfilter::PoolItemFilterFunctor
+/////////////////////////////////////////////////////////////////////////
+/// \class CheckIfUpdate
+/// \brief Whether an installed item to be removed is updated by an item to be installed.
+///
+/// It is, if an item with the same ident is to be installed (a multiversion
+/// item just updates the same NVRA). The items to be installed are indexed by
+/// ident once, instead of scanning byIdent for each removed item.
+/////////////////////////////////////////////////////////////////////////
+class CheckIfUpdate
 {
   public:
-    bool is_updated;
-    sat::Solvable _installed;
-
-    CheckIfUpdate( const sat::Solvable & installed_r )
-    : is_updated( false )
-    , _installed( installed_r )
-    {}
-
-    // check this item will be updated
+    CheckIfUpdate( const PoolItemList & items_to_install_r )
+    {
+      for ( const PoolItem & item : items_to_install_r )
+      {
+	if ( ! item.status().isToBeInstalled() )
+	  continue;
+	if ( item.multiversionInstall() )
+	  _multiversion.insert( std::make_pair( item.ident().id(), item.satSolvable() ) );
+	else
+	  _idents.insert( item.ident().id() );
+      }
+    }
 
-    bool operator()( const PoolItem & item )
+    bool operator()( const sat::Solvable & installed_r ) const
     {
-	if ( item.status().isToBeInstalled() )
-        {
-          if ( ! item.multiversionInstall() || sameNVRA( _installed, item ) )
-          {
-            is_updated = true;
-            return false;
-          }
-	}
+      sat::detail::IdType ident( installed_r.ident().id() );
+      if ( _idents.count( ident ) )
 	return true;
+      auto range( _multiversion.equal_range( ident ) );
+      for_( it, range.first, range.second )
+      {
+	if ( sameNVRA( installed_r, it->second ) )
+	  return true;
+      }
+      return false;
     }
+
+  private:
+    std::unordered_set<sat::detail::IdType> _idents;
+    std::unordered_multimap<sat::detail::IdType,sat::Solvable> _multiversion;
 };
 
 
@@ -415,9 +442,14 @@ SATResolver::solving(const CapabilitySet & requires_caps,
     sat::Pool::instance().prepare();
 
     // Solve !
+    typedef std::chrono::steady_clock Clock;
+    _statistics = SolverStatistics();
     MIL << "Starting solving...." << endl;
     MIL << *this;
+    Clock::time_point start( Clock::now() );
     solver_solve( _satSolver, &(_jobQueue) );
+    Clock::time_point solved( Clock::now() );
+    _statistics.solveMs = std::chrono::duration_cast<std::chrono::milliseconds>( solved - start ).count();
     MIL << "....Solver end" << endl;
 
     // copying solution back to zypp pool
@@ -446,21 +478,16 @@ SATResolver::solving(const CapabilitySet & requires_caps,
     if ( systemRepo && ! systemRepo.solvablesEmpty() )
     {
       bool mustCheckObsoletes = false;
+      CheckIfUpdate isUpdated( _result_items_to_install );
       for_( it, systemRepo.solvablesBegin(), systemRepo.solvablesEnd() )
       {
 	if (solver_get_decisionlevel(_satSolver, it->id()) > 0)
 	  continue;
 
-	// Check if this is an update
-	CheckIfUpdate info( *it );
 	PoolItem poolItem( *it );
-	invokeOnEach( _pool.byIdentBegin( poolItem ),
-		      _pool.byIdentEnd( poolItem ),
-		      resfilter::ByUninstalled(),			// ByUninstalled
-		      functor::functorRef<bool,PoolItem> (info) );
-
-	if (info.is_updated) {
+	if ( isUpdated( *it ) ) {
 	  SATSolutionToPool( poolItem, ResStatus::toBeUninstalledDueToUpgrade, ResStatus::SOLVER );
+	  ++_statistics.updated;
 	} else {
 	  SATSolutionToPool( poolItem, ResStatus::toBeUninstalled, ResStatus::SOLVER );
 	  if ( ! mustCheckObsoletes )
@@ -476,7 +503,10 @@ SATResolver::solving(const CapabilitySet & requires_caps,
 	  ResStatus & status( it->status() );
 	  // WhatObsoletes contains installed items only!
 	  if ( status.transacts() && ! status.isToBeUninstalledDueToUpgrade() )
+	  {
 	    status.setToBeUninstalledDueToObsolete();
+	    ++_statistics.obsoleted;
+	  }
 	}
       }
     }
@@ -581,6 +611,12 @@ SATResolver::solving(const CapabilitySet & requires_caps,
 	}
     }
 
+    _statistics.toInstall = _result_items_to_install.size();
+    _statistics.toRemove = _result_items_to_remove.size();
+    _statistics.problems = solver_problem_count(_satSolver);
+    _statistics.applyMs = std::chrono::duration_cast<std::chrono::milliseconds>( Clock::now() - solved ).count();
+    MIL << _statistics << endl;
+
     if (solver_problem_count(_satSolver) > 0 )
     {
 	ERR << "Solverrun finished with an ERROR" << endl;
@@ -850,6 +886,7 @@ void SATResolver::doUpdate()
     //-----------------------------------------
 
     /*  solvables to be installed */
+    PoolItemList items_to_install;
     Queue decisionq;
     queue_init(&decisionq);
     solver_get_decisionqueue(_satSolver, &decisionq);
@@ -865,6 +902,7 @@ void SATResolver::doUpdate()
       PoolItem poolItem = _pool.find (sat::Solvable(p));
       if (poolItem) {
 	  SATSolutionToPool (poolItem, ResStatus::toBeInstalled, ResStatus::SOLVER);
+	  items_to_install.push_back( poolItem );
       } else {
 	  ERR << "id " << p << " not found in ZYPP pool." << endl;
       }
@@ -872,6 +910,7 @@ void SATResolver::doUpdate()
     queue_free(&decisionq);
 
     /* solvables to be erased */
+    CheckIfUpdate isUpdated( items_to_install );
     for (int i = _satSolver->pool->installed->start; i < _satSolver->pool->installed->start + _satSolver->pool->installed->nsolvables; i++)
     {
       if (solver_get_decisionlevel(_satSolver, i) > 0)
@@ -880,13 +919,7 @@ void SATResolver::doUpdate()
       PoolItem poolItem( _pool.find( sat::Solvable(i) ) );
       if (poolItem) {
 	  // Check if this is an update
-	  CheckIfUpdate info( (sat::Solvable(i)) );
-	  invokeOnEach( _pool.byIdentBegin( poolItem ),
-			_pool.byIdentEnd( poolItem ),
-			resfilter::ByUninstalled(),			// ByUninstalled
-			functor::functorRef<bool,PoolItem> (info) );
-
-	  if (info.is_updated) {
+	  if ( isUpdated( sat::Solvable(i) ) ) {
 	      SATSolutionToPool (poolItem, ResStatus::toBeUninstalledDueToUpgrade , ResStatus::SOLVER);
 	  } else {
 	      SATSolutionToPool (poolItem, ResStatus::toBeUninstalled, ResStatus::SOLVER);
@@ -93,6 +93,7 @@ class SATResolver : public base::ReferenceCounted, private base::NonCopyable, pr
     // solve results
     PoolItemList _result_items_to_install;
     PoolItemList _result_items_to_remove;
+    SolverStatistics _statistics;
   public:
     bool _fixsystem:1;			// repair errors in rpm dependency graph
     bool _allowdowngrade:1;		// allow to downgrade installed solvable
@@ -217,6 +218,8 @@ class SATResolver : public base::ReferenceCounted, private base::NonCopyable, pr
     PoolItemList resultItemsToInstall () { return _result_items_to_install; }
     PoolItemList resultItemsToRemove () { return _result_items_to_remove; }
 
+    const SolverStatistics & statistics() const { return _statistics; }
+
     sat::StringQueue autoInstalled() const;
     sat::StringQueue userInstalled() const;
 };
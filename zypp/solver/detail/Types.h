@@ -21,6 +21,7 @@
 #ifndef ZYPP_SOLVER_DETAIL_TYPES_H
 #define ZYPP_SOLVER_DETAIL_TYPES_H
 
+#include <iosfwd>
 #include <list>
 #include "zypp/base/PtrTypes.h"
 
@@ -47,6 +48,26 @@ namespace zypp
       DEFINE_PTR_TYPE(SolutionAction);
       typedef std::list<SolutionAction_Ptr> SolutionActionList;
 
+      /** Timing and result counts of the last solver run.
+       * \see \ref Resolver::statistics
+       */
+      struct SolverStatistics
+      {
+        SolverStatistics()
+        : solveMs( 0 ), applyMs( 0 ), toInstall( 0 ), toRemove( 0 ), updated( 0 ), obsoleted( 0 ), problems( 0 )
+        {}
+        unsigned long solveMs;	///< time spent in the libsolv solver
+        unsigned long applyMs;	///< time spent writing the result back to the pool
+        unsigned toInstall;	///< items to be installed
+        unsigned toRemove;	///< items to be removed
+        unsigned updated;	///< removed items being updated
+        unsigned obsoleted;	///< removed items being obsoleted
+        unsigned problems;	///< problems reported by the solver
+      };
+
+      /** \relates SolverStatistics Stream output */
+      std::ostream & operator<<( std::ostream & str, const SolverStatistics & obj );
+
     } // namespace detail
     /////////////////////////////////////////////////////////////////////
   } // namespace solver
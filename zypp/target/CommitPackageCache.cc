@@ -22,7 +22,13 @@ using std::endl;
 #include "zypp/target/rpm/librpmDb.h"
 #include "zypp/repo/PackageProvider.h"
 #include "zypp/repo/DeltaCandidates.h"
+#include "zypp/repo/Applydeltarpm.h"
+#include "zypp/repo/PackageDelta.h"
+#include "zypp/PathInfo.h"
 #include "zypp/ResPool.h"
+#include "zypp/ZConfig.h"
+#include "zypp/Package.h"
+#include "zypp/SrcPackage.h"
 
 ///////////////////////////////////////////////////////////////////
 namespace zypp
@@ -102,6 +108,80 @@ namespace zypp
       return ret;
     }
 
+    void RepoProvidePackage::prefetch( const std::vector<PoolItem> & items_r )
+    {
+      // Collect the packages we'd actually download, grouped by repo.
+      // For packages PackageProvider will build from a delta rpm, it's the delta rpm.
+      std::map<Repository, std::list<OnMediaLocation> > todo;
+      std::vector<std::pair<PoolItem, packagedelta::DeltaRpm> > deltas;
+      for ( const PoolItem & pi : items_r )
+      {
+	if ( ! ( pi.isKind<Package>() || pi.isKind<SrcPackage>() ) )
+	  continue;
+
+	const RepoInfo & info( pi.repoInfo() );
+	if ( info.baseUrlsEmpty() || ! info.baseUrlsBegin()->schemeIsDownloading() )
+	  continue;	// local media are not prefetched
+
+	repo::PackageProvider pkgProvider( _impl->_access, pi, _impl->_packageProviderPolicy );
+	if ( pkgProvider.isCached() )
+	  continue;
+
+	if ( pi.isKind<Package>()
+	  && ZConfig::instance().download_use_deltarpm()
+	  && applydeltarpm::haveApplydeltarpm()
+	  && _impl->_packageProviderPolicy.queryInstalled( pi.name(), Edition(), pi.arch() ) )
+	{
+	  std::list<packagedelta::DeltaRpm> deltaRpms( repo::DeltaCandidates( _impl->_repos, pi.name() ).deltaRpms( pi->asKind<Package>() ) );
+	  if ( ! deltaRpms.empty() )
+	  {
+	    // the one PackageProvider would try first
+	    for ( const packagedelta::DeltaRpm & delta : deltaRpms )
+	    {
+	      const Edition & baseEdition( delta.baseversion().edition() );
+	      if ( ( baseEdition == Edition::noedition
+		     || _impl->_packageProviderPolicy.queryInstalled( pi.name(), baseEdition, pi.arch() ) )
+		&& applydeltarpm::quickcheck( delta.baseversion().sequenceinfo() ) )
+	      {
+		todo[delta.repository()].push_back( delta.location() );
+		deltas.push_back( std::make_pair( pi, delta ) );
+		break;
+	      }
+	    }
+	    continue;	// PackageProvider will try to build it from a delta rpm
+	  }
+	}
+
+	todo[pi.repository()].push_back( pi.lookupLocation() );
+      }
+
+      for ( const auto & el : todo )
+      {
+	DBG << "prefetch " << el.second.size() << " packages from " << el.first << endl;
+	_impl->_access.prefetchFiles( el.first.info(), el.second );
+      }
+
+      // Build the packages from the (now local) delta rpms in the background,
+      // PackageProvider collects them.
+      for ( const auto & el : deltas )
+      {
+	const packagedelta::DeltaRpm & delta( el.second );
+	OnMediaLocation loc( el.first.lookupLocation() );
+	Pathname destination( el.first.repoInfo().packagesPath() / loc.filename() );
+	try
+	{
+	  ManagedFile deltafile( _impl->_access.provideFile( delta.repository().info(), delta.location() ) );
+	  filesystem::assert_dir( destination.dirname() );
+	  applydeltarpm::provideAsync( deltafile, destination, loc.checksum(), delta.baseversion().sequenceinfo() );
+	}
+	catch ( const Exception & excpt )
+	{
+	  ZYPP_CAUGHT( excpt );
+	  WAR << "Not building " << destination << " in advance" << endl;	// PackageProvider will try again
+	}
+      }
+    }
+
     ///////////////////////////////////////////////////////////////////
     //
     //	CLASS NAME : CommitPackageCache
@@ -114,7 +194,18 @@ namespace zypp
       assert( _pimpl );
     }
 
-    CommitPackageCache::CommitPackageCache( const PackageProvider & packageProvider_r )
+    CommitPackageCache::CommitPackageCache()
+    {
+      RepoProvidePackage repoProvidePackage;
+      init( repoProvidePackage, bind( &RepoProvidePackage::prefetch, repoProvidePackage, _1 ) );
+    }
+
+    CommitPackageCache::CommitPackageCache( const PackageProvider & packageProvider_r,
+                                            const PackagePrefetcher & packagePrefetcher_r )
+    { init( packageProvider_r, packagePrefetcher_r ); }
+
+    void CommitPackageCache::init( const PackageProvider & packageProvider_r,
+                                   const PackagePrefetcher & packagePrefetcher_r )
     {
       if ( getenv("ZYPP_COMMIT_NO_PACKAGE_CACHE") )
         {
@@ -126,6 +217,7 @@ namespace zypp
           _pimpl.reset( new CommitPackageCacheReadAhead( packageProvider_r ) );
         }
       assert( _pimpl );
+      _pimpl->setPackagePrefetcher( packagePrefetcher_r );
     }
 
     CommitPackageCache::CommitPackageCache( const Pathname &        /*rootDir_r*/,
@@ -139,6 +231,9 @@ namespace zypp
     void CommitPackageCache::setCommitList( std::vector<sat::Solvable> commitList_r )
     { _pimpl->setCommitList( commitList_r ); }
 
+    void CommitPackageCache::prefetch( const std::vector<PoolItem> & items_r )
+    { _pimpl->prefetch( items_r ); }
+
     ManagedFile CommitPackageCache::get( const PoolItem & citem_r )
     { return _pimpl->get( citem_r ); }
 
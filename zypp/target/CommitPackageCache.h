@@ -13,6 +13,7 @@
 #define ZYPP_TARGET_COMMITPACKAGECACHE_H
 
 #include <iosfwd>
+#include <vector>
 
 #include "zypp/base/PtrTypes.h"
 #include "zypp/base/Function.h"
@@ -44,6 +45,12 @@ namespace zypp
       /** Provide package optionally fron cache only. */
       ManagedFile operator()( const PoolItem & pi, bool fromCache_r );
 
+      /** Prefetch the packages which will actually be downloaded
+       * (not cached, no delta rpm available) concurrently from their
+       * repositories media. Errors are not propagated.
+       */
+      void prefetch( const std::vector<PoolItem> & items_r );
+
     private:
       struct Impl;
       RW_pointer<Impl> _impl;
@@ -61,10 +68,15 @@ namespace zypp
 
     public:
       typedef function<ManagedFile( const PoolItem & pi, bool fromCache_r )> PackageProvider;
+      typedef function<void( const std::vector<PoolItem> & items_r )> PackagePrefetcher;
 
     public:
+      /** Default ctor using \ref RepoProvidePackage (incl. prefetch). */
+      CommitPackageCache();
+
       /** Ctor */
-      CommitPackageCache( const PackageProvider & packageProvider_r = RepoProvidePackage() );
+      CommitPackageCache( const PackageProvider & packageProvider_r,
+                          const PackagePrefetcher & packagePrefetcher_r = PackagePrefetcher() );
 
       /** \deprecated Legacy Ctor; Pathname rootDir_r is not used.
        * The repositories RepoInfo::packagesPath defines the cache location.
@@ -82,6 +94,15 @@ namespace zypp
       void setCommitList( TIterator begin_r, TIterator end_r )
       { setCommitList( std::vector<sat::Solvable>( begin_r, end_r  ) ); }
 
+      /** Hint that the packages in \a items_r are about to be retrieved via \ref get.
+       * If a \ref PackagePrefetcher is available the packages are downloaded
+       * concurrently in advance, while \ref get provides them. This is just a
+       * hint: all reports (including abort/skip/retry requests) are still
+       * triggered by \ref get, which reports the progress of a package still
+       * in transfer.
+       */
+      void prefetch( const std::vector<PoolItem> & items_r );
+
       /** Provide a package. */
       ManagedFile get( const PoolItem & citem_r );
       /** \overload */
@@ -102,6 +123,8 @@ namespace zypp
       /** Ctor taking an implementation. */
       explicit CommitPackageCache( Impl * pimpl_r );
     private:
+      /** Ctor helper choosing the implementation. */
+      void init( const PackageProvider & packageProvider_r, const PackagePrefetcher & packagePrefetcher_r );
       /** Pointer to implementation. */
       RW_pointer<Impl> _pimpl;
     };
@@ -40,6 +40,7 @@ namespace zypp
     {
     public:
       typedef CommitPackageCache::PackageProvider  PackageProvider;
+      typedef CommitPackageCache::PackagePrefetcher PackagePrefetcher;
 
     public:
       Impl( const PackageProvider & packageProvider_r )
@@ -58,6 +59,18 @@ namespace zypp
         return sourceProvidePackage( citem_r );
       }
 
+      /** Prefetch packages about to be retrieved.
+       * Derived classes may overload this.
+      */
+      virtual void prefetch( const std::vector<PoolItem> & items_r )
+      {
+        if ( _packagePrefetcher && ! items_r.empty() )
+          _packagePrefetcher( items_r );
+      }
+
+      void setPackagePrefetcher( const PackagePrefetcher & packagePrefetcher_r )
+      { _packagePrefetcher = packagePrefetcher_r; }
+
       void setCommitList( std::vector<sat::Solvable> commitList_r )
       { _commitList = commitList_r; }
 
@@ -102,6 +115,7 @@ namespace zypp
     private:
       std::vector<sat::Solvable> _commitList;
       PackageProvider _packageProvider;
+      PackagePrefetcher _packagePrefetcher;
       DefaultIntegral<bool,false> _preloaded;
     };
     ///////////////////////////////////////////////////////////////////
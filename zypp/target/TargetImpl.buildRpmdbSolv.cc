@@ -0,0 +1,107 @@
+/*---------------------------------------------------------------------\
+|                          ____ _   __ __ ___                          |
+|                         |__  / \ / / . \ . \                         |
+|                           / / \ V /|  _/  _/                         |
+|                          / /__ | | | | | |                           |
+|                         /_____||_| |_| |_|                           |
+|                                                                      |
+\---------------------------------------------------------------------*/
+/** \file zypp/target/TargetImpl.buildRpmdbSolv.cc
+ */
+extern "C"
+{
+#include <solv/solvversion.h>
+#include <solv/pool.h>
+#include <solv/repo.h>
+#include <solv/repo_solv.h>
+#include <solv/repo_rpmdb.h>
+#ifdef LIBSOLVEXT_FEATURE_SUSEREPO
+#include <solv/repo_products.h>
+#endif
+#ifdef LIBSOLVEXT_FEATURE_APPDATA
+#include <solv/repo_appdata.h>
+#endif
+}
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "zypp/base/LogTools.h"
+#include "zypp/base/String.h"
+#include "zypp/AutoDispose.h"
+#include "zypp/PathInfo.h"
+
+#include "zypp/sat/detail/PoolMember.h"
+#include "zypp/repo/Repo2Solv.h"
+
+#include "zypp/target/TargetImpl.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace zypp
+{
+  ///////////////////////////////////////////////////////////////////
+  namespace target
+  {
+    // Like 'rpmdb2solv -r <root> -X -A -p <root>/etc/products.d [oldSolv] -o newSolv',
+    // but within a private libsolv pool instead of a subprocess.
+    bool TargetImpl::buildRpmdbSolv( const Pathname & oldSolv_r, const Pathname & newSolv_r, std::string & errdetail_r ) const
+    {
+#ifdef LIBSOLVEXT_FEATURE_SUSEREPO
+      if ( ! repo::haveAutopattern() )
+        return false;	// libsolv lacks the autopattern support rpmdb2solv has.
+
+      AutoDispose<sat::detail::CPool*> pool( ::pool_create(), ::pool_free );
+      if ( ! _root.empty() )
+        ::pool_set_rootdir( pool, _root.c_str() );
+
+      sat::detail::CRepo * repo = ::repo_create( pool, "@System" );
+      ::Repodata * data = ::repo_add_repodata( repo, 0 );
+      static const int addflags = REPO_REUSE_REPODATA | REPO_NO_INTERNALIZE | REPO_USE_ROOTDIR;
+
+      // With the old solv file as reference libsolv reuses the data of all
+      // packages still in the rpmdb and reads only the headers added since,
+      // so the cost is proportional to what changed since the last build.
+      {
+        AutoDispose<FILE*> reffp( oldSolv_r.empty() ? nullptr : ::fopen( oldSolv_r.c_str(), "re" ) );
+        if ( *reffp )
+          reffp.setDispose( ::fclose );
+        else if ( ! oldSolv_r.empty() )
+          WAR << "Can't open reference solv file " << oldSolv_r << ": rebuilding from scratch" << endl;
+
+        if ( ::repo_add_rpmdb_reffp( repo, reffp, addflags ) != 0 )
+        {
+          errdetail_r = str::form( "repo_add_rpmdb: %s", ::pool_errstr( pool ) );
+          return false;
+        }
+      }
+
+      if ( ::repo_add_products( repo, "/etc/products.d", addflags ) != 0 )
+      {
+        errdetail_r = str::form( "repo_add_products: %s", ::pool_errstr( pool ) );
+        return false;
+      }
+#ifdef LIBSOLVEXT_FEATURE_APPDATA
+      // missing appdata is not an error
+      ::repo_add_appdata_dir( repo, "/usr/share/appdata", addflags | APPDATA_SEARCH_UNINTERNALIZED_FILELIST );
+#endif
+      ::repodata_internalize( data );
+      repo::addAutopattern( repo );
+
+      // newSolv_r is a temp. file the caller renames on success.
+      if ( ! repo::writeSolv( repo, newSolv_r, errdetail_r, /*sync*/true ) )
+        return false;
+
+      MIL << "Built " << newSolv_r << " (" << repo->nsolvables << " solvables)" << endl;
+      return true;
+#else
+      // libsolv lacks the products support rpmdb2solv has.
+      return false;
+#endif
+    }
+
+  } // namespace target
+  ///////////////////////////////////////////////////////////////////
+} // namespace zypp
+///////////////////////////////////////////////////////////////////
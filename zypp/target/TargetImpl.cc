@@ -907,44 +907,53 @@ namespace zypp
         // Take care we unlink the solvfile on exception
         ManagedFile guard( base, filesystem::recursive_rmdir );
 
-        ExternalProgram::Arguments cmd;
-        cmd.push_back( "rpmdb2solv" );
-        if ( ! _root.empty() ) {
-          cmd.push_back( "-r" );
-          cmd.push_back( _root.asString() );
-        }
-        cmd.push_back( "-X" );	// autogenerate pattern/product/... from -package
-        cmd.push_back( "-A" );	// autogenerate application pseudo packages
-        cmd.push_back( "-p" );
-        cmd.push_back( Pathname::assertprefix( _root, "/etc/products.d" ).asString() );
+	std::string errdetail;
+	if ( ! buildRpmdbSolv( oldSolvFile, tmpsolv.path(), errdetail ) )
+	{
+	  if ( ! errdetail.empty() )
+	  {
+	    WAR << "Building the solv file in-process failed, trying rpmdb2solv: " << errdetail << endl;
+	    errdetail.clear();
+	  }
+
+          ExternalProgram::Arguments cmd;
+          cmd.push_back( "rpmdb2solv" );
+          if ( ! _root.empty() ) {
+            cmd.push_back( "-r" );
+            cmd.push_back( _root.asString() );
+          }
+          cmd.push_back( "-X" );	// autogenerate pattern/product/... from -package
+          cmd.push_back( "-A" );	// autogenerate application pseudo packages
+          cmd.push_back( "-p" );
+          cmd.push_back( Pathname::assertprefix( _root, "/etc/products.d" ).asString() );
 
-        if ( ! oldSolvFile.empty() )
-          cmd.push_back( oldSolvFile.asString() );
+          if ( ! oldSolvFile.empty() )
+            cmd.push_back( oldSolvFile.asString() );
 
-        cmd.push_back( "-o" );
-        cmd.push_back( tmpsolv.path().asString() );
+          cmd.push_back( "-o" );
+          cmd.push_back( tmpsolv.path().asString() );
 
-        ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
-	std::string errdetail;
+          ExternalProgram prog( cmd, ExternalProgram::Stderr_To_Stdout );
 
-        for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
-          WAR << "  " << output;
-          if ( errdetail.empty() ) {
-            errdetail = prog.command();
-            errdetail += '\n';
+          for ( std::string output( prog.receiveLine() ); output.length(); output = prog.receiveLine() ) {
+            WAR << "  " << output;
+            if ( errdetail.empty() ) {
+              errdetail = prog.command();
+              errdetail += '\n';
+            }
+            errdetail += output;
           }
-          errdetail += output;
-        }
 
-        int ret = prog.close();
-        if ( ret != 0 )
-        {
-          Exception ex(str::form("Failed to cache rpm database (%d).", ret));
-          ex.remember( errdetail );
-          ZYPP_THROW(ex);
-        }
+          int ret = prog.close();
+          if ( ret != 0 )
+          {
+            Exception ex(str::form("Failed to cache rpm database (%d).", ret));
+            ex.remember( errdetail );
+            ZYPP_THROW(ex);
+          }
+	}
 
-        ret = filesystem::rename( tmpsolv, rpmsolv );
+        int ret = filesystem::rename( tmpsolv, rpmsolv );
         if ( ret != 0 )
           ZYPP_THROW(Exception("Failed to move cache to final destination"));
         // if this fails, don't bother throwing exceptions
@@ -1243,6 +1252,7 @@ namespace zypp
           // Preload the cache. Until now this means pre-loading all packages.
           // Once DownloadInHeaps is fully implemented, this will change and
           // we may actually have more than one heap.
+          std::vector<ZYppCommitResult::TransactionStepList::iterator> preloadSteps;
           for_( it, steps.begin(), steps.end() )
           {
 	    switch ( it->stepType() )
@@ -1258,42 +1268,58 @@ namespace zypp
 		break;
 	    }
 
+	    if ( it->satSolvable().isKind<Package>() || it->satSolvable().isKind<SrcPackage>() )
+	      preloadSteps.push_back( it );
+          }
+
+          // All packages are queued for prefetching. The media download them
+          // in a rolling window while the loop below provides them one by one.
+          // Waiting for a package still in transfer reports its progress like
+          // a download, so all reports are sent and abort/skip/retry requests
+          // are handled as before. A user abort cancels the running transfers.
+          {
+            std::vector<PoolItem> prefetch;
+            prefetch.reserve( preloadSteps.size() );
+            for ( const auto & it : preloadSteps )
+              prefetch.push_back( PoolItem( *it ) );
+            packageCache.prefetch( prefetch );
+          }
+
+          for ( ZYppCommitResult::TransactionStepList::iterator it : preloadSteps )
+          {
 	    PoolItem pi( *it );
-            if ( pi->isKind<Package>() || pi->isKind<SrcPackage>() )
-            {
-              ManagedFile localfile;
-              try
-              {
-		localfile = packageCache.get( pi );
-                localfile.resetDispose(); // keep the package file in the cache
-              }
-              catch ( const AbortRequestException & exp )
-              {
-		it->stepStage( sat::Transaction::STEP_ERROR );
-                miss = true;
-                WAR << "commit cache preload aborted by the user" << endl;
-                ZYPP_THROW( TargetAbortedException( N_("Installation has been aborted as directed.") ) );
-                break;
-              }
-              catch ( const SkipRequestException & exp )
-              {
-                ZYPP_CAUGHT( exp );
-		it->stepStage( sat::Transaction::STEP_ERROR );
-                miss = true;
-                WAR << "Skipping cache preload package " << pi->asKind<Package>() << " in commit" << endl;
-                continue;
-              }
-              catch ( const Exception & exp )
-              {
-                // bnc #395704: missing catch causes abort.
-                // TODO see if packageCache fails to handle errors correctly.
-                ZYPP_CAUGHT( exp );
-		it->stepStage( sat::Transaction::STEP_ERROR );
-                miss = true;
-                INT << "Unexpected Error: Skipping cache preload package " << pi->asKind<Package>() << " in commit" << endl;
-                continue;
-              }
-            }
+	    ManagedFile localfile;
+	    try
+	    {
+	      localfile = packageCache.get( pi );
+	      localfile.resetDispose(); // keep the package file in the cache
+	    }
+	    catch ( const AbortRequestException & exp )
+	    {
+	      it->stepStage( sat::Transaction::STEP_ERROR );
+	      miss = true;
+	      WAR << "commit cache preload aborted by the user" << endl;
+	      ZYPP_THROW( TargetAbortedException( N_("Installation has been aborted as directed.") ) );
+	      break;
+	    }
+	    catch ( const SkipRequestException & exp )
+	    {
+	      ZYPP_CAUGHT( exp );
+	      it->stepStage( sat::Transaction::STEP_ERROR );
+	      miss = true;
+	      WAR << "Skipping cache preload package " << pi->asKind<Package>() << " in commit" << endl;
+	      continue;
+	    }
+	    catch ( const Exception & exp )
+	    {
+	      // bnc #395704: missing catch causes abort.
+	      // TODO see if packageCache fails to handle errors correctly.
+	      ZYPP_CAUGHT( exp );
+	      it->stepStage( sat::Transaction::STEP_ERROR );
+	      miss = true;
+	      INT << "Unexpected Error: Skipping cache preload package " << pi->asKind<Package>() << " in commit" << endl;
+	      continue;
+	    }
           }
           packageCache.preloaded( true ); // try to avoid duplicate infoInCache CBs in commit
         }
@@ -1599,6 +1625,9 @@ namespace zypp
 
       } // for
 
+      // close the rpmdb if it was kept open by the in-process rpm backend
+      rpm().releaseLibrpmTransaction();
+
       // process all remembered posttrans scripts.
       if ( !abort )
 	postTransCollector.executeScripts();
@@ -208,6 +208,13 @@ namespace zypp
 
       /** Commit helper checking for file conflicts after download. */
       void commitFindFileConflicts( const ZYppCommitPolicy & policy_r, ZYppCommitResult & result_r );
+
+      /** \ref buildCache helper writing the rpmdb content to \a newSolv_r using libsolv.
+       * \a oldSolv_r, if not empty, is used as reference, so only changed rpmdb headers
+       * need to be read. Returns \c false (and maybe some \a errdetail_r) if the solv
+       * file could not be built this way; the caller falls back to \c rpmdb2solv then.
+       */
+      bool buildRpmdbSolv( const Pathname & oldSolv_r, const Pathname & newSolv_r, std::string & errdetail_r ) const;
     protected:
       /** Path to the target */
       Pathname _root;
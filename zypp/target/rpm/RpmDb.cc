@@ -32,6 +32,8 @@ extern "C"
 #include "zypp/base/Logger.h"
 #include "zypp/base/String.h"
 #include "zypp/base/Gettext.h"
+#include "zypp/base/Function.h"
+#include "zypp/base/NonCopyable.h"
 
 #include "zypp/Date.h"
 #include "zypp/Pathname.h"
@@ -738,6 +740,7 @@ void RpmDb::closeDatabase()
   ///////////////////////////////////////////////////////////////////
   // Block further database access
   ///////////////////////////////////////////////////////////////////
+  releaseLibrpmTransaction();
   librpmDb::blockAccess();
 
   ///////////////////////////////////////////////////////////////////
@@ -1446,8 +1449,9 @@ namespace
 {
   struct RpmlogCapture : public std::string
   {
-    RpmlogCapture()
-    { rpmlog()._cap = this; }
+    /** Remember the last message, or collect all messages if \a append_r. */
+    RpmlogCapture( bool append_r = false )
+    { rpmlog()._cap = this; rpmlog()._append = append_r; }
 
     ~RpmlogCapture()
     { rpmlog()._cap = nullptr; }
@@ -1457,6 +1461,7 @@ namespace
     {
       Rpmlog()
       : _cap( nullptr )
+      , _append( false )
       {
 	rpmlogSetCallback( rpmLogCB, this );
 	rpmSetVerbosity( RPMLOG_INFO );
@@ -1472,12 +1477,22 @@ namespace
 
       int rpmLog( rpmlogRec rec_r )
       {
-	if ( _cap ) (*_cap) = rpmlogRecMessage( rec_r );
+	if ( _cap )
+	{
+	  if ( _append )
+	  {
+	    (*_cap) += rpmlogLevelPrefix( rpmlogRecPriority( rec_r ) );
+	    (*_cap) += rpmlogRecMessage( rec_r );
+	  }
+	  else
+	    (*_cap) = rpmlogRecMessage( rec_r );
+	}
 	return RPMLOG_DEFAULT;
       }
 
       FILE * _f;
       std::string * _cap;
+      bool _append;
     };
 
     static Rpmlog & rpmlog()
@@ -1679,6 +1694,7 @@ RpmDb::run_rpm (const RpmArgVec& opts,
 
   // Invalidate all outstanding database handles in case
   // the database gets modified.
+  releaseLibrpmTransaction();
   librpmDb::dbRelease( true );
 
   // Launch the program with default locale
@@ -1884,6 +1900,366 @@ void RpmDb::processConfigFiles(const std::string& line, const std::string& name,
   }
 }
 
+namespace
+{
+  /** Whether to install/remove packages via librpm rather than \c /bin/rpm (\c ZYPP_RPM_INPROCESS=1). */
+  inline bool useLibrpmTs()
+  {
+#ifdef _RPM_4_X
+    static bool _val = [](){
+      const char * envp = getenv( "ZYPP_RPM_INPROCESS" );
+      bool ret = ( envp && str::strToTrue( envp ) );
+      if ( ret )
+	MIL << "ZYPP_RPM_INPROCESS: install/remove packages via librpm" << endl;
+      return ret;
+    }();
+    return _val;
+#else
+    return false;
+#endif
+  }
+} // namespace
+
+#ifdef _RPM_4_X
+namespace
+{
+  /** Define an rpm macro for the lifetime of this object.
+   * \c delMacro pops our definition, so any previous value of the
+   * macro (e.g. the \c _dbpath set by \ref librpmDb) is restored.
+   */
+  struct ScopedRpmMacro : private base::NonCopyable
+  {
+    ScopedRpmMacro( const char * name_r, const std::string & value_r )
+    : _name( name_r )
+    { ::addMacro( NULL, _name, NULL, value_r.c_str(), RMIL_CMDLINE ); }
+
+    ~ScopedRpmMacro()
+    { ::delMacro( NULL, _name ); }
+
+  private:
+    const char * _name;
+  };
+} // namespace
+
+///////////////////////////////////////////////////////////////////
+//
+//	CLASS NAME : RpmDb::LibrpmTs
+//
+/**
+ * In-process librpm transaction set replacing the per package
+ * \c /bin/rpm call in \ref RpmDb::doInstallPackage and
+ * \ref RpmDb::doRemovePackage.
+ *
+ * The \c rpmts and the rpmdb it holds stay open across packages until
+ * \ref RpmDb::releaseLibrpmTransaction, so we save the process spawn
+ * and the rpmdb open/lock/close per package. Each package is still
+ * processed in a transaction of its own, in order to keep the per
+ * package reports, history and problem handling.
+ */
+class RpmDb::LibrpmTs : private base::NonCopyable
+{
+public:
+  typedef function<void(unsigned)> ProgressCB;
+
+public:
+  LibrpmTs( const Pathname & root_r, const Pathname & dbPath_r )
+  : _root( root_r )
+  , _dbPath( dbPath_r )
+  , _ts( nullptr )
+  {
+    // Invalidate all outstanding database handles, as we are
+    // going to modify the database.
+    librpmDb::dbRelease( true );
+
+    // The dbpath is evaluated when the rpmdb is opened; it must
+    // not leak into other users of the global macro context.
+    int res = 0;
+    {
+      ScopedRpmMacro dbpath( "_dbpath", _dbPath.asString() );
+      _ts = ::rpmtsCreate();
+      ::rpmtsSetRootDir( _ts, _root.c_str() );
+      res = ::rpmtsOpenDB( _ts, O_RDWR );
+    }
+    if ( res )
+    {
+      ERR << "rpmdbOpen error(" << res << "): " << _root << "|" << _dbPath << endl;
+      _ts = ::rpmtsFree( _ts );
+      ZYPP_THROW( RpmDbOpenException( _root, _dbPath ) );
+    }
+    MIL << "librpm transaction set opened: " << _root << "|" << _dbPath << endl;
+  }
+
+  ~LibrpmTs()
+  {
+    if ( _ts )
+    {
+      ::rpmtsFree( _ts );
+      MIL << "librpm transaction set closed: " << _root << "|" << _dbPath << endl;
+    }
+  }
+
+  /** Install (or upgrade) \a filename_r.
+   * \return The transactions status (\c 0 on success). Any rpm output
+   * is appended to \a rpmmsg_r.
+   */
+  int install( const Pathname & filename_r, RpmInstFlags flags_r, const ProgressCB & progress_r, std::string & rpmmsg_r )
+  {
+    RpmlogCapture rpmlog( true );
+    std::string problems;
+    int res = 1;
+
+    unsigned vsflags = RPMVSF_DEFAULT;
+    if ( flags_r & RPMINST_NODIGEST )
+      vsflags |= _RPMVSF_NODIGESTS;
+    if ( flags_r & RPMINST_NOSIGNATURE )
+      vsflags |= _RPMVSF_NOSIGNATURES;
+    ::rpmtsSetVSFlags( _ts, rpmVSFlags(vsflags) );
+
+    Header h = 0;
+    FD_t fd = ::Fopen( filename_r.c_str(), "r.ufdio" );
+    if ( fd == 0 || ::Ferror( fd ) )
+    {
+      problems += str::form( "%s: %s\n", filename_r.c_str(), ::Fstrerror( fd ) );
+    }
+    else
+    {
+      rpmRC rc = ::rpmReadPackageFile( _ts, fd, filename_r.c_str(), &h );
+      if ( ( rc == RPMRC_NOTFOUND || rc == RPMRC_FAIL ) && h )
+	h = ::headerFree( h );
+    }
+    if ( fd )
+      ::Fclose( fd );
+
+    if ( h )
+    {
+      // the key is handed back in RPMCALLBACK_INST_OPEN_FILE
+      res = ::rpmtsAddInstallElement( _ts, h, (fnpyKey)filename_r.c_str(), ( flags_r & RPMINST_NOUPGRADE ) ? 0 : 1, NULL );
+      ::headerFree( h );
+      if ( res )
+	problems += str::form( "%s: %s\n", filename_r.c_str(), "can not add package to transaction" );
+      else
+	res = run( flags_r, progress_r, problems );
+    }
+    else if ( problems.empty() )
+    {
+      problems += str::form( "%s: %s\n", filename_r.c_str(), "not an rpm package (or package manifest)" );
+    }
+
+    ::rpmtsEmpty( _ts );
+    rpmmsg_r += rpmlog;
+    rpmmsg_r += problems;
+    return res;
+  }
+
+  /** Remove all packages matching \a name_r (like 'rpm -e --allmatches').
+   * \return The transactions status (\c 0 on success). Any rpm output
+   * is appended to \a rpmmsg_r.
+   */
+  int remove( const std::string & name_r, RpmInstFlags flags_r, const ProgressCB & progress_r, std::string & rpmmsg_r )
+  {
+    RpmlogCapture rpmlog( true );
+    std::string problems;
+    int res = 1;
+
+    unsigned count = 0;
+    rpmdbMatchIterator mi = ::rpmtsInitIterator( _ts, RPMDBI_LABEL, name_r.c_str(), 0 );
+    while ( Header h = ::rpmdbNextIterator( mi ) )
+    {
+      if ( ::rpmtsAddEraseElement( _ts, h, ::rpmdbGetIteratorOffset( mi ) ) == 0 )
+	++count;
+    }
+    ::rpmdbFreeIterator( mi );
+
+    if ( count )
+      res = run( flags_r, progress_r, problems );
+    else
+      problems += str::form( "package %s is not installed\n", name_r.c_str() );
+
+    ::rpmtsEmpty( _ts );
+    rpmmsg_r += rpmlog;
+    rpmmsg_r += problems;
+    return res;
+  }
+
+private:
+  /** Check, order and run the prepared transaction. */
+  int run( RpmInstFlags flags_r, const ProgressCB & progress_r, std::string & problems_r )
+  {
+    unsigned transflags = RPMTRANS_FLAG_NONE;
+    if ( flags_r & RPMINST_EXCLUDEDOCS )
+      transflags |= RPMTRANS_FLAG_NODOCS;
+    if ( flags_r & RPMINST_NOSCRIPTS )
+      transflags |= RPMTRANS_FLAG_NOSCRIPTS;
+    if ( flags_r & RPMINST_JUSTDB )
+      transflags |= RPMTRANS_FLAG_JUSTDB;
+    if ( flags_r & RPMINST_TEST )
+      transflags |= RPMTRANS_FLAG_TEST;
+    if ( flags_r & RPMINST_NOPOSTTRANS )
+      transflags |= RPMTRANS_FLAG_NOPOSTTRANS;
+    ::rpmtsSetFlags( _ts, rpmtransFlags(transflags) );
+
+    unsigned probfilter = RPMPROB_FILTER_NONE;
+    if ( flags_r & RPMINST_FORCE )
+      probfilter |= ( RPMPROB_FILTER_REPLACEPKG | RPMPROB_FILTER_REPLACEOLDFILES | RPMPROB_FILTER_REPLACENEWFILES | RPMPROB_FILTER_OLDPACKAGE );
+    if ( flags_r & RPMINST_IGNORESIZE )
+      probfilter |= ( RPMPROB_FILTER_DISKSPACE | RPMPROB_FILTER_DISKNODES );
+    // ZConfig defines cross-arch installation
+    if ( ! ZConfig::instance().systemArchitecture().compatibleWith( ZConfig::instance().defaultSystemArchitecture() ) )
+      probfilter |= RPMPROB_FILTER_IGNOREARCH;
+
+    if ( ! ( flags_r & RPMINST_NODEPS ) )
+    {
+      if ( ::rpmtsCheck( _ts ) || collectProblems( problems_r ) )
+	return 1;
+    }
+    ::rpmtsOrder( _ts );
+
+    // Script output would otherwise end up on our stdout.
+    filesystem::TmpFile scriptOut;
+    FD_t scriptFd = ::Fopen( scriptOut.path().c_str(), "w.ufdio" );
+    if ( scriptFd && ::Ferror( scriptFd ) )
+    {
+      ::Fclose( scriptFd );
+      scriptFd = 0;
+    }
+    ::rpmtsSetScriptFd( _ts, scriptFd );
+
+    Notify notify( progress_r );
+    ::rpmtsSetNotifyCallback( _ts, notifyCB, &notify );
+    int res = ::rpmtsRun( _ts, NULL, rpmprobFilterFlags(probfilter) );
+    ::rpmtsSetNotifyCallback( _ts, NULL, NULL );
+
+    ::rpmtsSetScriptFd( _ts, NULL );
+    if ( scriptFd )
+    {
+      ::Fclose( scriptFd );
+      readScriptOutput( scriptOut.path(), problems_r );
+    }
+
+    if ( res > 0 )
+      collectProblems( problems_r );
+    else if ( res < 0 )
+      problems_r += "rpm transaction failed\n";
+    else if ( ! ( flags_r & RPMINST_TEST ) )
+      notify.progress( 100 );
+    return res;
+  }
+
+  /** Append the ts problems to \a problems_r. \return Whether there were problems. */
+  bool collectProblems( std::string & problems_r )
+  {
+    rpmps ps = ::rpmtsProblems( _ts );
+    bool ret = ( ::rpmpsNumProblems( ps ) > 0 );
+    if ( ret )
+    {
+      char * buf = nullptr;
+      size_t size = 0;
+      FILE * f = ::open_memstream( &buf, &size );
+      if ( f )
+      {
+	::rpmpsPrint( f, ps );
+	::fclose( f );
+	problems_r += buf;
+	::free( buf );
+      }
+    }
+    ::rpmpsFree( ps );
+    return ret;
+  }
+
+  /** Append the scripts output to \a msg_r. */
+  static void readScriptOutput( const Pathname & file_r, std::string & msg_r )
+  {
+    std::ifstream in( file_r.c_str() );
+    std::string line;
+    unsigned linecnt = 0;
+    while ( std::getline( in, line ) )
+    {
+      if ( ++linecnt > MAXRPMMESSAGELINES )
+      {
+	msg_r += "[truncated]\n";
+	break;
+      }
+      msg_r += line+'\n';
+    }
+  }
+
+private:
+  /** Callback data passed to \ref notifyCB. */
+  struct Notify
+  {
+    Notify( const ProgressCB & progress_r )
+    : _progress( progress_r ), _fd( 0 ), _last( 0 )
+    {}
+
+    /** Forward progress, but never backwards (an upgrade reports the erasure of the old package too). */
+    void progress( unsigned percent_r )
+    {
+      if ( percent_r > _last && _progress )
+	_progress( (_last = percent_r) );
+    }
+
+    ProgressCB _progress;
+    FD_t _fd;
+    unsigned _last;
+  };
+
+  static void * notifyCB( const void * h_r, const rpmCallbackType what_r,
+			  const rpm_loff_t amount_r, const rpm_loff_t total_r,
+			  fnpyKey key_r, rpmCallbackData data_r )
+  {
+    Notify & notify( *reinterpret_cast<Notify*>( data_r ) );
+    switch ( what_r )
+    {
+      case RPMCALLBACK_INST_OPEN_FILE:
+	notify._fd = ::Fopen( reinterpret_cast<const char *>( key_r ), "r.ufdio" );
+	if ( notify._fd && ::Ferror( notify._fd ) )
+	{
+	  ERR << "Can't open file for reading: " << reinterpret_cast<const char *>( key_r ) << " (" << ::Fstrerror( notify._fd ) << ")" << endl;
+	  ::Fclose( notify._fd );
+	  notify._fd = 0;
+	}
+	return notify._fd;
+	break;
+
+      case RPMCALLBACK_INST_CLOSE_FILE:
+	if ( notify._fd )
+	{
+	  ::Fclose( notify._fd );
+	  notify._fd = 0;
+	}
+	break;
+
+      case RPMCALLBACK_INST_PROGRESS:
+      case RPMCALLBACK_UNINST_PROGRESS:
+	if ( total_r )
+	  notify.progress( amount_r * 100 / total_r );
+	break;
+
+      default:
+	break;
+    }
+    return nullptr;
+  }
+
+private:
+  Pathname _root;
+  Pathname _dbPath;
+  rpmts _ts;
+};
+#endif // _RPM_4_X
+
+///////////////////////////////////////////////////////////////////
+//
+//
+//	METHOD NAME : RpmDb::releaseLibrpmTransaction
+//	METHOD TYPE : void
+//
+void RpmDb::releaseLibrpmTransaction()
+{
+  _librpmTs.reset();
+}
+
 ///////////////////////////////////////////////////////////////////
 //
 //
@@ -1940,80 +2316,102 @@ void RpmDb::doInstallPackage( const Pathname & filename, RpmInstFlags flags, cal
     report->progress( 0 ); // allow 1% for backup creation.
   }
 
-  // run rpm
-  RpmArgVec opts;
-  if (flags & RPMINST_NOUPGRADE)
-    opts.push_back("-i");
-  else
-    opts.push_back("-U");
-
-  opts.push_back("--percent");
-  opts.push_back("--noglob");
-
-  // ZConfig defines cross-arch installation
-  if ( ! ZConfig::instance().systemArchitecture().compatibleWith( ZConfig::instance().defaultSystemArchitecture() ) )
-    opts.push_back("--ignorearch");
-
-  if (flags & RPMINST_NODIGEST)
-    opts.push_back("--nodigest");
-  if (flags & RPMINST_NOSIGNATURE)
-    opts.push_back("--nosignature");
-  if (flags & RPMINST_EXCLUDEDOCS)
-    opts.push_back ("--excludedocs");
-  if (flags & RPMINST_NOSCRIPTS)
-    opts.push_back ("--noscripts");
-  if (flags & RPMINST_FORCE)
-    opts.push_back ("--force");
-  if (flags & RPMINST_NODEPS)
-    opts.push_back ("--nodeps");
-  if (flags & RPMINST_IGNORESIZE)
-    opts.push_back ("--ignoresize");
-  if (flags & RPMINST_JUSTDB)
-    opts.push_back ("--justdb");
-  if (flags & RPMINST_TEST)
-    opts.push_back ("--test");
-  if (flags & RPMINST_NOPOSTTRANS)
-    opts.push_back ("--noposttrans");
-
-  opts.push_back("--");
-
-  // rpm requires additional quoting of special chars:
-  std::string quotedFilename( rpmQuoteFilename( workaroundRpmPwdBug( filename ) ) );
-  opts.push_back ( quotedFilename.c_str() );
-
-  modifyDatabase(); // BEFORE run_rpm
-  run_rpm( opts, ExternalProgram::Stderr_To_Stdout );
-
-  std::string line;
   std::string rpmmsg;
   std::vector<std::string> configwarnings;
+  int rpm_status = 0;
 
-  unsigned linecnt = 0;
-  while (systemReadLine(line))
+#ifdef _RPM_4_X
+  if ( useLibrpmTs() )
   {
-    if ( linecnt < MAXRPMMESSAGELINES )
-      ++linecnt;
-    else
-      continue;
+    if ( ! _librpmTs )
+      _librpmTs.reset( new LibrpmTs( _root, _dbPath ) );
+
+    modifyDatabase();
+    rpm_status = _librpmTs->install( filename, flags, [&report]( unsigned percent ) { report->progress( percent ); }, rpmmsg );
 
-    if (line.substr(0,2)=="%%")
+    std::vector<std::string> lines;
+    str::split( rpmmsg, std::back_inserter(lines), "\n" );
+    for_( it, lines.begin(), lines.end() )
     {
-      int percent;
-      sscanf (line.c_str () + 2, "%d", &percent);
-      report->progress( percent );
+      if ( it->substr(0,8) == "warning:" )
+        configwarnings.push_back( *it );
     }
+  }
+  else
+#endif // _RPM_4_X
+  {
+    // run rpm
+    RpmArgVec opts;
+    if (flags & RPMINST_NOUPGRADE)
+      opts.push_back("-i");
     else
-      rpmmsg += line+'\n';
+      opts.push_back("-U");
+
+    opts.push_back("--percent");
+    opts.push_back("--noglob");
+
+    // ZConfig defines cross-arch installation
+    if ( ! ZConfig::instance().systemArchitecture().compatibleWith( ZConfig::instance().defaultSystemArchitecture() ) )
+      opts.push_back("--ignorearch");
+
+    if (flags & RPMINST_NODIGEST)
+      opts.push_back("--nodigest");
+    if (flags & RPMINST_NOSIGNATURE)
+      opts.push_back("--nosignature");
+    if (flags & RPMINST_EXCLUDEDOCS)
+      opts.push_back ("--excludedocs");
+    if (flags & RPMINST_NOSCRIPTS)
+      opts.push_back ("--noscripts");
+    if (flags & RPMINST_FORCE)
+      opts.push_back ("--force");
+    if (flags & RPMINST_NODEPS)
+      opts.push_back ("--nodeps");
+    if (flags & RPMINST_IGNORESIZE)
+      opts.push_back ("--ignoresize");
+    if (flags & RPMINST_JUSTDB)
+      opts.push_back ("--justdb");
+    if (flags & RPMINST_TEST)
+      opts.push_back ("--test");
+    if (flags & RPMINST_NOPOSTTRANS)
+      opts.push_back ("--noposttrans");
+
+    opts.push_back("--");
+
+    // rpm requires additional quoting of special chars:
+    std::string quotedFilename( rpmQuoteFilename( workaroundRpmPwdBug( filename ) ) );
+    opts.push_back ( quotedFilename.c_str() );
+
+    modifyDatabase(); // BEFORE run_rpm
+    run_rpm( opts, ExternalProgram::Stderr_To_Stdout );
 
-    if ( line.substr(0,8) == "warning:" )
+    std::string line;
+    unsigned linecnt = 0;
+    while (systemReadLine(line))
     {
-      configwarnings.push_back(line);
+      if ( linecnt < MAXRPMMESSAGELINES )
+        ++linecnt;
+      else
+        continue;
+
+      if (line.substr(0,2)=="%%")
+      {
+        int percent;
+        sscanf (line.c_str () + 2, "%d", &percent);
+        report->progress( percent );
+      }
+      else
+        rpmmsg += line+'\n';
+
+      if ( line.substr(0,8) == "warning:" )
+      {
+        configwarnings.push_back(line);
+      }
     }
-  }
-  if ( linecnt > MAXRPMMESSAGELINES )
-    rpmmsg += "[truncated]\n";
+    if ( linecnt > MAXRPMMESSAGELINES )
+      rpmmsg += "[truncated]\n";
 
-  int rpm_status = systemStatus();
+    rpm_status = systemStatus();
+  }
 
   // evaluate result
   for (std::vector<std::string>::iterator it = configwarnings.begin();
@@ -2132,51 +2530,67 @@ void RpmDb::doRemovePackage( const std::string & name_r, RpmInstFlags flags, cal
     report->progress( 100 );
   }
 
-  // run rpm
-  RpmArgVec opts;
-  opts.push_back("-e");
-  opts.push_back("--allmatches");
+  std::string rpmmsg;
+  int rpm_status = 0;
 
-  if (flags & RPMINST_NOSCRIPTS)
-    opts.push_back("--noscripts");
-  if (flags & RPMINST_NODEPS)
-    opts.push_back("--nodeps");
-  if (flags & RPMINST_JUSTDB)
-    opts.push_back("--justdb");
-  if (flags & RPMINST_TEST)
-    opts.push_back ("--test");
-  if (flags & RPMINST_FORCE)
+#ifdef _RPM_4_X
+  if ( useLibrpmTs() )
   {
-    WAR << "IGNORE OPTION: 'rpm -e' does not support '--force'" << endl;
+    if ( ! _librpmTs )
+      _librpmTs.reset( new LibrpmTs( _root, _dbPath ) );
+
+    modifyDatabase();
+    report->progress( 5 );
+    rpm_status = _librpmTs->remove( name_r, flags, [&report]( unsigned percent ) { report->progress( percent ); }, rpmmsg );
   }
+  else
+#endif // _RPM_4_X
+  {
+    // run rpm
+    RpmArgVec opts;
+    opts.push_back("-e");
+    opts.push_back("--allmatches");
+
+    if (flags & RPMINST_NOSCRIPTS)
+      opts.push_back("--noscripts");
+    if (flags & RPMINST_NODEPS)
+      opts.push_back("--nodeps");
+    if (flags & RPMINST_JUSTDB)
+      opts.push_back("--justdb");
+    if (flags & RPMINST_TEST)
+      opts.push_back ("--test");
+    if (flags & RPMINST_FORCE)
+    {
+      WAR << "IGNORE OPTION: 'rpm -e' does not support '--force'" << endl;
+    }
 
-  opts.push_back("--");
-  opts.push_back(name_r.c_str());
+    opts.push_back("--");
+    opts.push_back(name_r.c_str());
 
-  modifyDatabase(); // BEFORE run_rpm
-  run_rpm (opts, ExternalProgram::Stderr_To_Stdout);
+    modifyDatabase(); // BEFORE run_rpm
+    run_rpm (opts, ExternalProgram::Stderr_To_Stdout);
 
-  std::string line;
-  std::string rpmmsg;
+    std::string line;
 
-  // got no progress from command, so we fake it:
-  // 5  - command started
-  // 50 - command completed
-  // 100 if no error
-  report->progress( 5 );
-  unsigned linecnt = 0;
-  while (systemReadLine(line))
-  {
-    if ( linecnt < MAXRPMMESSAGELINES )
-      ++linecnt;
-    else
-      continue;
-    rpmmsg += line+'\n';
+    // got no progress from command, so we fake it:
+    // 5  - command started
+    // 50 - command completed
+    // 100 if no error
+    report->progress( 5 );
+    unsigned linecnt = 0;
+    while (systemReadLine(line))
+    {
+      if ( linecnt < MAXRPMMESSAGELINES )
+        ++linecnt;
+      else
+        continue;
+      rpmmsg += line+'\n';
+    }
+    if ( linecnt > MAXRPMMESSAGELINES )
+      rpmmsg += "[truncated]\n";
+    report->progress( 50 );
+    rpm_status = systemStatus();
   }
-  if ( linecnt > MAXRPMMESSAGELINES )
-    rpmmsg += "[truncated]\n";
-  report->progress( 50 );
-  int rpm_status = systemStatus();
 
   if ( rpm_status != 0 )
   {
@@ -20,6 +20,7 @@
 #include <vector>
 #include <string>
 
+#include "zypp/base/PtrTypes.h"
 #include "zypp/Pathname.h"
 #include "zypp/ExternalProgram.h"
 
@@ -399,6 +400,10 @@ private:
   /** create package backups? */
   bool _packagebackups;
 
+  /** In-process librpm transaction set (\ref releaseLibrpmTransaction). */
+  class LibrpmTs;
+  shared_ptr<LibrpmTs> _librpmTs;
+
   /** whether <_root>/<WARNINGMAILPATH> was already created */
   bool _warndirexists;
 
@@ -480,6 +485,13 @@ public:
   void removePackage( const std::string & name_r, RpmInstFlags flags = RPMINST_NONE );
   void removePackage( Package::constPtr package, RpmInstFlags flags = RPMINST_NONE );
 
+  /**
+   * Close the librpm transaction set kept open by the in-process
+   * install/remove backend (\c ZYPP_RPM_INPROCESS=1), releasing the
+   * rpmdb it holds. Does nothing if the backend was not used.
+   **/
+  void releaseLibrpmTransaction();
+
   /**
    * get backup dir for rpm config files
    *
@@ -153,6 +153,10 @@ namespace zypp
       {
         ZYPP_THROW( Exception("ZYPP_TESTSUITE_FAKE_ARCH set. Commit not allowed and disabled.") );
       }
+      if ( getenv("ZYPP_TESTSUITE_APPLYDELTARPM") )
+      {
+        ZYPP_THROW( Exception("ZYPP_TESTSUITE_APPLYDELTARPM set. Commit not allowed and disabled.") );
+      }
 
       MIL << "Attempt to commit (" << policy_r << ")" << endl;
       if (! _target)